@@ -1,17 +1,43 @@
+#ifndef BRAINMIRRORWRAPPER_EXPORTS
 #define BRAINMIRRORWRAPPER_EXPORTS
+#endif
 #include "brnpro_if.h"
 #include "ble_device.h"
 #include "BrainMonitorWrapper.h"
+#include "BinaryLog.h"
+#include "LivePipeline.h"
+#include "SessionRecorder.h"
+#include "SessionJournal.h"
+#include "CommandQueue.h"
+#include "Spectrogram.h"
+#include "Connectivity.h"
+#include "AllocAudit.h"
+#include "ChunkUploader.h"
+#include "Realtime.h"
+#include "ResultCache.h"
+#include "StreamServer.h"
 #include <vector>
 #include <string>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <filesystem>
 #include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
 
 using namespace jfbrnpro_if;
+using namespace brainmirror;
 
 // Global variables
 static std::vector<ble_device> g_scanDevices;
 static std::vector<ble_device> g_connectedDevices;
+// DeviceInfo snapshots parallel to the vectors above, so queries copy fixed
+// buffers instead of building name/MAC strings on every call
+static std::vector<DeviceInfo> g_scanDeviceInfo;
+static std::vector<DeviceInfo> g_connectedDeviceInfo;
 static std::mutex g_deviceMutex;
 static bool g_initialized = false;
 static std::string g_currentPort;
@@ -21,31 +47,125 @@ static RawDataCallback g_rawDataCallback = nullptr;
 static PostDataCallback g_postDataCallback = nullptr;
 static BattInfoCallback g_battInfoCallback = nullptr;
 static EventCallback g_eventCallback = nullptr;
+static BandPowerCallback g_bandPowerCallback = nullptr;
+
+// Live band-power pipelines, one per connect index. The pipeline type is
+// chosen from the device type when the device connects; the callback thread
+// only loads the pointer. Replaced pipelines stay alive until SDK_Cleanup
+// because a callback may still be using them.
+static std::atomic<live::Pipeline*> g_livePipelines[live::MaxDevices];
+static std::unique_ptr<live::Pipeline> g_ownedPipelines[live::MaxDevices];
+static std::vector<std::unique_ptr<live::Pipeline>> g_retiredPipelines;
+// Arithmetic for pipelines created from now on (SDK_SetPipelineArithmetic)
+static live::Arithmetic g_pipelineArithmetic = live::Arithmetic::Float;
+// Epoch history and FFT buffers of the pipelines above; reserved for every
+// free connect index at SDK_StartDataCollection, released in SDK_Cleanup
+static Arena g_acquisitionArena;
+
+// Session recording (SDK_BeginSession / SDK_MarkPhase / SDK_EndSession)
+static SessionRecorder g_sessionRecorder;
+// Channels seen on the raw data callback per connect index. The dongle does
+// not report a channel count and the profile may know fewer channels than the
+// headset sends, so sessions and uploads take whichever is larger.
+static std::atomic<int> g_seenChannels[live::MaxDevices];
+
+static void noteChannel(int dev, int chan) {
+    if (dev < 0 || dev >= live::MaxDevices || chan < 0 || chan >= SessionRecorder::MaxChannels) return;
+    int seen = g_seenChannels[dev].load(std::memory_order_relaxed);
+    while (chan >= seen && !g_seenChannels[dev].compare_exchange_weak(seen, chan + 1, std::memory_order_relaxed)) {}
+}
+// Write-ahead journal of the recorded session (SDK_OpenSessionJournal /
+// SDK_RecoverSession); it outlives SDK_Cleanup so a re-init can recover
+static SessionJournal g_sessionJournal;
+
+// Local live data stream (SDK_StartStreamServer)
+static StreamServer g_streamServer;
+
+// Asynchronous commands (SDK_SendCommandAsync / SDK_ConfigureAllDevices)
+static bool sendDeviceCommand(int dev, uint8_t cmd, uint8_t* payload, uint8_t len) {
+    try {
+        return len > 0 ? brainpro_command(dev, cmd, payload, len) : brainpro_command(dev, cmd);
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+static CommandQueue g_commandQueue(sendDeviceCommand);
+static CommandQueue::Options g_commandOptions;
+
+// Chunked uploads (SDK_StartUpload), one per connect index. The uploaders
+// read the session recorder's buffers, so they are cancelled before the
+// recorder reuses or releases them.
+static std::mutex g_uploadMutex;
+static std::shared_ptr<ChunkUploader> g_uploads[live::MaxDevices];
+
+static void cancelUploads() {
+    std::shared_ptr<ChunkUploader> uploads[live::MaxDevices];
+    {
+        std::lock_guard<std::mutex> lock(g_uploadMutex);
+        for (int i = 0; i < live::MaxDevices; ++i) uploads[i] = std::move(g_uploads[i]);
+    }
+    for (auto& upload : uploads) {
+        if (upload) upload->cancel();
+    }
+}
+
+// Live band power for one raw packet. Runs on the acquisition thread, or on
+// the real-time processing thread when SDK_SetRealtimeMode offloads it.
+static void processLivePacket(void*, int dev, int chan, const int* data, int len) {
+    allocaudit::HotPathScope audit;
+    if (dev < 0 || dev >= live::MaxDevices) return;
+
+    live::Pipeline* pipeline = g_livePipelines[dev].load(std::memory_order_acquire);
+    if (pipeline && pipeline->push(chan, data, len) && g_bandPowerCallback) {
+        live::BandPower power;
+        pipeline->latest(chan, power);
+        g_bandPowerCallback(dev, chan, power.relative[0], power.relative[1], power.relative[2]);
+    }
+}
+
+static RealtimeProcessor g_realtime(processLivePacket, nullptr);
 
 // Internal callback functions
 void internal_rawDataCallback(void* user, int dev, int chan, int* data, int len) {
+    allocaudit::HotPathScope audit;
+    blog::log(blog::Msg_RawData, dev, chan, len);
+    noteChannel(dev, chan);
+    size_t stored = g_sessionRecorder.append(dev, chan, data, len);
+    g_sessionJournal.appendSamples(dev, chan, data, stored);
+    g_streamServer.publish(dev, chan, data, len);
     if (g_rawDataCallback) {
         g_rawDataCallback(dev, chan, data, len);
     }
+
+    g_realtime.dispatch(dev, chan, data, len);
 }
 
 void internal_postDataCallback(void* user, int dev, uint8_t ele, uint8_t att, uint8_t med, uint8_t res, uint32_t psd[8]) {
+    allocaudit::HotPathScope audit;
+    blog::log(blog::Msg_PostData, dev, ele, att, med);
     if (g_postDataCallback) {
         g_postDataCallback(dev, ele, att, med, res, psd);
     }
 }
 
 void internal_battInfoCallback(void* user, int dev, uint32_t level, uint32_t vol) {
+    allocaudit::HotPathScope audit;
+    blog::log(blog::Msg_BattInfo, dev, level, vol);
     if (g_battInfoCallback) {
         g_battInfoCallback(dev, level, vol);
     }
 }
 
 void internal_respCallback(void* user, int dev, uint8_t cmd, uint8_t* payload, int len) {
-    // Response callback handling
+    allocaudit::HotPathScope audit;
+    blog::log(blog::Msg_CmdResp, dev, cmd, len);
+    g_commandQueue.onResponse(dev, cmd, payload, len);
 }
 
 void internal_eventCallback(void* user, uint32_t event, uint32_t param, void* param2) {
+    blog::log(blog::Msg_Event, event, param);
     if (g_eventCallback) {
         g_eventCallback(event, param);
     }
@@ -57,11 +177,11 @@ void convertToDeviceInfo(ble_device& device, DeviceInfo* info) {
     
     // Copy device name
     std::string name = device.getDeviceName();
-    strcpy_s(info->name, sizeof(info->name), name.c_str());
+    snprintf(info->name, sizeof(info->name), "%s", name.c_str());
     
     // Copy MAC address
     std::string mac = device.getDeviceMac();
-    strcpy_s(info->mac, sizeof(info->mac), mac.c_str());
+    snprintf(info->mac, sizeof(info->mac), "%s", mac.c_str());
     
     // Set other properties
     info->type = device.getDeviceType();
@@ -69,6 +189,44 @@ void convertToDeviceInfo(ble_device& device, DeviceInfo* info) {
     info->state = static_cast<int>(device.getDeviceState());
 }
 
+// Caller holds g_deviceMutex. Name, MAC and type come from the snapshot; the
+// state is read live because it changes without a rescan.
+static void copyDeviceInfo(ble_device& device, const DeviceInfo& cached, DeviceInfo* info) {
+    *info = cached;
+    info->state = static_cast<int>(device.getDeviceState());
+}
+
+// Caller holds g_deviceMutex
+static void attachPipeline(int index, int type) {
+    if (index < 0 || index >= live::MaxDevices) return;
+
+    g_seenChannels[index].store(0, std::memory_order_relaxed);
+
+    auto& owned = g_ownedPipelines[index];
+    if (owned && std::string(owned->profileName()) == live::profileNameForType(type) &&
+        owned->arithmetic() == g_pipelineArithmetic) {
+        owned->requestReset();
+    }
+    else {
+        if (owned) g_retiredPipelines.push_back(std::move(owned));
+        owned = live::createPipeline(type, g_acquisitionArena, g_pipelineArithmetic);
+    }
+    g_livePipelines[index].store(owned.get(), std::memory_order_release);
+}
+
+// Caller holds g_deviceMutex
+static int deviceChannelCount(int index) {
+    if (index < 0 || index >= live::MaxDevices) return 1;
+    int channels = g_ownedPipelines[index] ? g_ownedPipelines[index]->channelCount() : 1;
+    return std::max(channels, g_seenChannels[index].load(std::memory_order_relaxed));
+}
+
+// Caller holds g_deviceMutex
+static void detachPipeline(int index) {
+    if (index < 0 || index >= live::MaxDevices) return;
+    g_livePipelines[index].store(nullptr, std::memory_order_release);
+}
+
 // SDK API implementation
 BRAINMIRROR_API int SDK_Init() {
     if (g_initialized) {
@@ -89,6 +247,7 @@ BRAINMIRROR_API int SDK_Init() {
             nullptr
         );
         
+        g_commandQueue.start(g_commandOptions);
         g_initialized = true;
         return 1; // Success
     }
@@ -99,16 +258,39 @@ BRAINMIRROR_API int SDK_Init() {
 
 BRAINMIRROR_API void SDK_Cleanup() {
     if (g_initialized) {
+        g_commandQueue.stop();
+        cancelUploads();
         jfsdk_cleanup();
         g_initialized = false;
+        g_realtime.stop();
+
+        // No callbacks run after jfsdk_cleanup
+        std::lock_guard<std::mutex> lock(g_deviceMutex);
+        for (int i = 0; i < live::MaxDevices; ++i) {
+            g_livePipelines[i].store(nullptr, std::memory_order_release);
+            g_ownedPipelines[i].reset();
+            g_seenChannels[i].store(0, std::memory_order_relaxed);
+        }
+        g_retiredPipelines.clear();
+        g_acquisitionArena.release();
+        g_scanDevices.clear();
+        g_scanDeviceInfo.clear();
+        g_connectedDevices.clear();
+        g_connectedDeviceInfo.clear();
+        g_sessionRecorder.release();
+        g_sessionJournal.checkpoint();
     }
 }
 
 BRAINMIRROR_API const char* SDK_GetVersion() {
-    static std::string version;
+    // The library version cannot change while loaded
+    static char version[64] = {};
+    static std::once_flag once;
     try {
-        version = jfsdk_version();
-        return version.c_str();
+        std::call_once(once, []() {
+            snprintf(version, sizeof(version), "%s", jfsdk_version().c_str());
+        });
+        return version[0] ? version : "Unknown";
     }
     catch (...) {
         return "Unknown";
@@ -116,10 +298,10 @@ BRAINMIRROR_API const char* SDK_GetVersion() {
 }
 
 BRAINMIRROR_API const char* SDK_CheckPort() {
-    static std::string port;
+    static char port[128] = {};
     try {
-        port = jfboard_checkPort();
-        return port.c_str();
+        snprintf(port, sizeof(port), "%s", jfboard_checkPort().c_str());
+        return port;
     }
     catch (...) {
         return "";
@@ -158,6 +340,10 @@ BRAINMIRROR_API int SDK_ScanDevices() {
         std::lock_guard<std::mutex> lock(g_deviceMutex);
         if (jfboard_scan()) {
             g_scanDevices = jfboard_getScanDevices();
+            g_scanDeviceInfo.resize(g_scanDevices.size());
+            for (size_t i = 0; i < g_scanDevices.size(); ++i) {
+                convertToDeviceInfo(g_scanDevices[i], &g_scanDeviceInfo[i]);
+            }
             return 1;
         }
         return 0;
@@ -178,7 +364,7 @@ BRAINMIRROR_API int SDK_GetScanDevice(int index, DeviceInfo* device) {
     std::lock_guard<std::mutex> lock(g_deviceMutex);
     if (index >= static_cast<int>(g_scanDevices.size())) return 0;
     
-    convertToDeviceInfo(g_scanDevices[index], device);
+    copyDeviceInfo(g_scanDevices[index], g_scanDeviceInfo[index], device);
     return 1;
 }
 
@@ -186,16 +372,23 @@ BRAINMIRROR_API int SDK_ConnectDevice(const char* mac, int type) {
     if (!mac) return 0;
     
     try {
+        // One-entry batch reused across calls; groupConnect takes a vector
+        static std::mutex connectMutex;
+        static std::vector<ble_device> batch;
+        std::lock_guard<std::mutex> connectLock(connectMutex);
         std::string macStr(mac);
-        ble_device device(macStr, type);
-        
-        std::vector<ble_device> devices;
-        devices.push_back(device);
+        batch.clear();
+        batch.emplace_back(macStr, type);
         
-        bool result = brainpro_groupConnect(devices);
+        bool result = brainpro_groupConnect(batch);
         if (result) {
             std::lock_guard<std::mutex> lock(g_deviceMutex);
-            g_connectedDevices.push_back(device);
+            // groupConnect fills in the connect index on the vector entry
+            g_connectedDevices.push_back(batch[0]);
+            DeviceInfo info{};
+            convertToDeviceInfo(batch[0], &info);
+            g_connectedDeviceInfo.push_back(info);
+            attachPipeline(batch[0].getConnectIndex(), type);
         }
         return result ? 1 : 0;
     }
@@ -210,10 +403,14 @@ BRAINMIRROR_API int SDK_DisconnectDevice(const char* mac) {
     try {
         std::lock_guard<std::mutex> lock(g_deviceMutex);
         
-        for (auto it = g_connectedDevices.begin(); it != g_connectedDevices.end(); ++it) {
-            if (it->getDeviceMac() == mac) {
+        for (size_t i = 0; i < g_connectedDevices.size(); ++i) {
+            if (std::strcmp(g_connectedDeviceInfo[i].mac, mac) == 0) {
+                auto it = g_connectedDevices.begin() + i;
+                detachPipeline(it->getConnectIndex());
+                g_commandQueue.cancelDevice(it->getConnectIndex());
                 brainpro_disconnect(*it);
                 g_connectedDevices.erase(it);
+                g_connectedDeviceInfo.erase(g_connectedDeviceInfo.begin() + i);
                 return 1;
             }
         }
@@ -235,12 +432,26 @@ BRAINMIRROR_API int SDK_GetConnectedDevice(int index, DeviceInfo* device) {
     std::lock_guard<std::mutex> lock(g_deviceMutex);
     if (index >= static_cast<int>(g_connectedDevices.size())) return 0;
     
-    convertToDeviceInfo(g_connectedDevices[index], device);
+    copyDeviceInfo(g_connectedDevices[index], g_connectedDeviceInfo[index], device);
     return 1;
 }
 
 BRAINMIRROR_API int SDK_StartDataCollection() {
     try {
+        {
+            // Headroom for devices that connect while collecting, so their
+            // pipelines do not grow the arena mid-stream
+            std::lock_guard<std::mutex> lock(g_deviceMutex);
+            size_t perDevice = live::workspaceBytesForType(0, g_pipelineArithmetic);
+            size_t freeSlots = 0;
+            for (int i = 0; i < live::MaxDevices; ++i) {
+                if (!g_ownedPipelines[i]) ++freeSlots;
+            }
+            for (auto& device : g_connectedDevices) {
+                perDevice = std::max(perDevice, live::workspaceBytesForType(device.getDeviceType(), g_pipelineArithmetic));
+            }
+            g_acquisitionArena.reserve(freeSlots * perDevice);
+        }
         return brainpro_start() ? 1 : 0;
     }
     catch (...) {
@@ -273,6 +484,32 @@ BRAINMIRROR_API void SDK_SetEventCallback(EventCallback callback) {
     g_eventCallback = callback;
 }
 
+BRAINMIRROR_API void SDK_SetBandPowerCallback(BandPowerCallback callback) {
+    g_bandPowerCallback = callback;
+}
+
+BRAINMIRROR_API void SDK_SetPipelineArithmetic(int fixedPoint) {
+    std::lock_guard<std::mutex> lock(g_deviceMutex);
+    g_pipelineArithmetic = fixedPoint ? live::Arithmetic::Fixed : live::Arithmetic::Float;
+}
+
+BRAINMIRROR_API int SDK_GetBandPower(int dev, int chan, BandPowerInfo* info) {
+    if (!info || dev < 0 || dev >= live::MaxDevices) return 0;
+
+    live::Pipeline* pipeline = g_livePipelines[dev].load(std::memory_order_acquire);
+    if (!pipeline) return 0;
+
+    live::BandPower power;
+    if (!pipeline->latest(chan, power)) return 0;
+    info->theta = power.relative[0];
+    info->alpha = power.relative[1];
+    info->beta = power.relative[2];
+    info->totalPower = power.totalPower;
+    info->epoch = power.epoch;
+    info->sampleRate = pipeline->sampleRate();
+    return 1;
+}
+
 BRAINMIRROR_API int SDK_SendCommand(int dev, unsigned char cmd) {
     try {
         return brainpro_command(dev, cmd) ? 1 : 0;
@@ -289,4 +526,666 @@ BRAINMIRROR_API int SDK_SendCommandWithPayload(int dev, unsigned char cmd, unsig
     catch (...) {
         return 0;
     }
+}
+
+static std::filesystem::path pathFromUtf8(const char* text) {
+    return std::filesystem::path(std::u8string(reinterpret_cast<const char8_t*>(text)));
+}
+
+BRAINMIRROR_API int SDK_StartLogging(const char* directory, unsigned int maxFileBytes, unsigned int maxFileSeconds) {
+    try {
+        blog::Config config;
+        if (directory) config.directory = pathFromUtf8(directory);
+        if (maxFileBytes > 0) config.maxFileBytes = maxFileBytes;
+        if (maxFileSeconds > 0) config.maxFileSeconds = maxFileSeconds;
+        return blog::start(config) ? 1 : 0;
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+BRAINMIRROR_API void SDK_StopLogging() {
+    blog::stop();
+}
+
+BRAINMIRROR_API unsigned int SDK_GetLogDroppedCount() {
+    return static_cast<unsigned int>(blog::droppedCount());
+}
+
+BRAINMIRROR_API int SDK_BeginSession(unsigned int maxSamplesPerStream) {
+    try {
+        // One stream per channel of every connected device
+        int streams = 0;
+        {
+            std::lock_guard<std::mutex> lock(g_deviceMutex);
+            for (auto& device : g_connectedDevices) streams += deviceChannelCount(device.getConnectIndex());
+        }
+        if (streams == 0) streams = 1;
+        if (maxSamplesPerStream == 0) maxSamplesPerStream = 30 * 60 * 520;
+        cancelUploads();
+
+        // Nothing reaches the journal while it starts over
+        g_sessionRecorder.end();
+        // A session the caller expects to be crash safe is not started
+        // unjournaled (e.g. no disk space for the preallocated file)
+        if (g_sessionJournal.isOpen()) {
+            std::string error;
+            if (!g_sessionJournal.beginSession(streams, maxSamplesPerStream, error)) return 0;
+        }
+        return g_sessionRecorder.begin(streams, maxSamplesPerStream) ? 1 : 0;
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+BRAINMIRROR_API int SDK_MarkPhase(const char* label) {
+    if (!g_sessionRecorder.mark(label)) return 0;
+    g_sessionJournal.appendMarker(g_sessionRecorder, g_sessionRecorder.phaseCount() - 1);
+    return 1;
+}
+
+BRAINMIRROR_API int SDK_EndSession() {
+    if (!g_sessionRecorder.end()) return 0;
+    g_sessionJournal.appendEnd();
+    return 1;
+}
+
+BRAINMIRROR_API int SDK_GetPhaseCount() {
+    return g_sessionRecorder.phaseCount();
+}
+
+BRAINMIRROR_API const char* SDK_GetPhaseLabel(int phase) {
+    const char* label = g_sessionRecorder.phaseLabel(phase);
+    return label ? label : "";
+}
+
+BRAINMIRROR_API int SDK_FindPhase(const char* label) {
+    return g_sessionRecorder.findPhase(label);
+}
+
+BRAINMIRROR_API int SDK_GetPhaseSlice(int dev, int chan, int phase, const int** data, int* count) {
+    if (!data || !count) return 0;
+
+    size_t samples = 0;
+    if (!g_sessionRecorder.phaseSlice(dev, chan, phase, data, &samples)) {
+        *data = nullptr;
+        *count = 0;
+        return 0;
+    }
+    *count = static_cast<int>(samples);
+    return 1;
+}
+
+BRAINMIRROR_API int SDK_WriteSpectrogram(int dev, int chan, int phase, const char* path) {
+    if (!path) return 0;
+
+    try {
+        const int* data = nullptr;
+        size_t count = 0;
+        bool found = phase < 0
+            ? g_sessionRecorder.streamSlice(dev, chan, &data, &count)
+            : g_sessionRecorder.phaseSlice(dev, chan, phase, &data, &count);
+        if (!found) return 0;
+
+        int sampleRate = 520;
+        {
+            std::lock_guard<std::mutex> lock(g_deviceMutex);
+            if (dev >= 0 && dev < live::MaxDevices && g_ownedPipelines[dev]) {
+                sampleRate = g_ownedPipelines[dev]->sampleRate();
+            }
+        }
+
+        std::vector<double> samples(data, data + count);
+        std::string error;
+        return writeSpectrogram(samples.data(), samples.size(), sampleRate, SpectrogramOptions(), pathFromUtf8(path), error) ? 1 : 0;
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+static std::mutex g_connectivityMutex;
+static ConnectivityEngine g_connectivityEngine;
+
+static int computeConnectivity(const double* const* channels, int channelCount, size_t length, double sampleRate,
+                               float* coherence, float* plv, float* correlation) {
+    std::lock_guard<std::mutex> lock(g_connectivityMutex);
+    ConnectivityResult result;
+    std::string error;
+    if (!g_connectivityEngine.compute(channels, static_cast<size_t>(channelCount), length, sampleRate,
+                                      ConnectivityOptions(), result, error)) {
+        return 0;
+    }
+    if (coherence) std::copy(result.coherence.begin(), result.coherence.end(), coherence);
+    if (plv) std::copy(result.plv.begin(), result.plv.end(), plv);
+    if (correlation) std::copy(result.correlation.begin(), result.correlation.end(), correlation);
+    return 1;
+}
+
+BRAINMIRROR_API int SDK_ComputeConnectivity(const double* samples, int channels, int samplesPerChannel, double sampleRate,
+                                            float* coherence, float* plv, float* correlation) {
+    if (!samples || channels < 2 || samplesPerChannel <= 0) return 0;
+
+    try {
+        std::vector<const double*> pointers(channels);
+        for (int c = 0; c < channels; ++c) {
+            pointers[c] = samples + static_cast<size_t>(c) * samplesPerChannel;
+        }
+        return computeConnectivity(pointers.data(), channels, static_cast<size_t>(samplesPerChannel), sampleRate,
+                                   coherence, plv, correlation);
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+BRAINMIRROR_API int SDK_ComputeSessionConnectivity(int phase, int maxStreams, int* devs, int* chans,
+                                                   float* coherence, float* plv, float* correlation) {
+    if (!devs || !chans || maxStreams < 2) return 0;
+
+    try {
+        int streams = g_sessionRecorder.boundStreams(devs, chans, maxStreams);
+        if (streams < 2) return 0;
+
+        // Streams from different devices are aligned at the phase marker and
+        // truncated to the shortest one; all devices must share a sample rate.
+        int sampleRate = 0;
+        {
+            std::lock_guard<std::mutex> lock(g_deviceMutex);
+            for (int s = 0; s < streams; ++s) {
+                int rate = devs[s] < live::MaxDevices && g_ownedPipelines[devs[s]]
+                    ? g_ownedPipelines[devs[s]]->sampleRate() : 520;
+                if (sampleRate != 0 && rate != sampleRate) return 0;
+                sampleRate = rate;
+            }
+        }
+
+        std::vector<const int*> slices(streams);
+        size_t length = SIZE_MAX;
+        for (int s = 0; s < streams; ++s) {
+            size_t count = 0;
+            bool found = phase < 0
+                ? g_sessionRecorder.streamSlice(devs[s], chans[s], &slices[s], &count)
+                : g_sessionRecorder.phaseSlice(devs[s], chans[s], phase, &slices[s], &count);
+            if (!found) return 0;
+            length = std::min(length, count);
+        }
+
+        std::vector<double> samples(static_cast<size_t>(streams) * length);
+        std::vector<const double*> pointers(streams);
+        for (int s = 0; s < streams; ++s) {
+            double* channel = samples.data() + static_cast<size_t>(s) * length;
+            std::copy(slices[s], slices[s] + length, channel);
+            pointers[s] = channel;
+        }
+        return computeConnectivity(pointers.data(), streams, length, sampleRate, coherence, plv, correlation)
+            ? streams : 0;
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+static ResultCache g_resultCache;
+
+BRAINMIRROR_API int SDK_OpenResultCache(const char* path) {
+    if (!path) return 0;
+
+    try {
+        std::string error;
+        return g_resultCache.open(pathFromUtf8(path), error) ? 1 : 0;
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+BRAINMIRROR_API void SDK_CloseResultCache() {
+    g_resultCache.close();
+}
+
+BRAINMIRROR_API int SDK_GetResultCacheStats(ResultCacheStats* stats) {
+    if (!stats) return 0;
+
+    ResultCache::Stats s = g_resultCache.stats();
+    stats->open = g_resultCache.isOpen() ? 1 : 0;
+    stats->entries = s.entries;
+    stats->capacity = s.capacity;
+    stats->hits = s.hits;
+    stats->misses = s.misses;
+    stats->fileBytes = s.fileBytes;
+    return 1;
+}
+
+BRAINMIRROR_API int SDK_AnalyzeRecordingFile(const char* path, RecordingAnalysis* result) {
+    if (!path || !result) return 0;
+
+    try {
+        // Buffers grow to the largest recording seen on each calling thread
+        thread_local std::vector<char> fileBuffer;
+        thread_local Recording recording;
+        thread_local BrainwaveAnalyzer analyzer;
+
+        if (!readWholeFile(pathFromUtf8(path), fileBuffer)) return 0;
+
+        CachedAnalysis analysis;
+        bool cached = analyzeRecordingCached(g_resultCache.isOpen() ? &g_resultCache : nullptr,
+                                             fileBuffer.data(), fileBuffer.size(), formatFromPath(path),
+                                             recording, analyzer, analysis);
+
+        const BrainwaveResult& r = analysis.result;
+        std::memset(result, 0, sizeof(*result));
+        result->valid = analysis.parsed ? 1 : 0;
+        result->success = r.success ? 1 : 0;
+        result->cached = cached ? 1 : 0;
+        result->format = static_cast<int>(analysis.format);
+        result->theta = r.thetaValue;
+        result->alpha = r.alphaValue;
+        result->beta = r.betaValue;
+        result->finalIndex = r.brainwaveFinalIndex;
+        result->sampleCount = r.sampleCount;
+        result->clippedCount = r.clippedCount;
+        result->skippedLines = analysis.skippedLines;
+        result->mean = r.meanValue;
+        result->stdDeviation = r.stdDeviation;
+        result->warnings = static_cast<int>(analysis.warnings);
+        std::memcpy(result->psd, analysis.psd, sizeof(result->psd));
+        std::strncpy(result->error, r.errorMessage.c_str(), sizeof(result->error) - 1);
+        return 1;
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+BRAINMIRROR_API int SDK_StartStreamServer(const StreamServerOptions* options) {
+    if (!options) return 0;
+
+    try {
+        StreamServer::Options serverOptions;
+        serverOptions.tcpPort = options->tcpPort;
+        if (options->unixPath) serverOptions.unixPath = options->unixPath;
+        if (options->maxSubscribers > 0) serverOptions.maxSubscribers = options->maxSubscribers;
+
+        std::string error;
+        return g_streamServer.start(serverOptions, error) ? 1 : 0;
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+BRAINMIRROR_API void SDK_StopStreamServer() {
+    g_streamServer.stop();
+}
+
+BRAINMIRROR_API int SDK_GetStreamServerStatus(StreamServerStatus* status) {
+    if (!status) return 0;
+
+    StreamServer::Stats s = g_streamServer.stats();
+    status->running = s.running ? 1 : 0;
+    status->tcpPort = s.tcpPort;
+    status->subscribers = s.subscribers;
+    status->framesPublished = s.published;
+    status->framesDropped = s.dropped;
+    status->framesSkipped = s.skipped;
+    status->bytesSent = s.bytesSent;
+    return 1;
+}
+
+static void latencyAlarm(void* user, int dev, int chan, uint32_t latencyUs, uint32_t budgetUs) {
+    blog::log(blog::Msg_LatencyAlarm, dev, chan, latencyUs, budgetUs);
+    auto callback = reinterpret_cast<LatencyAlarmCallback>(user);
+    if (callback) callback(dev, chan, latencyUs, budgetUs);
+}
+
+BRAINMIRROR_API int SDK_SetRealtimeMode(const RealtimeOptions* options) {
+    try {
+        if (!options) {
+            g_realtime.stop();
+            return 1;
+        }
+
+        RealtimeProcessor::Options config;
+        config.offload = options->offload != 0;
+        config.busyPoll = options->busyPoll != 0;
+        config.priority = options->priority;
+        config.acquisitionCpus = options->acquisitionCpuMask;
+        config.processingCpus = options->processingCpuMask;
+        config.latencyBudgetUs = options->latencyBudgetUs > 0 ? static_cast<uint32_t>(options->latencyBudgetUs) : 0;
+        config.alarmIntervalMs = options->alarmIntervalMs > 0 ? static_cast<uint32_t>(options->alarmIntervalMs) : 0;
+        return g_realtime.configure(config) ? 1 : 0;
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+BRAINMIRROR_API int SDK_GetRealtimeStatus(RealtimeStatus* status) {
+    if (!status) return 0;
+
+    RealtimeProcessor::Stats stats = g_realtime.stats();
+    status->offload = stats.offload ? 1 : 0;
+    status->busyPoll = stats.busyPoll ? 1 : 0;
+    status->acquisitionPinned = stats.acquisition.pinned;
+    status->acquisitionPriority = stats.acquisition.priority;
+    status->processingPinned = stats.processing.pinned;
+    status->processingPriority = stats.processing.priority;
+    status->packets = stats.packets;
+    status->dropped = stats.dropped;
+    status->exceeded = stats.latency.exceeded;
+    status->alarms = stats.alarms;
+    status->p50Us = stats.latency.p50Us;
+    status->p90Us = stats.latency.p90Us;
+    status->p99Us = stats.latency.p99Us;
+    status->p999Us = stats.latency.p999Us;
+    status->maxUs = stats.latency.maxUs;
+    status->meanUs = stats.latency.meanUs;
+    return 1;
+}
+
+BRAINMIRROR_API void SDK_ResetLatencyStats() {
+    g_realtime.resetStats();
+}
+
+BRAINMIRROR_API void SDK_SetLatencyAlarmCallback(LatencyAlarmCallback callback) {
+    g_realtime.setAlarmHandler(latencyAlarm, reinterpret_cast<void*>(callback));
+}
+
+BRAINMIRROR_API int SDK_StartUpload(int dev, const UploadOptions* options) {
+    if (!options || !options->host || !options->uploadId || dev < 0 || dev >= live::MaxDevices) return 0;
+
+    try {
+        UploadConfig config;
+        config.host = options->host;
+        if (options->port > 0) config.port = static_cast<uint16_t>(options->port);
+        config.token = options->token ? options->token : "";
+        config.uploadId = options->uploadId;
+        config.dataType = options->dataType ? options->dataType : "";
+        config.institutionId = options->institutionId ? options->institutionId : "";
+        config.staffName = options->staffName ? options->staffName : "";
+        config.testerName = options->testerName ? options->testerName : "";
+        {
+            std::lock_guard<std::mutex> lock(g_deviceMutex);
+            if (g_ownedPipelines[dev]) {
+                config.sampleRate = g_ownedPipelines[dev]->sampleRate();
+                config.streams = deviceChannelCount(dev);
+            }
+        }
+        config.chunkSamples = static_cast<size_t>(config.sampleRate) * (options->chunkSeconds > 0 ? options->chunkSeconds : 5);
+
+        // One CSV column per channel of the device
+        int phase = options->phase;
+        auto source = [dev, phase](int chan, const int** data, size_t* count) {
+            return phase < 0
+                ? g_sessionRecorder.streamSlice(dev, chan, data, count)
+                : g_sessionRecorder.phaseSlice(dev, chan, phase, data, count);
+        };
+        auto upload = std::make_shared<ChunkUploader>(std::move(config), std::move(source));
+
+        std::shared_ptr<ChunkUploader> previous;
+        {
+            std::lock_guard<std::mutex> lock(g_uploadMutex);
+            if (!upload->start()) return 0;
+            previous = std::move(g_uploads[dev]);
+            g_uploads[dev] = upload;
+        }
+        if (previous) previous->cancel();
+        return 1;
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+static std::shared_ptr<ChunkUploader> findUpload(int dev) {
+    if (dev < 0 || dev >= live::MaxDevices) return nullptr;
+    std::lock_guard<std::mutex> lock(g_uploadMutex);
+    return g_uploads[dev];
+}
+
+BRAINMIRROR_API int SDK_FinishUpload(int dev, int timeoutMs) {
+    std::shared_ptr<ChunkUploader> upload = findUpload(dev);
+    if (!upload) return 0;
+
+    upload->finish();
+    return upload->wait(timeoutMs) ? 1 : 0;
+}
+
+BRAINMIRROR_API void SDK_CancelUpload(int dev) {
+    std::shared_ptr<ChunkUploader> upload = findUpload(dev);
+    if (upload) upload->cancel();
+}
+
+BRAINMIRROR_API int SDK_GetUploadStatus(int dev, UploadStatus* status) {
+    if (!status) return 0;
+    std::shared_ptr<ChunkUploader> upload = findUpload(dev);
+    if (!upload) return 0;
+
+    UploadStats stats = upload->stats();
+    status->state = static_cast<int>(stats.state);
+    status->lastHttpStatus = stats.lastHttpStatus;
+    status->testResultId = stats.testResultId;
+    status->retries = static_cast<int>(stats.retries);
+    status->queuedChunks = stats.queuedChunks;
+    status->chunksSent = stats.chunksSent;
+    status->bytesSent = stats.bytesSent;
+    status->samplesAcked = stats.samplesAcked;
+    status->samplesRecorded = stats.samplesRecorded;
+    return 1;
+}
+
+BRAINMIRROR_API int SDK_GetAllocationAudit(AllocationAudit* audit) {
+    if (!audit) return 0;
+
+    allocaudit::Counters counters = allocaudit::counters();
+    {
+        std::lock_guard<std::mutex> lock(g_deviceMutex);
+        Arena::Stats stats = g_acquisitionArena.stats();
+        audit->arenaCapacity = static_cast<unsigned long long>(stats.capacity);
+        audit->arenaUsed = static_cast<unsigned long long>(stats.used);
+        audit->arenaGrowths = static_cast<int>(stats.growths);
+    }
+    audit->enabled = counters.enabled ? 1 : 0;
+    audit->trap = counters.trap ? 1 : 0;
+    audit->allocations = counters.allocations;
+    audit->bytes = counters.bytes;
+    return 1;
+}
+
+BRAINMIRROR_API void SDK_ResetAllocationAudit(int trap) {
+    allocaudit::reset(trap != 0);
+}
+
+BRAINMIRROR_API int SDK_GetSessionInfo(SessionInfo* info) {
+    if (!info) return 0;
+
+    SessionRecorder::Stats stats = g_sessionRecorder.stats();
+    info->state = static_cast<int>(stats.state);
+    info->streams = stats.streams;
+    info->samplesPerStream = static_cast<unsigned int>(stats.samplesPerStream);
+    info->phases = stats.markers;
+    info->samples = stats.samples;
+    info->droppedSamples = stats.droppedSamples;
+    return 1;
+}
+
+BRAINMIRROR_API int SDK_OpenSessionJournal(const char* path, int flushIntervalMs) {
+    if (!path) return 0;
+
+    try {
+        std::string error;
+        return g_sessionJournal.open(pathFromUtf8(path), flushIntervalMs, error) ? 1 : 0;
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+BRAINMIRROR_API void SDK_CloseSessionJournal() {
+    g_sessionJournal.close();
+}
+
+BRAINMIRROR_API int SDK_FlushSessionJournal() {
+    return g_sessionJournal.checkpoint() ? 1 : 0;
+}
+
+BRAINMIRROR_API int SDK_RecoverSession(RecoveredSession* info) {
+    try {
+        cancelUploads();
+        g_sessionRecorder.end();
+
+        SessionJournal::Recovery recovery;
+        std::string error;
+        if (!g_sessionJournal.recover(g_sessionRecorder, recovery, error)) return 0;
+        if (info) {
+            info->streams = recovery.streams;
+            info->samplesPerStream = static_cast<unsigned int>(recovery.samplesPerStream);
+            info->phases = recovery.markers;
+            info->ended = recovery.ended ? 1 : 0;
+            info->samples = recovery.samples;
+            info->records = recovery.records;
+            info->startUnixMs = recovery.startUnixMs;
+            info->durableBytes = recovery.durableBytes;
+            info->recoveredBytes = recovery.recoveredBytes;
+            info->elapsedMs = recovery.elapsedMs;
+        }
+        return 1;
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+BRAINMIRROR_API int SDK_GetSessionJournalStatus(SessionJournalStatus* status) {
+    if (!status) return 0;
+
+    SessionJournal::Stats s = g_sessionJournal.stats();
+    status->open = s.open ? 1 : 0;
+    status->active = s.active ? 1 : 0;
+    status->capacity = s.capacity;
+    status->writtenBytes = s.writtenBytes;
+    status->durableBytes = s.durableBytes;
+    status->records = s.records;
+    status->droppedRecords = s.droppedRecords;
+    status->checkpoints = s.checkpoints;
+    status->lastCheckpointUs = s.lastCheckpointUs;
+    return 1;
+}
+
+static void commandCompletion(void* user, uint32_t id, int dev, uint8_t cmd, const CommandResult& result) {
+    auto callback = reinterpret_cast<CommandCallback>(user);
+    uint8_t payload[MaxCommandPayload];
+    std::memcpy(payload, result.payload, sizeof(payload));
+    callback(id, dev, cmd, static_cast<int>(result.status), payload, result.length);
+}
+
+BRAINMIRROR_API void SDK_SetCommandOptions(int timeoutMs, int retries, int windowPerDevice) {
+    if (timeoutMs > 0) g_commandOptions.timeoutMs = timeoutMs;
+    if (retries >= 0) g_commandOptions.retries = retries;
+    if (windowPerDevice > 0) g_commandOptions.windowPerDevice = windowPerDevice;
+    g_commandQueue.setOptions(g_commandOptions);
+}
+
+BRAINMIRROR_API unsigned int SDK_SendCommandAsync(int dev, unsigned char cmd, unsigned char* payload, unsigned char len, CommandCallback callback) {
+    try {
+        return g_commandQueue.submit(dev, cmd, payload, len,
+            callback ? commandCompletion : nullptr, reinterpret_cast<void*>(callback));
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+BRAINMIRROR_API int SDK_WaitCommand(unsigned int requestId, int timeoutMs, CommandResultInfo* result) {
+    CommandResult completed;
+    if (!g_commandQueue.wait(requestId, timeoutMs, completed)) return 0;
+
+    if (result) {
+        result->status = static_cast<int>(completed.status);
+        result->attempts = completed.attempts;
+        result->latencyUs = completed.latencyUs;
+        result->length = completed.length;
+        std::memcpy(result->payload, completed.payload, sizeof(result->payload));
+    }
+    return 1;
+}
+
+BRAINMIRROR_API int SDK_ConfigureAllDevices(int timeoutMs, DeviceConfigResult* results, int maxResults) {
+    // Same sequence as device_config() in the vendor demo
+    struct ConfigCommand {
+        uint8_t cmd;
+        uint8_t payload[3];
+        uint8_t len;
+    };
+    static const ConfigCommand kSequence[] = {
+        { 0xEC, { 0 }, 0 },
+        { 0xEF, { 0 }, 0 },
+        { 0x04, { 0 }, 0 },
+        { 0x2B, { 0x00, 0x00, 0x01 }, 3 },
+        { 0xFF, { 0 }, 0 },
+    };
+    constexpr int kSteps = sizeof(kSequence) / sizeof(kSequence[0]);
+
+    try {
+        int devices[live::MaxDevices];
+        int deviceCount = 0;
+        {
+            std::lock_guard<std::mutex> lock(g_deviceMutex);
+            for (auto& device : g_connectedDevices) {
+                int index = device.getConnectIndex();
+                if (index >= 0 && index < live::MaxDevices && deviceCount < live::MaxDevices) {
+                    devices[deviceCount++] = index;
+                }
+            }
+        }
+
+        // Queue everything first so all devices are configured in parallel
+        uint32_t ids[live::MaxDevices][kSteps];
+        for (int d = 0; d < deviceCount; ++d) {
+            for (int step = 0; step < kSteps; ++step) {
+                uint8_t payload[3];
+                std::memcpy(payload, kSequence[step].payload, sizeof(payload));
+                ids[d][step] = g_commandQueue.submit(devices[d], kSequence[step].cmd, payload, kSequence[step].len);
+            }
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs > 0 ? timeoutMs : 5000);
+        int configured = 0;
+        for (int d = 0; d < deviceCount; ++d) {
+            DeviceConfigResult outcome{ devices[d], 0, 0, 0, 0 };
+            for (int step = 0; step < kSteps; ++step) {
+                int remaining = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count());
+                CommandResult completed;
+                int status;
+                if (ids[d][step] == 0) {
+                    status = static_cast<int>(CommandStatus::Rejected);
+                }
+                else if (!g_commandQueue.wait(ids[d][step], remaining > 0 ? remaining : 0, completed)) {
+                    // Stop it being resent after we return, so a retry by the
+                    // caller does not stack a second sequence on top of it
+                    g_commandQueue.cancel(ids[d][step]);
+                    status = static_cast<int>(CommandStatus::Timeout);
+                }
+                else {
+                    status = static_cast<int>(completed.status);
+                    outcome.attempts += completed.attempts;
+                    outcome.latencyUs = completed.latencyUs > outcome.latencyUs ? completed.latencyUs : outcome.latencyUs;
+                }
+                if (status != 0 && outcome.status == 0) {
+                    outcome.status = status;
+                    outcome.failedCommand = kSequence[step].cmd;
+                }
+            }
+            if (outcome.status == 0) configured++;
+            if (results && d < maxResults) results[d] = outcome;
+        }
+        return configured;
+    }
+    catch (...) {
+        return 0;
+    }
 }
\ No newline at end of file
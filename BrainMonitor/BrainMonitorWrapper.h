@@ -1,10 +1,14 @@
 #pragma once
 
+#if defined(_WIN32)
 #ifdef BRAINMIRRORWRAPPER_EXPORTS
 #define BRAINMIRROR_API __declspec(dllexport)
 #else
 #define BRAINMIRROR_API __declspec(dllimport)
 #endif
+#else
+#define BRAINMIRROR_API __attribute__((visibility("default")))
+#endif
 
 // 设备信息结构体 - C++版本
 struct DeviceInfo {
@@ -15,6 +19,195 @@ struct DeviceInfo {
     int state; // 0=disconnected, 1=connected
 };
 
+// 实时频段功率（相对功率0~1，每个分析窗口更新一次）
+struct BandPowerInfo {
+    float theta;
+    float alpha;
+    float beta;
+    float totalPower;
+    unsigned int epoch;
+    int sampleRate;
+};
+
+// 会话记录状态（state: 0=空闲, 1=记录中, 2=已结束）
+struct SessionInfo {
+    int state;
+    int streams;
+    unsigned int samplesPerStream;
+    int phases;
+    unsigned long long samples;
+    unsigned long long droppedSamples;
+};
+
+// 从会话日志恢复的会话（ended为1表示会话已正常结束；durableBytes为崩溃前已落盘的字节数，
+// recoveredBytes为实际恢复的字节数，进程崩溃而系统未崩溃时可大于durableBytes）
+struct RecoveredSession {
+    int streams;
+    unsigned int samplesPerStream;
+    int phases;
+    int ended;
+    unsigned long long samples;
+    unsigned long long records;
+    unsigned long long startUnixMs;
+    unsigned long long durableBytes;
+    unsigned long long recoveredBytes;
+    double elapsedMs;
+};
+
+// 会话日志状态（active为1表示正在记录会话，droppedRecords为日志已满时丢弃的记录数）
+struct SessionJournalStatus {
+    int open;
+    int active;
+    unsigned long long capacity;
+    unsigned long long writtenBytes;
+    unsigned long long durableBytes;
+    unsigned long long records;
+    unsigned long long droppedRecords;
+    unsigned long long checkpoints;
+    unsigned int lastCheckpointUs;
+};
+
+// 数据路径内存分配审计（enabled=0表示未使用BRAINMIRROR_ALLOC_AUDIT编译），
+// allocations/bytes为回调线程上的堆分配次数与字节数，arena为采集缓冲区使用情况
+struct AllocationAudit {
+    int enabled;
+    int trap;
+    unsigned long long allocations;
+    unsigned long long bytes;
+    unsigned long long arenaCapacity;
+    unsigned long long arenaUsed;
+    int arenaGrowths;
+};
+
+// 异步命令结果（status: 0=成功, 1=超时, 2=发送失败, 3=已取消, 4=被拒绝）
+struct CommandResultInfo {
+    int status;
+    int attempts;
+    unsigned int latencyUs;
+    int length;
+    unsigned char payload[32];
+};
+
+// 批量配置结果（每台设备一项，failedCommand为第一条失败的命令）
+struct DeviceConfigResult {
+    int dev;
+    int status;
+    unsigned char failedCommand;
+    int attempts;
+    unsigned int latencyUs;
+};
+
+// 分块上传参数（字符串均为UTF-8）。uploadId为16~64位小写十六进制，使用相同的uploadId可在中断后续传；
+// phase为-1时上传整段记录，chunkSeconds为每块的秒数（0=5秒）
+struct UploadOptions {
+    const char* host;
+    int port;
+    const char* token;
+    const char* uploadId;
+    const char* dataType;
+    const char* institutionId;
+    const char* staffName;
+    const char* testerName;
+    int phase;
+    int chunkSeconds;
+};
+
+// 分块上传状态（state: 0=空闲, 1=启动中, 2=上传中, 3=收尾中, 4=已完成, 5=失败, 6=已取消）
+struct UploadStatus {
+    int state;
+    int lastHttpStatus;
+    int testResultId;
+    int retries;
+    int queuedChunks;
+    unsigned long long chunksSent;
+    unsigned long long bytesSent;
+    unsigned long long samplesAcked;
+    unsigned long long samplesRecorded;
+};
+
+// 实时采集模式。offload非0时采集线程只把数据包放入环形缓冲区，由专用处理线程计算频段功率
+// （频段功率回调改在处理线程上触发）；priority为1~99的实时优先级（Linux为SCHED_FIFO，需要相应权限），
+// CPU掩码第n位对应第n个逻辑CPU，0表示不限制；latencyBudgetUs为从数据包到达到处理完成的延迟预算
+struct RealtimeOptions {
+    int offload;
+    int busyPoll;
+    int priority;
+    unsigned long long acquisitionCpuMask;
+    unsigned long long processingCpuMask;
+    int latencyBudgetUs;
+    int alarmIntervalMs;
+};
+
+// 实时模式状态与延迟统计（pinned/priority: -1=未设置, 0=系统拒绝, 1=已生效）
+struct RealtimeStatus {
+    int offload;
+    int busyPoll;
+    int acquisitionPinned;
+    int acquisitionPriority;
+    int processingPinned;
+    int processingPriority;
+    unsigned long long packets;
+    unsigned long long dropped;
+    unsigned long long exceeded;
+    unsigned long long alarms;
+    unsigned int p50Us;
+    unsigned int p90Us;
+    unsigned int p99Us;
+    unsigned int p999Us;
+    unsigned int maxUs;
+    double meanUs;
+};
+
+// 记录文件分析结果（闭眼算法，与BrainwaveDataProcessor一致）。valid为0表示文件无法解析，
+// success为0时error为原因；cached非0表示结果来自结果缓存；format: 0=未知, 1=CSV, 2=EDF；
+// psd为0~40Hz每0.5Hz一格的相对功率（占3~30Hz总功率的百分比）
+struct RecordingAnalysis {
+    int valid;
+    int success;
+    int cached;
+    int format;
+    double theta;
+    double alpha;
+    double beta;
+    double finalIndex;
+    unsigned long long sampleCount;
+    unsigned long long clippedCount;
+    unsigned long long skippedLines;
+    double mean;
+    double stdDeviation;
+    int warnings;
+    float psd[80];
+    char error[72];
+};
+
+// 结果缓存统计（open为0表示未打开缓存）
+struct ResultCacheStats {
+    int open;
+    unsigned long long entries;
+    unsigned long long capacity;
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long fileBytes;
+};
+
+// 本地数据流服务（tcpPort为-1时不监听TCP，0时自动分配端口；unixPath为NULL或空时不创建Unix套接字，仅POSIX）
+struct StreamServerOptions {
+    int tcpPort;
+    const char* unixPath;
+    int maxSubscribers;
+};
+
+// 数据流服务状态（帧数按最多64个样本一帧计算）
+struct StreamServerStatus {
+    int running;
+    int tcpPort;
+    int subscribers;
+    unsigned long long framesPublished;
+    unsigned long long framesDropped;   // 环形缓冲区已满（发送线程停滞）
+    unsigned long long framesSkipped;   // 过慢的订阅者跳过的帧
+    unsigned long long bytesSent;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -24,6 +217,9 @@ typedef void (*RawDataCallback)(int dev, int chan, int* data, int len);
 typedef void (*PostDataCallback)(int dev, unsigned char ele, unsigned char att, unsigned char med, unsigned char res, unsigned int psd[8]);
 typedef void (*BattInfoCallback)(int dev, unsigned int level, unsigned int vol);
 typedef void (*EventCallback)(unsigned int event, unsigned int param);
+typedef void (*BandPowerCallback)(int dev, int chan, float theta, float alpha, float beta);
+typedef void (*CommandCallback)(unsigned int requestId, int dev, unsigned char cmd, int status, unsigned char* payload, int len);
+typedef void (*LatencyAlarmCallback)(int dev, int chan, unsigned int latencyUs, unsigned int budgetUs);
 
 // SDK初始化和清理
 BRAINMIRROR_API int SDK_Init();
@@ -54,10 +250,93 @@ BRAINMIRROR_API void SDK_SetPostDataCallback(PostDataCallback callback);
 BRAINMIRROR_API void SDK_SetBattInfoCallback(BattInfoCallback callback);
 BRAINMIRROR_API void SDK_SetEventCallback(EventCallback callback);
 
+// 实时频段功率（按设备类型在连接时选择处理管线）
+BRAINMIRROR_API void SDK_SetBandPowerCallback(BandPowerCallback callback);
+BRAINMIRROR_API int SDK_GetBandPower(int dev, int chan, BandPowerInfo* info);
+// 处理管线运算方式：0=双精度浮点，1=定点（直接处理原始int样本，适合低功耗工作站），对之后连接的设备生效
+BRAINMIRROR_API void SDK_SetPipelineArithmetic(int fixedPoint);
+
+// 实时采集模式（线程绑定CPU、提升优先级、忙轮询、延迟预算告警），options为NULL时关闭；SDK_Cleanup后恢复默认
+BRAINMIRROR_API int SDK_SetRealtimeMode(const RealtimeOptions* options);
+BRAINMIRROR_API int SDK_GetRealtimeStatus(RealtimeStatus* status);
+BRAINMIRROR_API void SDK_ResetLatencyStats();
+// 超出延迟预算时回调（每个告警间隔最多一次，在处理线程上调用）
+BRAINMIRROR_API void SDK_SetLatencyAlarmCallback(LatencyAlarmCallback callback);
+
 // 设备控制
 BRAINMIRROR_API int SDK_SendCommand(int dev, unsigned char cmd);
 BRAINMIRROR_API int SDK_SendCommandWithPayload(int dev, unsigned char cmd, unsigned char* payload, unsigned char len);
 
+// 异步命令队列（按(设备,命令)匹配应答，超时重发；所有已连接设备并行配置）
+BRAINMIRROR_API void SDK_SetCommandOptions(int timeoutMs, int retries, int windowPerDevice);
+BRAINMIRROR_API unsigned int SDK_SendCommandAsync(int dev, unsigned char cmd, unsigned char* payload, unsigned char len, CommandCallback callback);
+BRAINMIRROR_API int SDK_WaitCommand(unsigned int requestId, int timeoutMs, CommandResultInfo* result);
+BRAINMIRROR_API int SDK_ConfigureAllDevices(int timeoutMs, DeviceConfigResult* results, int maxResults);
+
+// 会话记录（阶段标记精确到原始数据的采样点，阶段数据以指针返回，下次SDK_BeginSession前有效）
+// 每台设备按设备配置与已收到原始数据的通道数（取较大者）分配记录流，多通道设备应在开始采集后再开始会话
+BRAINMIRROR_API int SDK_BeginSession(unsigned int maxSamplesPerStream);
+BRAINMIRROR_API int SDK_MarkPhase(const char* label);
+BRAINMIRROR_API int SDK_EndSession();
+BRAINMIRROR_API int SDK_GetPhaseCount();
+BRAINMIRROR_API const char* SDK_GetPhaseLabel(int phase);
+BRAINMIRROR_API int SDK_FindPhase(const char* label);
+BRAINMIRROR_API int SDK_GetPhaseSlice(int dev, int chan, int phase, const int** data, int* count);
+BRAINMIRROR_API int SDK_GetSessionInfo(SessionInfo* info);
+
+// 会话预写日志（崩溃或重新初始化后可恢复）：打开后每次SDK_BeginSession的原始数据、阶段标记和会话结束
+// 写入预分配的内存映射文件，后台线程每flushIntervalMs毫秒（及每个阶段标记后）落盘一次；path为UTF-8。
+// 日志不受SDK_Cleanup影响；SDK_RecoverSession在开始采集前调用，把日志中的会话重建到会话记录中，
+// 之后继续记录（阶段数据可直接通过SDK_GetPhaseSlice读取）；返回0表示没有可恢复的会话。
+// 日志打开时，若无法为新会话分配日志空间，SDK_BeginSession返回0且不开始记录
+BRAINMIRROR_API int SDK_OpenSessionJournal(const char* path, int flushIntervalMs);
+BRAINMIRROR_API void SDK_CloseSessionJournal();
+BRAINMIRROR_API int SDK_FlushSessionJournal();
+BRAINMIRROR_API int SDK_RecoverSession(RecoveredSession* info);
+BRAINMIRROR_API int SDK_GetSessionJournalStatus(SessionJournalStatus* status);
+// 会话结束后生成频谱图瓦片文件（.bmspec），phase为-1时使用整段记录；path为UTF-8
+BRAINMIRROR_API int SDK_WriteSpectrogram(int dev, int chan, int phase, const char* path);
+
+// 通道间连接性（相干性、锁相值、频带相关），输出矩阵按[频带][i][j]排列，频带0~2=theta/alpha/beta，
+// 每个输出数组需容纳 3*通道数*通道数 个float，不需要的输出可传NULL
+// samples按通道依次存放，每个通道samplesPerChannel个样本
+BRAINMIRROR_API int SDK_ComputeConnectivity(const double* samples, int channels, int samplesPerChannel, double sampleRate,
+                                            float* coherence, float* plv, float* correlation);
+// 对会话中所有设备的所有通道计算连接性，phase为-1时使用整段记录；返回流数量（0=失败），
+// devs/chans返回每一行对应的设备与通道
+BRAINMIRROR_API int SDK_ComputeSessionConnectivity(int phase, int maxStreams, int* devs, int* chans,
+                                                   float* coherence, float* plv, float* correlation);
+
+// 分析结果缓存（按文件内容哈希+算法版本+参数保存分析结果，内容和算法不变时直接返回，无需重新计算），
+// path为UTF-8；缓存文件同一时间只能被一个进程打开
+BRAINMIRROR_API int SDK_OpenResultCache(const char* path);
+BRAINMIRROR_API void SDK_CloseResultCache();
+BRAINMIRROR_API int SDK_GetResultCacheStats(ResultCacheStats* stats);
+// 分析CSV/EDF记录文件（path为UTF-8），打开了结果缓存时优先使用缓存；返回0表示文件无法读取
+BRAINMIRROR_API int SDK_AnalyzeRecordingFile(const char* path, RecordingAnalysis* result);
+
+// 本地数据流服务：外部程序通过127.0.0.1的TCP端口（或Unix套接字）订阅实时原始数据，协议见native/StreamServer.h；
+// 回调线程只把数据写入预分配的环形缓冲区，开销与订阅者数量无关；SDK_Cleanup不会停止服务
+BRAINMIRROR_API int SDK_StartStreamServer(const StreamServerOptions* options);
+BRAINMIRROR_API void SDK_StopStreamServer();
+BRAINMIRROR_API int SDK_GetStreamServerStatus(StreamServerStatus* status);
+
+// 边记录边分块上传（增量压缩、内容哈希校验、断点续传、后台有界队列），每台设备一个上传任务；
+// SDK_FinishUpload上传剩余数据并在服务器端合成CSV，返回1表示服务器已完成分析
+BRAINMIRROR_API int SDK_StartUpload(int dev, const UploadOptions* options);
+BRAINMIRROR_API int SDK_FinishUpload(int dev, int timeoutMs);
+BRAINMIRROR_API void SDK_CancelUpload(int dev);
+BRAINMIRROR_API int SDK_GetUploadStatus(int dev, UploadStatus* status);
+
+// 内存分配审计，trap非0时数据路径上的下一次堆分配直接终止进程（仅调试用）
+BRAINMIRROR_API int SDK_GetAllocationAudit(AllocationAudit* audit);
+BRAINMIRROR_API void SDK_ResetAllocationAudit(int trap);
+
+// 二进制日志（后台线程落盘，回调线程只写入无锁缓冲区）；directory为UTF-8
+BRAINMIRROR_API int SDK_StartLogging(const char* directory, unsigned int maxFileBytes, unsigned int maxFileSeconds);
+BRAINMIRROR_API void SDK_StopLogging();
+BRAINMIRROR_API unsigned int SDK_GetLogDroppedCount();
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -19,11 +19,241 @@ namespace BrainMirror.SDK
         public int State; // 0=disconnected, 1=connected
     }
 
+    // 实时频段功率（相对功率0~1）
+    [StructLayout(LayoutKind.Sequential)]
+    public struct BandPowerInfo
+    {
+        public float Theta;
+        public float Alpha;
+        public float Beta;
+        public float TotalPower;
+        public uint Epoch;
+        public int SampleRate;
+    }
+
+    // 会话记录状态（State: 0=空闲, 1=记录中, 2=已结束）
+    [StructLayout(LayoutKind.Sequential)]
+    public struct SessionInfo
+    {
+        public int State;
+        public int Streams;
+        public uint SamplesPerStream;
+        public int Phases;
+        public ulong Samples;
+        public ulong DroppedSamples;
+    }
+
+    // 从会话日志恢复的会话（Ended为1表示会话已正常结束）
+    [StructLayout(LayoutKind.Sequential)]
+    public struct RecoveredSession
+    {
+        public int Streams;
+        public uint SamplesPerStream;
+        public int Phases;
+        public int Ended;
+        public ulong Samples;
+        public ulong Records;
+        public ulong StartUnixMs;
+        public ulong DurableBytes;      // 崩溃前已落盘的字节数
+        public ulong RecoveredBytes;    // 实际恢复的字节数
+        public double ElapsedMs;
+    }
+
+    // 会话日志状态
+    [StructLayout(LayoutKind.Sequential)]
+    public struct SessionJournalStatus
+    {
+        public int Open;
+        public int Active;
+        public ulong Capacity;
+        public ulong WrittenBytes;
+        public ulong DurableBytes;
+        public ulong Records;
+        public ulong DroppedRecords;    // 日志已满
+        public ulong Checkpoints;
+        public uint LastCheckpointUs;
+    }
+
+    // 异步命令结果（Status: 0=成功, 1=超时, 2=发送失败, 3=已取消, 4=被拒绝）
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandResultInfo
+    {
+        public int Status;
+        public int Attempts;
+        public uint LatencyUs;
+        public int Length;
+
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 32)]
+        public byte[] Payload;
+    }
+
+    // 批量配置结果
+    [StructLayout(LayoutKind.Sequential)]
+    public struct DeviceConfigResult
+    {
+        public int Dev;
+        public int Status;
+        public byte FailedCommand;
+        public int Attempts;
+        public uint LatencyUs;
+    }
+
+    // 数据路径内存分配审计
+    [StructLayout(LayoutKind.Sequential)]
+    public struct AllocationAudit
+    {
+        public int Enabled;
+        public int Trap;
+        public ulong Allocations;
+        public ulong Bytes;
+        public ulong ArenaCapacity;
+        public ulong ArenaUsed;
+        public int ArenaGrowths;
+    }
+
+    // 实时采集模式（CPU掩码第n位对应第n个逻辑CPU，0表示不限制；Priority为1~99的实时优先级，0表示不变）
+    [StructLayout(LayoutKind.Sequential)]
+    public struct RealtimeOptions
+    {
+        public int Offload;
+        public int BusyPoll;
+        public int Priority;
+        public ulong AcquisitionCpuMask;
+        public ulong ProcessingCpuMask;
+        public int LatencyBudgetUs;
+        public int AlarmIntervalMs;
+    }
+
+    // 实时模式状态与延迟统计（Pinned/Priority: -1=未设置, 0=系统拒绝, 1=已生效）
+    [StructLayout(LayoutKind.Sequential)]
+    public struct RealtimeStatus
+    {
+        public int Offload;
+        public int BusyPoll;
+        public int AcquisitionPinned;
+        public int AcquisitionPriority;
+        public int ProcessingPinned;
+        public int ProcessingPriority;
+        public ulong Packets;
+        public ulong Dropped;
+        public ulong Exceeded;
+        public ulong Alarms;
+        public uint P50Us;
+        public uint P90Us;
+        public uint P99Us;
+        public uint P999Us;
+        public uint MaxUs;
+        public double MeanUs;
+    }
+
+    // 记录文件分析结果（Valid为0表示文件无法解析，Cached非0表示来自结果缓存，Format: 0=未知, 1=CSV, 2=EDF）
+    // Psd为0~40Hz每0.5Hz一格的相对功率（占3~30Hz总功率的百分比）
+    [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+    public struct RecordingAnalysis
+    {
+        public int Valid;
+        public int Success;
+        public int Cached;
+        public int Format;
+        public double Theta;
+        public double Alpha;
+        public double Beta;
+        public double FinalIndex;
+        public ulong SampleCount;
+        public ulong ClippedCount;
+        public ulong SkippedLines;
+        public double Mean;
+        public double StdDeviation;
+        public int Warnings;
+
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 80)]
+        public float[] Psd;
+
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 72)]
+        public string Error;
+    }
+
+    // 结果缓存统计（Open为0表示未打开缓存）
+    [StructLayout(LayoutKind.Sequential)]
+    public struct ResultCacheStats
+    {
+        public int Open;
+        public ulong Entries;
+        public ulong Capacity;
+        public ulong Hits;
+        public ulong Misses;
+        public ulong FileBytes;
+    }
+
+    // 本地数据流服务参数（TcpPort为-1时不监听TCP，0时自动分配端口；UnixPath为null时不创建Unix套接字）
+    [StructLayout(LayoutKind.Sequential)]
+    public struct StreamServerOptions
+    {
+        public int TcpPort;
+        [MarshalAs(UnmanagedType.LPUTF8Str)]
+        public string UnixPath;
+        public int MaxSubscribers;
+    }
+
+    // 数据流服务状态
+    [StructLayout(LayoutKind.Sequential)]
+    public struct StreamServerStatus
+    {
+        public int Running;
+        public int TcpPort;
+        public int Subscribers;
+        public ulong FramesPublished;
+        public ulong FramesDropped;     // 环形缓冲区已满
+        public ulong FramesSkipped;     // 过慢的订阅者跳过的帧
+        public ulong BytesSent;
+    }
+
+    // 分块上传参数（UploadId为16~64位小写十六进制，相同的UploadId可续传；Phase为-1时上传整段记录）
+    [StructLayout(LayoutKind.Sequential)]
+    public struct UploadOptions
+    {
+        [MarshalAs(UnmanagedType.LPUTF8Str)]
+        public string Host;
+        public int Port;
+        [MarshalAs(UnmanagedType.LPUTF8Str)]
+        public string Token;
+        [MarshalAs(UnmanagedType.LPUTF8Str)]
+        public string UploadId;
+        [MarshalAs(UnmanagedType.LPUTF8Str)]
+        public string DataType;
+        [MarshalAs(UnmanagedType.LPUTF8Str)]
+        public string InstitutionId;
+        [MarshalAs(UnmanagedType.LPUTF8Str)]
+        public string StaffName;
+        [MarshalAs(UnmanagedType.LPUTF8Str)]
+        public string TesterName;
+        public int Phase;
+        public int ChunkSeconds;
+    }
+
+    // 分块上传状态（State: 0=空闲, 1=启动中, 2=上传中, 3=收尾中, 4=已完成, 5=失败, 6=已取消）
+    [StructLayout(LayoutKind.Sequential)]
+    public struct UploadStatus
+    {
+        public int State;
+        public int LastHttpStatus;
+        public int TestResultId;
+        public int Retries;
+        public int QueuedChunks;
+        public ulong ChunksSent;
+        public ulong BytesSent;
+        public ulong SamplesAcked;
+        public ulong SamplesRecorded;
+    }
+
     // 回调函数委托
     public delegate void RawDataCallback(int dev, int chan, IntPtr data, int len);
     public delegate void PostDataCallback(int dev, byte ele, byte att, byte med, byte res, IntPtr psd);
     public delegate void BattInfoCallback(int dev, uint level, uint vol);
     public delegate void EventCallback(uint eventType, uint param);
+    public delegate void BandPowerCallback(int dev, int chan, float theta, float alpha, float beta);
+    public delegate void CommandCallback(uint requestId, int dev, byte cmd, int status, IntPtr payload, int len);
+    public delegate void LatencyAlarmCallback(int dev, int chan, uint latencyUs, uint budgetUs);
 
     public static class BrainMonitorSDK
     {
@@ -120,6 +350,33 @@ namespace BrainMirror.SDK
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern void SDK_SetEventCallback(EventCallback callback);
 
+        // 实时频段功率
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SDK_SetBandPowerCallback(BandPowerCallback callback);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_GetBandPower(int dev, int chan, ref BandPowerInfo info);
+
+        // 处理管线运算方式：0=双精度浮点，1=定点，对之后连接的设备生效
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SDK_SetPipelineArithmetic(int fixedPoint);
+
+        // 实时采集模式，options为null时关闭（频段功率回调在处理线程上触发）
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_SetRealtimeMode(ref RealtimeOptions options);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, EntryPoint = "SDK_SetRealtimeMode")]
+        public static extern int SDK_DisableRealtimeMode(IntPtr options);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_GetRealtimeStatus(ref RealtimeStatus status);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SDK_ResetLatencyStats();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SDK_SetLatencyAlarmCallback(LatencyAlarmCallback callback);
+
         // 设备控制
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern int SDK_SendCommand(int dev, byte cmd);
@@ -127,6 +384,126 @@ namespace BrainMirror.SDK
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern int SDK_SendCommandWithPayload(int dev, byte cmd, IntPtr payload, byte len);
 
+        // 异步命令队列
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SDK_SetCommandOptions(int timeoutMs, int retries, int windowPerDevice);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint SDK_SendCommandAsync(int dev, byte cmd, IntPtr payload, byte len, CommandCallback callback);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_WaitCommand(uint requestId, int timeoutMs, ref CommandResultInfo result);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_ConfigureAllDevices(int timeoutMs, [Out] DeviceConfigResult[] results, int maxResults);
+
+        // 会话记录
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_BeginSession(uint maxSamplesPerStream);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_MarkPhase([MarshalAs(UnmanagedType.LPStr)] string label);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_EndSession();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_GetPhaseCount();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr SDK_GetPhaseLabel(int phase);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_FindPhase([MarshalAs(UnmanagedType.LPStr)] string label);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_GetPhaseSlice(int dev, int chan, int phase, out IntPtr data, out int count);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_GetSessionInfo(ref SessionInfo info);
+
+        // 会话预写日志，SDK_RecoverSession在开始采集前调用，返回0表示没有可恢复的会话
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_OpenSessionJournal([MarshalAs(UnmanagedType.LPUTF8Str)] string path, int flushIntervalMs);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SDK_CloseSessionJournal();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_FlushSessionJournal();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_RecoverSession(out RecoveredSession info);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_GetSessionJournalStatus(ref SessionJournalStatus status);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_WriteSpectrogram(int dev, int chan, int phase, [MarshalAs(UnmanagedType.LPUTF8Str)] string path);
+
+        // 通道间连接性，矩阵按[频带][i][j]排列（频带0~2=theta/alpha/beta）
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_ComputeConnectivity(double[] samples, int channels, int samplesPerChannel, double sampleRate,
+            [Out] float[] coherence, [Out] float[] plv, [Out] float[] correlation);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_ComputeSessionConnectivity(int phase, int maxStreams, [Out] int[] devs, [Out] int[] chans,
+            [Out] float[] coherence, [Out] float[] plv, [Out] float[] correlation);
+
+        // 分析结果缓存（按文件内容哈希+算法版本+参数缓存），同一时间只能被一个进程打开
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_OpenResultCache([MarshalAs(UnmanagedType.LPUTF8Str)] string path);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SDK_CloseResultCache();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_GetResultCacheStats(ref ResultCacheStats stats);
+
+        // 分析CSV/EDF记录文件，打开了结果缓存时优先使用缓存；返回0表示文件无法读取
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_AnalyzeRecordingFile([MarshalAs(UnmanagedType.LPUTF8Str)] string path, out RecordingAnalysis result);
+
+        // 本地数据流服务（外部程序订阅实时原始数据），SDK_Cleanup不会停止服务
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_StartStreamServer(ref StreamServerOptions options);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SDK_StopStreamServer();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_GetStreamServerStatus(ref StreamServerStatus status);
+
+        // 边记录边分块上传（断点续传），SDK_FinishUpload返回1表示服务器已完成分析
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_StartUpload(int dev, ref UploadOptions options);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_FinishUpload(int dev, int timeoutMs);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SDK_CancelUpload(int dev);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_GetUploadStatus(int dev, ref UploadStatus status);
+
+        // 内存分配审计
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_GetAllocationAudit(ref AllocationAudit audit);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SDK_ResetAllocationAudit(int trap);
+
+        // 二进制日志
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SDK_StartLogging([MarshalAs(UnmanagedType.LPUTF8Str)] string directory, uint maxFileBytes, uint maxFileSeconds);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SDK_StopLogging();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint SDK_GetLogDroppedCount();
+
         // 辅助方法
         public static string GetVersionString()
         {
@@ -139,5 +516,24 @@ namespace BrainMirror.SDK
             IntPtr ptr = SDK_CheckPort();
             return ptr != IntPtr.Zero ? Marshal.PtrToStringAnsi(ptr) : string.Empty;
         }
+
+        // 复制某一阶段的原始数据（找不到阶段时返回空数组）
+        public static double[] GetPhaseSamples(int dev, int chan, string label)
+        {
+            int phase = SDK_FindPhase(label);
+            if (phase < 0 || SDK_GetPhaseSlice(dev, chan, phase, out IntPtr data, out int count) == 0 || count == 0)
+            {
+                return Array.Empty<double>();
+            }
+
+            int[] raw = new int[count];
+            Marshal.Copy(data, raw, 0, count);
+            double[] samples = new double[count];
+            for (int i = 0; i < count; i++)
+            {
+                samples[i] = raw[i];
+            }
+            return samples;
+        }
     }
 }
\ No newline at end of file
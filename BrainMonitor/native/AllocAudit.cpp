@@ -0,0 +1,149 @@
+#include "AllocAudit.h"
+
+#include <atomic>
+#include <cstddef>
+
+#if defined(BRAINMIRROR_ALLOC_AUDIT)
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#endif
+
+namespace brainmirror {
+namespace allocaudit {
+
+#if defined(BRAINMIRROR_ALLOC_AUDIT)
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{ 0 };
+std::atomic<uint64_t> g_bytes{ 0 };
+std::atomic<bool> g_trap{ false };
+thread_local int t_depth = 0;
+
+} // namespace
+
+HotPathScope::HotPathScope() { ++t_depth; }
+HotPathScope::~HotPathScope() { --t_depth; }
+
+Counters counters() {
+    Counters counters;
+    counters.enabled = true;
+    counters.trap = g_trap.load(std::memory_order_relaxed);
+    counters.allocations = g_allocations.load(std::memory_order_relaxed);
+    counters.bytes = g_bytes.load(std::memory_order_relaxed);
+    return counters;
+}
+
+void reset(bool trap) {
+    g_allocations.store(0, std::memory_order_relaxed);
+    g_bytes.store(0, std::memory_order_relaxed);
+    g_trap.store(trap, std::memory_order_relaxed);
+}
+
+// Called by every operator new below
+static void record(size_t size) {
+    if (t_depth == 0) return;
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (g_trap.load(std::memory_order_relaxed)) {
+        t_depth = 0;
+        std::fprintf(stderr, "allocaudit: %zu byte allocation on the data path\n", size);
+        std::abort();
+    }
+}
+
+static void* allocate(size_t size, size_t alignment) {
+    record(size);
+    if (size == 0) size = 1;
+    void* p = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        p = std::malloc(size);
+    }
+    else {
+#if defined(_MSC_VER)
+        p = _aligned_malloc(size, alignment);
+#else
+        size = (size + alignment - 1) / alignment * alignment;
+        p = std::aligned_alloc(alignment, size);
+#endif
+    }
+    return p;
+}
+
+static void deallocate(void* p, size_t alignment) {
+    if (!p) return;
+#if defined(_MSC_VER)
+    if (alignment > alignof(std::max_align_t)) {
+        _aligned_free(p);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    std::free(p);
+}
+
+#else
+
+Counters counters() {
+    return Counters();
+}
+
+void reset(bool) {
+}
+
+#endif
+
+} // namespace allocaudit
+} // namespace brainmirror
+
+#if defined(BRAINMIRROR_ALLOC_AUDIT)
+
+using brainmirror::allocaudit::allocate;
+using brainmirror::allocaudit::deallocate;
+
+void* operator new(size_t size) {
+    void* p = allocate(size, 0);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    void* p = allocate(size, 0);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size, 0);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    void* p = allocate(size, static_cast<size_t>(alignment));
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    void* p = allocate(size, static_cast<size_t>(alignment));
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { deallocate(p, 0); }
+void operator delete[](void* p) noexcept { deallocate(p, 0); }
+void operator delete(void* p, size_t) noexcept { deallocate(p, 0); }
+void operator delete[](void* p, size_t) noexcept { deallocate(p, 0); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { deallocate(p, 0); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { deallocate(p, 0); }
+void operator delete(void* p, std::align_val_t alignment) noexcept { deallocate(p, static_cast<size_t>(alignment)); }
+void operator delete[](void* p, std::align_val_t alignment) noexcept { deallocate(p, static_cast<size_t>(alignment)); }
+void operator delete(void* p, size_t, std::align_val_t alignment) noexcept { deallocate(p, static_cast<size_t>(alignment)); }
+void operator delete[](void* p, size_t, std::align_val_t alignment) noexcept { deallocate(p, static_cast<size_t>(alignment)); }
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap allocation audit for the data path. When the SDK is built with
+// BRAINMIRROR_ALLOC_AUDIT, global operator new/delete are replaced and every
+// allocation made while a HotPathScope is active on the calling thread is
+// counted (or aborts the process in trap mode). The wrapper opens a scope in
+// each vendor callback, so "no allocations per packet in steady state" can be
+// checked by brainbench and the soak tool.
+//
+// Without BRAINMIRROR_ALLOC_AUDIT the scope compiles to nothing and the
+// counters stay at zero.
+namespace brainmirror {
+namespace allocaudit {
+
+struct Counters {
+    bool enabled = false;
+    bool trap = false;
+    uint64_t allocations = 0;       // Inside a hot path scope
+    uint64_t bytes = 0;
+};
+
+#if defined(BRAINMIRROR_ALLOC_AUDIT)
+class HotPathScope {
+public:
+    HotPathScope();
+    ~HotPathScope();
+    HotPathScope(const HotPathScope&) = delete;
+    HotPathScope& operator=(const HotPathScope&) = delete;
+};
+#else
+// User-provided and empty, like the audited scope's, so a scope declared only
+// for its lifetime is not reported as an unused variable.
+class HotPathScope {
+public:
+    HotPathScope() {}
+    ~HotPathScope() {}
+    HotPathScope(const HotPathScope&) = delete;
+    HotPathScope& operator=(const HotPathScope&) = delete;
+};
+#endif
+
+Counters counters();
+// Clears the counters; with trap set, the next hot path allocation aborts.
+void reset(bool trap);
+
+} // namespace allocaudit
+} // namespace brainmirror
@@ -0,0 +1,66 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace brainmirror {
+
+Arena::Arena(size_t blockSize)
+    : m_blockSize(blockSize > 0 ? blockSize : 4096) {
+}
+
+void Arena::addBlock(size_t bytes) {
+    Block block;
+    block.size = std::max(bytes, m_blockSize);
+    block.memory.reset(new unsigned char[block.size]);
+    std::memset(block.memory.get(), 0, block.size);
+    m_blocks.push_back(std::move(block));
+}
+
+void Arena::reserve(size_t bytes) {
+    if (available() >= bytes) return;
+    // Room for worst-case alignment padding of a few allocations
+    addBlock(bytes + 256);
+}
+
+void* Arena::allocate(size_t bytes, size_t alignment) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) alignment = alignof(std::max_align_t);
+
+    if (!m_blocks.empty()) {
+        Block& block = m_blocks.back();
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.memory.get());
+        uintptr_t aligned = (base + block.used + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        size_t end = static_cast<size_t>(aligned - base) + bytes;
+        if (end <= block.size) {
+            block.used = end;
+            return reinterpret_cast<void*>(aligned);
+        }
+    }
+
+    addBlock(bytes + alignment);
+    ++m_growths;
+    return allocate(bytes, alignment);
+}
+
+void Arena::release() {
+    m_blocks.clear();
+    m_growths = 0;
+}
+
+size_t Arena::available() const {
+    return m_blocks.empty() ? 0 : m_blocks.back().size - m_blocks.back().used;
+}
+
+Arena::Stats Arena::stats() const {
+    Stats stats;
+    for (const auto& block : m_blocks) {
+        stats.capacity += block.size;
+        stats.used += block.used;
+    }
+    stats.blocks = m_blocks.size();
+    stats.growths = m_growths;
+    return stats;
+}
+
+} // namespace brainmirror
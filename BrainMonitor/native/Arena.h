@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Monotonic arena for buffers that live as long as the SDK session (live
+// pipeline epoch history, FFT work buffers). Memory is carved from large
+// blocks and only returned by release(), so pointers stay valid for
+// callbacks that may still be running after a device is replaced.
+//
+// reserve() is called ahead of the data path (SDK_StartDataCollection);
+// allocate() only touches the heap when the reserved space runs out.
+namespace brainmirror {
+
+class Arena {
+public:
+    struct Stats {
+        size_t capacity = 0;        // Bytes in all blocks
+        size_t used = 0;            // Bytes handed out, including alignment padding
+        size_t blocks = 0;
+        size_t growths = 0;         // Blocks added by allocate() rather than reserve()
+    };
+
+    explicit Arena(size_t blockSize = 64 * 1024);
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Makes sure at least `bytes` can be allocated without touching the heap.
+    void reserve(size_t bytes);
+    // Zero-filled, aligned memory. Never returns nullptr (throws std::bad_alloc).
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Frees every block; all pointers handed out become invalid.
+    void release();
+
+    size_t available() const;
+    Stats stats() const;
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> memory;
+        size_t size = 0;
+        size_t used = 0;
+    };
+
+    size_t m_blockSize;
+    std::vector<Block> m_blocks;
+    size_t m_growths = 0;
+
+    void addBlock(size_t bytes);
+};
+
+} // namespace brainmirror
@@ -0,0 +1,335 @@
+#include "BinaryLog.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace brainmirror {
+namespace blog {
+
+namespace {
+
+struct FormatDef {
+    MsgId id;
+    uint16_t argc;
+    const char* text;
+};
+
+const FormatDef kFormats[] = {
+    { Msg_LogDropped, 2, "[log] thread=%lld dropped=%lld records" },
+    { Msg_RawData,    3, "[rawdata] dev=%lld channel=%lld len=%lld" },
+    { Msg_PostData,   4, "[state] dev=%lld ele=%lld att=%lld med=%lld" },
+    { Msg_BattInfo,   3, "[batinfo] dev=%lld level=%lld vol=%lld" },
+    { Msg_CmdResp,    3, "[cmd resp] dev=%lld cmd=%llx len=%lld" },
+    { Msg_Event,      2, "[event] event=%lld param=%lld" },
+    { Msg_CmdSend,    3, "[cmd send] dev=%lld cmd=%llx attempt=%lld" },
+    { Msg_CmdTimeout, 3, "[cmd timeout] dev=%lld cmd=%llx attempts=%lld" },
+    { Msg_LatencyAlarm, 4, "[latency] dev=%lld channel=%lld latency_us=%lld budget_us=%lld" },
+};
+static_assert(sizeof(kFormats) / sizeof(kFormats[0]) == Msg_Count, "format table out of sync with MsgId");
+
+constexpr uint32_t kRingSize = 4096;
+constexpr uint32_t kRingMask = kRingSize - 1;
+// Thread buffers allocated by the first start(). Vendor callback, dispatcher
+// and API threads together stay well below this; threads beyond it have
+// their records counted as dropped.
+constexpr int kMaxThreads = 32;
+
+uint64_t steadyNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+enum BufferState : uint32_t {
+    Buffer_Free = 0,
+    Buffer_Owned,           // Claimed by a thread
+    Buffer_Orphaned,        // Owner exited; returned to the pool once drained
+};
+
+// Single-producer (owning thread) / single-consumer (flusher) ring.
+struct ThreadBuffer {
+    alignas(64) std::atomic<uint32_t> head{ 0 };
+    alignas(64) std::atomic<uint32_t> tail{ 0 };
+    alignas(64) std::atomic<uint64_t> dropped{ 0 };
+    uint64_t droppedReported = 0;   // Flusher only
+    std::atomic<uint32_t> state{ Buffer_Free };
+    uint32_t threadId = 0;
+    Record records[kRingSize];
+};
+
+class Logger {
+public:
+    std::atomic<bool> running{ false };
+    std::atomic<uint64_t> totalDropped{ 0 };
+
+    bool start(const Config& config) {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        if (running.load()) return true;
+
+        m_config = config;
+        if (!openFile()) return false;
+
+        // Allocated once and never freed, so the data path claims buffers
+        // without allocating or locking, and threads may keep theirs
+        // across stop()/start()
+        if (!m_pool.load(std::memory_order_relaxed)) {
+            m_pool.store(new ThreadBuffer[kMaxThreads], std::memory_order_release);
+        }
+
+        m_stop = false;
+        m_thread = std::thread(&Logger::flusherLoop, this);
+        running.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        if (!running.load()) return;
+
+        running.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> wake(m_wakeMutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        if (m_thread.joinable()) m_thread.join();
+
+        drainAll();
+        closeFile();
+    }
+
+    // Lock-free; nullptr when every buffer is taken.
+    ThreadBuffer* claimBuffer() {
+        ThreadBuffer* pool = m_pool.load(std::memory_order_acquire);
+        if (!pool) return nullptr;
+        for (int i = 0; i < kMaxThreads; ++i) {
+            uint32_t expected = Buffer_Free;
+            if (pool[i].state.compare_exchange_strong(expected, Buffer_Owned, std::memory_order_acquire)) {
+                pool[i].threadId = m_nextThreadId.fetch_add(1, std::memory_order_relaxed) + 1;
+                return &pool[i];
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    std::mutex m_controlMutex;
+    std::atomic<ThreadBuffer*> m_pool{ nullptr };
+    std::atomic<uint32_t> m_nextThreadId{ 0 };
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+    std::thread m_thread;
+
+    Config m_config;
+    std::FILE* m_file = nullptr;
+    uint64_t m_fileBytes = 0;
+    uint64_t m_fileOpenedNs = 0;
+    uint32_t m_fileSequence = 0;
+    std::deque<std::filesystem::path> m_writtenFiles;
+    std::vector<Record> m_batch;
+
+    std::filesystem::path nextFilePath() {
+        std::time_t now = std::time(nullptr);
+        std::tm local{};
+#if defined(_WIN32)
+        localtime_s(&local, &now);
+#else
+        localtime_r(&now, &local);
+#endif
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &local);
+
+        char name[64];
+        snprintf(name, sizeof(name), "_%s_%03u.blog", stamp, m_fileSequence++);
+
+        return m_config.directory / (m_config.baseName + name);
+    }
+
+    bool openFile() {
+        std::filesystem::path path = nextFilePath();
+#if defined(_WIN32)
+        m_file = _wfopen(path.c_str(), L"wb");
+#else
+        m_file = std::fopen(path.c_str(), "wb");
+#endif
+        if (!m_file) return false;
+
+        FileHeader header{};
+        std::memcpy(header.magic, kFileMagic, sizeof(header.magic));
+        header.version = kFileVersion;
+        header.formatCount = Msg_Count;
+        header.wallClockNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        header.steadyNs = static_cast<int64_t>(steadyNowNs());
+        m_fileBytes = std::fwrite(&header, 1, sizeof(header), m_file);
+
+        for (const auto& format : kFormats) {
+            FormatEntry entry{};
+            entry.id = format.id;
+            entry.argc = format.argc;
+            entry.length = static_cast<uint16_t>(std::strlen(format.text));
+            m_fileBytes += std::fwrite(&entry, 1, sizeof(entry), m_file);
+            m_fileBytes += std::fwrite(format.text, 1, entry.length, m_file);
+        }
+
+        m_fileOpenedNs = steadyNowNs();
+        m_writtenFiles.push_back(path);
+        while (m_config.maxFiles > 0 && m_writtenFiles.size() > m_config.maxFiles) {
+            std::error_code ec;
+            std::filesystem::remove(m_writtenFiles.front(), ec);
+            m_writtenFiles.pop_front();
+        }
+        return true;
+    }
+
+    void closeFile() {
+        if (m_file) {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+    }
+
+    void rotateIfNeeded() {
+        bool tooBig = m_config.maxFileBytes > 0 && m_fileBytes >= m_config.maxFileBytes;
+        bool tooOld = m_config.maxFileSeconds > 0 &&
+            steadyNowNs() - m_fileOpenedNs >= uint64_t(m_config.maxFileSeconds) * 1000000000ull;
+        if (!tooBig && !tooOld) return;
+
+        closeFile();
+        openFile();
+    }
+
+    void drainBuffer(ThreadBuffer* buffer) {
+        uint32_t head = buffer->head.load(std::memory_order_acquire);
+        uint32_t tail = buffer->tail.load(std::memory_order_relaxed);
+        for (; tail != head; ++tail) {
+            m_batch.push_back(buffer->records[tail & kRingMask]);
+        }
+        buffer->tail.store(tail, std::memory_order_release);
+
+        uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+        if (dropped != buffer->droppedReported) {
+            Record note{};
+            note.timestampNs = steadyNowNs();
+            note.id = Msg_LogDropped;
+            note.argc = 2;
+            note.threadId = buffer->threadId;
+            note.args[0] = buffer->threadId;
+            note.args[1] = static_cast<int64_t>(dropped - buffer->droppedReported);
+            m_batch.push_back(note);
+            buffer->droppedReported = dropped;
+        }
+    }
+
+    void drainAll() {
+        m_batch.clear();
+        ThreadBuffer* pool = m_pool.load(std::memory_order_acquire);
+        for (int i = 0; pool && i < kMaxThreads; ++i) {
+            ThreadBuffer& buffer = pool[i];
+            uint32_t state = buffer.state.load(std::memory_order_acquire);
+            if (state == Buffer_Free) continue;
+            drainBuffer(&buffer);
+            if (state == Buffer_Orphaned) {
+                buffer.head.store(0, std::memory_order_relaxed);
+                buffer.tail.store(0, std::memory_order_relaxed);
+                buffer.dropped.store(0, std::memory_order_relaxed);
+                buffer.droppedReported = 0;
+                buffer.state.store(Buffer_Free, std::memory_order_release);
+            }
+        }
+
+        if (m_file && !m_batch.empty()) {
+            m_fileBytes += std::fwrite(m_batch.data(), sizeof(Record), m_batch.size(), m_file) * sizeof(Record);
+            std::fflush(m_file);
+        }
+    }
+
+    void flusherLoop() {
+        m_batch.reserve(kRingSize);
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        while (!m_stop) {
+            m_wake.wait_for(lock, std::chrono::milliseconds(m_config.flushIntervalMs));
+            if (m_stop) break;
+            lock.unlock();
+            drainAll();
+            rotateIfNeeded();
+            lock.lock();
+        }
+    }
+};
+
+// Never destroyed: producers on SDK threads may still log during process teardown.
+Logger& logger() {
+    static Logger* instance = new Logger();
+    return *instance;
+}
+
+struct ThreadSlot {
+    ThreadBuffer* buffer = nullptr;
+    ~ThreadSlot() {
+        if (buffer) buffer->state.store(Buffer_Orphaned, std::memory_order_release);
+    }
+};
+
+thread_local ThreadSlot t_slot;
+
+} // namespace
+
+bool start(const Config& config) {
+    return logger().start(config);
+}
+
+void stop() {
+    logger().stop();
+}
+
+bool enabled() {
+    return logger().running.load(std::memory_order_relaxed);
+}
+
+uint64_t droppedCount() {
+    return logger().totalDropped.load(std::memory_order_relaxed);
+}
+
+void write(MsgId id, int argc, const int64_t* args) {
+    ThreadBuffer* buffer = t_slot.buffer;
+    if (!buffer) {
+        buffer = logger().claimBuffer();
+        if (!buffer) {
+            logger().totalDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        t_slot.buffer = buffer;
+    }
+
+    uint32_t head = buffer->head.load(std::memory_order_relaxed);
+    uint32_t tail = buffer->tail.load(std::memory_order_acquire);
+    if (head - tail >= kRingSize) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        logger().totalDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Record& record = buffer->records[head & kRingMask];
+    record.timestampNs = steadyNowNs();
+    record.id = id;
+    record.argc = static_cast<uint16_t>(argc);
+    record.threadId = buffer->threadId;
+    for (int i = 0; i < argc; ++i) {
+        record.args[i] = args[i];
+    }
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+} // namespace blog
+} // namespace brainmirror
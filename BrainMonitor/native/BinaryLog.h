@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace brainmirror {
+namespace blog {
+
+// Message catalogue. The format strings live in BinaryLog.cpp and are written
+// into every log file header, so ids only need to stay stable within a file.
+// Append new messages at the end.
+enum MsgId : uint16_t {
+    Msg_LogDropped = 0,
+    Msg_RawData,
+    Msg_PostData,
+    Msg_BattInfo,
+    Msg_CmdResp,
+    Msg_Event,
+    Msg_CmdSend,
+    Msg_CmdTimeout,
+    Msg_LatencyAlarm,
+    Msg_Count
+};
+
+// Every argument is stored as a 64-bit integer; formats use %lld.
+constexpr int kMaxArgs = 6;
+
+// On-disk layout (little endian, written as-is):
+//   FileHeader
+//   FormatEntry + format text, FileHeader::formatCount times
+//   Record, until end of file
+#pragma pack(push, 1)
+struct FileHeader {
+    char magic[8];          // "BMBLOG1"
+    uint32_t version;
+    uint32_t formatCount;
+    int64_t wallClockNs;    // Unix time when the file was opened
+    int64_t steadyNs;       // Record clock at the same instant
+};
+
+struct FormatEntry {
+    uint16_t id;
+    uint16_t argc;
+    uint16_t length;        // Bytes of format text that follow
+};
+#pragma pack(pop)
+
+struct Record {
+    uint64_t timestampNs;   // steady_clock
+    uint16_t id;
+    uint16_t argc;
+    uint32_t threadId;      // Logger-assigned, stable for the life of the thread
+    int64_t args[kMaxArgs];
+};
+static_assert(sizeof(Record) == 64, "Record must stay one cache line");
+
+constexpr char kFileMagic[8] = { 'B', 'M', 'B', 'L', 'O', 'G', '1', '\0' };
+constexpr uint32_t kFileVersion = 1;
+
+struct Config {
+    std::filesystem::path directory;
+    std::string baseName = "brainmirror";
+    uint64_t maxFileBytes = 16ull * 1024 * 1024;
+    uint32_t maxFileSeconds = 3600;
+    uint32_t maxFiles = 8;          // Oldest files of this run are deleted beyond this
+    uint32_t flushIntervalMs = 200;
+};
+
+// Starts the background flusher. Returns false if the first file cannot be opened.
+bool start(const Config& config);
+void stop();
+bool enabled();
+
+// Total records discarded because a thread buffer was full.
+uint64_t droppedCount();
+
+// Non-blocking: copies one record into the calling thread's ring buffer.
+void write(MsgId id, int argc, const int64_t* args);
+
+template <typename... Args>
+inline void log(MsgId id, Args... args) {
+    static_assert(sizeof...(Args) <= kMaxArgs, "too many log arguments");
+    if (!enabled()) return;
+    const int64_t values[sizeof...(Args) + 1] = { static_cast<int64_t>(args)..., 0 };
+    write(id, static_cast<int>(sizeof...(Args)), values);
+}
+
+} // namespace blog
+} // namespace brainmirror
@@ -0,0 +1,159 @@
+#include "BrainwaveAnalysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace brainmirror {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+double clampPercent(double value) {
+    return std::max(0.0, std::min(100.0, value));
+}
+
+// Max of the relative spectrum between two band edges, using the same
+// frequency-to-index mapping as GetFrequencyBandPower in the C# processor.
+bool bandMaximum(const std::vector<double>& relative, double lowFreq, double highFreq, double& maximum) {
+    if (relative.empty()) return false;
+
+    int last = static_cast<int>(relative.size()) - 1;
+    int lowIndex = std::max(0, std::min(static_cast<int>(lowFreq / analysis::FrequencyResolution), last));
+    int highIndex = std::max(0, std::min(static_cast<int>(highFreq / analysis::FrequencyResolution), last));
+    if (lowIndex > highIndex) return false;
+
+    maximum = relative[lowIndex];
+    for (int i = lowIndex + 1; i <= highIndex; ++i) {
+        maximum = std::max(maximum, relative[i]);
+    }
+    return true;
+}
+
+} // namespace
+
+size_t nextPowerOfTwo(size_t n) {
+    size_t power = 1;
+    while (power < n) {
+        power *= 2;
+    }
+    return power;
+}
+
+void fftInPlace(std::complex<double>* data, size_t n) {
+    // Bit-reversal permutation
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) std::swap(data[i], data[j]);
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1) {
+        size_t half = len / 2;
+        for (size_t k = 0; k < half; ++k) {
+            double angle = -2.0 * kPi * static_cast<double>(k) / static_cast<double>(len);
+            std::complex<double> w(std::cos(angle), std::sin(angle));
+            for (size_t start = 0; start < n; start += len) {
+                std::complex<double> even = data[start + k];
+                std::complex<double> odd = w * data[start + k + half];
+                data[start + k] = even + odd;
+                data[start + k + half] = even - odd;
+            }
+        }
+    }
+}
+
+BrainwaveResult BrainwaveAnalyzer::processClosedEyesData(const double* data, size_t count) {
+    BrainwaveResult result;
+    result.sampleCount = count;
+
+    if (data == nullptr || count == 0) {
+        result.errorMessage = "input data is empty";
+        return result;
+    }
+
+    // 1. Outlier clipping, with basic quality statistics on the raw input
+    m_filtered.resize(count);
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double value = data[i];
+        sum += value;
+        sumSquares += value * value;
+        if (value > analysis::OutlierLimit) {
+            value = analysis::OutlierLimit;
+            result.clippedCount++;
+        }
+        else if (value < -analysis::OutlierLimit) {
+            value = -analysis::OutlierLimit;
+            result.clippedCount++;
+        }
+        m_filtered[i] = value;
+    }
+    result.meanValue = sum / static_cast<double>(count);
+    result.stdDeviation = std::sqrt(std::max(0.0, sumSquares / static_cast<double>(count) - result.meanValue * result.meanValue));
+
+    // 2. Biquad filter (same precomputed coefficients as the C# processor)
+    if (count >= 3) {
+        const double b0 = 0.0001, b1 = 0.0002, b2 = 0.0001;
+        const double a1 = -1.9978, a2 = 0.9978;
+        double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+        for (size_t i = 0; i < count; ++i) {
+            double sample = m_filtered[i];
+            double y = b0 * sample + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+            x2 = x1;
+            x1 = sample;
+            y2 = y1;
+            y1 = y;
+            m_filtered[i] = y;
+        }
+    }
+
+    // 3. Zero-pad to a power of two, Hanning window, FFT
+    size_t n = nextPowerOfTwo(count);
+    m_spectrum.assign(n, std::complex<double>(0.0, 0.0));
+    double denominator = n > 1 ? static_cast<double>(n - 1) : 1.0;
+    for (size_t i = 0; i < count; ++i) {
+        double window = 0.5 * (1.0 - std::cos(2.0 * kPi * static_cast<double>(i) / denominator));
+        m_spectrum[i] = std::complex<double>(m_filtered[i] * window, 0.0);
+    }
+    fftInPlace(m_spectrum.data(), n);
+
+    // 4. Relative power: P(f) / sum(P(3:30)) * 100
+    m_relative.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        m_relative[i] = std::norm(m_spectrum[i]);
+    }
+
+    double total3To30Hz = 0.0;
+    size_t startIndex = static_cast<size_t>(3.0 / analysis::FrequencyResolution);
+    size_t endIndex = static_cast<size_t>(30.0 / analysis::FrequencyResolution);
+    for (size_t i = startIndex; i <= endIndex && i < n; ++i) {
+        total3To30Hz += m_relative[i];
+    }
+    for (size_t i = 0; i < n; ++i) {
+        m_relative[i] = total3To30Hz > 0 ? (m_relative[i] / total3To30Hz) * 100.0 : 0.0;
+    }
+
+    // 5. Band indices
+    double thetaMax = 0.0, alphaMax = 0.0, betaMax = 0.0;
+    if (!bandMaximum(m_relative, analysis::ThetaLowFreq, analysis::ThetaHighFreq, thetaMax) ||
+        !bandMaximum(m_relative, analysis::AlphaLowFreq, analysis::AlphaHighFreq, alphaMax) ||
+        !bandMaximum(m_relative, analysis::BetaLowFreq, analysis::BetaHighFreq, betaMax)) {
+        result.errorMessage = "frequency band is empty";
+        return result;
+    }
+
+    result.thetaValue = clampPercent((thetaMax - 2.0) * 100.0);
+    result.alphaValue = clampPercent(100.0 - (alphaMax + 0.3) * 100.0);
+    result.betaValue = clampPercent(100.0 - (betaMax + 0.5) * 100.0);
+    result.brainwaveFinalIndex = (result.thetaValue + result.alphaValue + result.betaValue) / 3.0;
+    result.success = true;
+    return result;
+}
+
+} // namespace brainmirror
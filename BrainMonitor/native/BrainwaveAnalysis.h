@@ -0,0 +1,68 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace brainmirror {
+
+// Native port of Services/BrainwaveDataProcessor.cs. Constants, band edges and
+// index arithmetic are kept identical so scores match the WPF client.
+namespace analysis {
+
+constexpr double SamplingRate = 520.0;
+constexpr double FrequencyResolution = 0.1;
+constexpr double OutlierLimit = 100.0;
+
+constexpr double ThetaLowFreq = 4.0;
+constexpr double ThetaHighFreq = 7.0;
+constexpr double AlphaLowFreq = 8.0;
+constexpr double AlphaHighFreq = 13.0;
+constexpr double BetaLowFreq = 15.0;
+constexpr double BetaHighFreq = 25.0;
+
+// Bumped whenever a change alters scores for the same input.
+constexpr int PipelineVersion = 1;
+
+} // namespace analysis
+
+struct BrainwaveResult {
+    bool success = false;
+    std::string errorMessage;
+
+    double thetaValue = 0.0;
+    double alphaValue = 0.0;
+    double betaValue = 0.0;
+    double brainwaveFinalIndex = 0.0;
+
+    // Input quality
+    size_t sampleCount = 0;
+    size_t clippedCount = 0;    // Samples outside +/-OutlierLimit
+    double meanValue = 0.0;
+    double stdDeviation = 0.0;
+};
+
+// Reusable analyzer: internal buffers grow to the largest input seen and are
+// kept, so one instance per worker thread avoids per-recording allocation.
+class BrainwaveAnalyzer {
+public:
+    BrainwaveResult processClosedEyesData(const double* data, size_t count);
+    BrainwaveResult processClosedEyesData(const std::vector<double>& data) {
+        return processClosedEyesData(data.data(), data.size());
+    }
+
+    // Valid after a successful call, sized to the padded FFT length.
+    const std::vector<double>& relativePowerSpectrum() const { return m_relative; }
+
+private:
+    std::vector<double> m_filtered;
+    std::vector<std::complex<double>> m_spectrum;
+    std::vector<double> m_relative;
+};
+
+// In-place iterative radix-2 FFT; size must be a power of two.
+void fftInPlace(std::complex<double>* data, size_t n);
+size_t nextPowerOfTwo(size_t n);
+
+} // namespace brainmirror
@@ -0,0 +1,72 @@
+#include "ChunkCodec.h"
+
+#include <cstring>
+
+namespace brainmirror {
+
+void encodeChunk(uint16_t stream, uint64_t firstSample, const int* samples, size_t count, std::vector<uint8_t>& out) {
+    const size_t headerAt = out.size();
+    out.resize(headerAt + sizeof(ChunkHeader));
+
+    int64_t previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int64_t delta = static_cast<int64_t>(samples[i]) - previous;
+        previous = samples[i];
+        uint64_t zigzag = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+        do {
+            uint8_t byte = static_cast<uint8_t>(zigzag & 0x7F);
+            zigzag >>= 7;
+            out.push_back(zigzag ? static_cast<uint8_t>(byte | 0x80) : byte);
+        } while (zigzag);
+    }
+
+    ChunkHeader header{};
+    std::memcpy(header.magic, "BMCK", 4);
+    header.version = ChunkVersion;
+    header.stream = stream;
+    header.firstSample = firstSample;
+    header.sampleCount = static_cast<uint32_t>(count);
+    header.payloadBytes = static_cast<uint32_t>(out.size() - headerAt - sizeof(ChunkHeader));
+    std::memcpy(out.data() + headerAt, &header, sizeof(header));
+}
+
+bool decodeChunk(const uint8_t* data, size_t size, ChunkHeader& header, std::vector<int>& samples) {
+    if (!data || size < sizeof(ChunkHeader)) return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, "BMCK", 4) != 0 || header.version != ChunkVersion ||
+        header.payloadBytes != size - sizeof(ChunkHeader)) {
+        return false;
+    }
+
+    samples.clear();
+    samples.reserve(header.sampleCount);
+    const uint8_t* p = data + sizeof(ChunkHeader);
+    const uint8_t* end = data + size;
+    int64_t previous = 0;
+    while (p < end) {
+        uint64_t zigzag = 0;
+        int shift = 0;
+        for (;;) {
+            if (p >= end || shift > 63) return false;
+            uint8_t byte = *p++;
+            zigzag |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+            shift += 7;
+        }
+        int64_t delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        previous += delta;
+        samples.push_back(static_cast<int>(previous));
+    }
+    return samples.size() == header.sampleCount;
+}
+
+uint64_t fnv1a64(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+} // namespace brainmirror
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compressed sample chunks for the resumable uploader (ChunkUploader) and the
+// server's chunk-assembly endpoint (server/services/chunkUploadService.js).
+//
+// Chunk layout (little endian):
+//   ChunkHeader                         24 bytes
+//   payload                             payloadBytes
+//
+// The payload holds sampleCount values as zigzag LEB128 varints of the
+// difference to the previous sample (the first one relative to 0), so every
+// chunk decodes on its own. EEG deltas mostly fit one or two bytes, against
+// 5-8 bytes per sample for the CSV text. The whole chunk is identified by its
+// FNV-1a 64-bit hash.
+namespace brainmirror {
+
+#pragma pack(push, 1)
+struct ChunkHeader {
+    char magic[4];              // "BMCK"
+    uint16_t version;
+    uint16_t stream;            // Channel index within the upload
+    uint64_t firstSample;       // Offset of the first sample in the stream
+    uint32_t sampleCount;
+    uint32_t payloadBytes;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(ChunkHeader) == 24, "chunk header layout");
+
+constexpr uint16_t ChunkVersion = 1;
+
+// Appends a complete chunk (header + payload) to `out`.
+void encodeChunk(uint16_t stream, uint64_t firstSample, const int* samples, size_t count, std::vector<uint8_t>& out);
+
+// Decodes a chunk produced by encodeChunk. Returns false on a malformed chunk.
+bool decodeChunk(const uint8_t* data, size_t size, ChunkHeader& header, std::vector<int>& samples);
+
+uint64_t fnv1a64(const uint8_t* data, size_t size);
+
+} // namespace brainmirror
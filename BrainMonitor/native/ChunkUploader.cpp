@@ -0,0 +1,307 @@
+#include "ChunkUploader.h"
+#include "ChunkCodec.h"
+#include "HttpClient.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+namespace brainmirror {
+
+namespace {
+
+struct PendingChunk {
+    int stream;
+    uint64_t firstSample;
+    size_t samples;
+    std::vector<uint8_t> bytes;
+    std::string hash;
+};
+
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        }
+        else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        }
+        else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out + "\"";
+}
+
+// Integers of the array value of `key` in a flat JSON response.
+bool jsonIntegers(const std::string& body, const char* key, std::vector<uint64_t>& values) {
+    std::string pattern = std::string("\"") + key + "\":[";
+    size_t pos = body.find(pattern);
+    if (pos == std::string::npos) return false;
+    pos += pattern.size();
+    values.clear();
+    while (pos < body.size() && body[pos] != ']') {
+        char* end = nullptr;
+        values.push_back(std::strtoull(body.c_str() + pos, &end, 10));
+        pos = static_cast<size_t>(end - body.c_str());
+        if (pos < body.size() && body[pos] == ',') pos++;
+        else break;
+    }
+    return true;
+}
+
+int jsonInteger(const std::string& body, const char* key) {
+    std::string pattern = std::string("\"") + key + "\":";
+    size_t pos = body.find(pattern);
+    return pos == std::string::npos ? 0 : std::atoi(body.c_str() + pos + pattern.size());
+}
+
+bool retryable(int status) {
+    return status == 0 || status == 408 || status == 429 || status >= 500;
+}
+
+} // namespace
+
+ChunkUploader::ChunkUploader(UploadConfig config, SampleSource source)
+    : m_config(std::move(config)), m_source(std::move(source)) {
+    m_config.streams = std::max(1, m_config.streams);
+    m_config.chunkSamples = std::max<size_t>(1, m_config.chunkSamples);
+    m_config.queueChunks = std::max<size_t>(1, m_config.queueChunks);
+}
+
+ChunkUploader::~ChunkUploader() {
+    cancel();
+}
+
+bool ChunkUploader::start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_thread.joinable() || m_config.uploadId.size() < 16 || m_config.uploadId.size() > 64 ||
+        m_config.uploadId.find_first_not_of("0123456789abcdef") != std::string::npos) {
+        return false;
+    }
+    m_stats.state = UploadState::Starting;
+    m_thread = std::thread(&ChunkUploader::run, this);
+    return true;
+}
+
+void ChunkUploader::finish() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_finishing = true;
+    if (m_stats.state == UploadState::Streaming) m_stats.state = UploadState::Finishing;
+    m_wake.notify_all();
+}
+
+bool ChunkUploader::wait(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto finished = [this]() {
+        return m_stats.state == UploadState::Completed || m_stats.state == UploadState::Failed ||
+            m_stats.state == UploadState::Cancelled || m_stats.state == UploadState::Idle;
+    };
+    m_done.wait_for(lock, std::chrono::milliseconds(std::max(0, timeoutMs)), finished);
+    return m_stats.state == UploadState::Completed;
+}
+
+void ChunkUploader::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancelled = true;
+        m_wake.notify_all();
+    }
+    if (m_thread.joinable()) m_thread.join();
+}
+
+UploadStats ChunkUploader::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void ChunkUploader::setState(UploadState state) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.state = state;
+    m_done.notify_all();
+}
+
+bool ChunkUploader::pause(int ms) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_wake.wait_for(lock, std::chrono::milliseconds(ms), [this]() { return m_cancelled; });
+    return !m_cancelled;
+}
+
+void ChunkUploader::run() {
+    HttpClient http(m_config.host, m_config.port, m_config.timeoutMs);
+    const std::string base = m_config.basePath + "/chunked/" + m_config.uploadId;
+    const std::vector<std::pair<std::string, std::string>> jsonHeaders = {
+        { "Authorization", "Bearer " + m_config.token },
+        { "Content-Type", "application/json" },
+    };
+
+    const size_t streams = static_cast<size_t>(m_config.streams);
+    std::vector<uint64_t> encoded(streams, 0), acked(streams, 0);
+    std::deque<PendingChunk> queue;
+    bool started = false;
+    int backoffMs = 500;
+
+    // Server offsets win: drop queued chunks and continue from there
+    auto resync = [&](const std::string& body) {
+        std::vector<uint64_t> received;
+        if (!jsonIntegers(body, "received", received)) return false;
+        queue.clear();
+        for (size_t s = 0; s < streams; ++s) {
+            acked[s] = encoded[s] = s < received.size() ? received[s] : 0;
+        }
+        return true;
+    };
+
+    // Returns false when the upload cannot continue
+    auto handleFailure = [&](int status) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.lastHttpStatus = status;
+            m_stats.retries++;
+        }
+        if (!retryable(status)) {
+            setState(UploadState::Failed);
+            return false;
+        }
+        if (!pause(backoffMs)) return false;
+        backoffMs = std::min(backoffMs * 2, 10000);
+        return true;
+    };
+
+    auto updateStats = [&](uint64_t recorded) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint64_t total = 0;
+        for (uint64_t a : acked) total += a;
+        m_stats.samplesAcked = total;
+        m_stats.samplesRecorded = recorded;
+        m_stats.queuedChunks = static_cast<int>(queue.size());
+    };
+
+    for (;;) {
+        bool finishing;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_cancelled) break;
+            finishing = m_finishing;
+        }
+
+        if (!started) {
+            std::string body = "{\"dataType\":" + jsonString(m_config.dataType) +
+                ",\"institutionId\":" + jsonString(m_config.institutionId) +
+                ",\"staffName\":" + jsonString(m_config.staffName) +
+                ",\"testerName\":" + jsonString(m_config.testerName) +
+                ",\"sampleRate\":" + std::to_string(m_config.sampleRate) +
+                ",\"streams\":" + std::to_string(m_config.streams) + "}";
+            HttpResponse response = http.request("POST", base + "/start", jsonHeaders, body.data(), body.size());
+            if (response.status == 200 && resync(response.body)) {
+                started = true;
+                backoffMs = 500;
+                setState(finishing ? UploadState::Finishing : UploadState::Streaming);
+                continue;
+            }
+            if (!handleFailure(response.status)) break;
+            continue;
+        }
+
+        // Encode what is ready, up to the queue bound; the recorder keeps
+        // the rest, so a full queue only delays encoding
+        uint64_t recorded = 0;
+        bool allEncoded = true;
+        for (size_t s = 0; s < streams; ++s) {
+            const int* data = nullptr;
+            size_t count = 0;
+            if (!m_source(static_cast<int>(s), &data, &count)) count = 0;
+            recorded += count;
+            while (queue.size() < m_config.queueChunks && encoded[s] < count) {
+                size_t remaining = static_cast<size_t>(count - encoded[s]);
+                if (remaining < m_config.chunkSamples && !finishing) break;
+                size_t n = std::min(remaining, m_config.chunkSamples);
+
+                PendingChunk chunk;
+                chunk.stream = static_cast<int>(s);
+                chunk.firstSample = encoded[s];
+                chunk.samples = n;
+                encodeChunk(static_cast<uint16_t>(s), encoded[s], data + encoded[s], n, chunk.bytes);
+                char hash[17];
+                std::snprintf(hash, sizeof(hash), "%016" PRIx64, fnv1a64(chunk.bytes.data(), chunk.bytes.size()));
+                chunk.hash = hash;
+                queue.push_back(std::move(chunk));
+                encoded[s] += n;
+            }
+            if (encoded[s] < count) allEncoded = false;
+        }
+        updateStats(recorded);
+
+        if (!queue.empty()) {
+            const PendingChunk& chunk = queue.front();
+            std::vector<std::pair<std::string, std::string>> headers = {
+                { "Authorization", "Bearer " + m_config.token },
+                { "Content-Type", "application/octet-stream" },
+                { "X-Chunk-Hash", chunk.hash },
+            };
+            HttpResponse response = http.request("PUT", base + "/chunks", headers, chunk.bytes.data(), chunk.bytes.size());
+            if (response.status == 200) {
+                std::vector<uint64_t> received;
+                size_t s = static_cast<size_t>(chunk.stream);
+                acked[s] = jsonIntegers(response.body, "received", received) && s < received.size()
+                    ? received[s] : chunk.firstSample + chunk.samples;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stats.lastHttpStatus = 200;
+                    m_stats.chunksSent++;
+                    m_stats.bytesSent += chunk.bytes.size();
+                }
+                queue.pop_front();
+                backoffMs = 500;
+            }
+            else if (response.status == 409 && resync(response.body)) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stats.lastHttpStatus = 409;
+            }
+            else if (!handleFailure(response.status)) {
+                break;
+            }
+            continue;
+        }
+
+        if (finishing && allEncoded) {
+            std::string body = "{\"samples\":[";
+            for (size_t s = 0; s < streams; ++s) {
+                body += (s ? "," : "") + std::to_string(acked[s]);
+            }
+            body += "]}";
+            HttpResponse response = http.request("POST", base + "/complete", jsonHeaders, body.data(), body.size());
+            if (response.status == 200) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stats.lastHttpStatus = 200;
+                    m_stats.testResultId = jsonInteger(response.body, "testResultId");
+                }
+                setState(UploadState::Completed);
+                return;
+            }
+            if (response.status == 409 && resync(response.body)) continue;
+            if (!handleFailure(response.status)) break;
+            continue;
+        }
+
+        // Wait for more samples, finish() or cancel()
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait_for(lock, std::chrono::milliseconds(m_config.pollMs),
+            [this, finishing]() { return m_cancelled || m_finishing != finishing; });
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stats.state != UploadState::Failed) m_stats.state = UploadState::Cancelled;
+    m_done.notify_all();
+}
+
+} // namespace brainmirror
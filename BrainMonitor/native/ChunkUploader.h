@@ -0,0 +1,92 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Resumable upload of a recording while it is being recorded. A background
+// thread cuts each stream into compressed chunks (ChunkCodec.h) as samples
+// arrive, keeps at most `queueChunks` encoded chunks in memory, and PUTs them
+// to the server's chunk endpoint (server/routes/brainwave-data.js,
+// /chunked/...). The server reports the committed sample offset per stream;
+// after a network error or restart with the same uploadId the upload
+// continues from there instead of starting over. finish() sends the tail and
+// asks the server to assemble the CSV, which then goes through the same
+// analysis and database path as a regular upload.
+namespace brainmirror {
+
+struct UploadConfig {
+    std::string host = "127.0.0.1";
+    uint16_t port = 3000;
+    std::string basePath = "/api/brainwave-data";
+    std::string token;              // JWT sent as a Bearer token
+    std::string uploadId;           // 16-64 lower-case hex digits; same id resumes
+    std::string dataType;           // UTF-8, e.g. the closed-eyes label
+    std::string institutionId;
+    std::string staffName;
+    std::string testerName;
+    int sampleRate = 520;
+    int streams = 1;                // Channels, written as CSV columns
+    size_t chunkSamples = 5200;
+    size_t queueChunks = 32;
+    int pollMs = 200;
+    int timeoutMs = 15000;
+};
+
+// Samples recorded so far for a stream. The pointer must stay valid while the
+// uploader runs; returning false counts as no samples yet.
+using SampleSource = std::function<bool(int stream, const int** data, size_t* count)>;
+
+enum class UploadState { Idle, Starting, Streaming, Finishing, Completed, Failed, Cancelled };
+
+struct UploadStats {
+    UploadState state = UploadState::Idle;
+    int lastHttpStatus = 0;
+    int testResultId = 0;
+    uint32_t retries = 0;
+    uint64_t chunksSent = 0;
+    uint64_t bytesSent = 0;         // Chunk bytes acknowledged by the server
+    uint64_t samplesAcked = 0;      // All streams
+    uint64_t samplesRecorded = 0;   // All streams, as of the last poll
+    int queuedChunks = 0;
+};
+
+class ChunkUploader {
+public:
+    ChunkUploader(UploadConfig config, SampleSource source);
+    ~ChunkUploader();
+    ChunkUploader(const ChunkUploader&) = delete;
+    ChunkUploader& operator=(const ChunkUploader&) = delete;
+
+    bool start();
+    // Upload everything recorded so far (no more samples are expected), then
+    // complete the upload on the server.
+    void finish();
+    // Waits until the upload completed, failed or was cancelled.
+    bool wait(int timeoutMs);
+    void cancel();
+
+    UploadStats stats() const;
+
+private:
+    UploadConfig m_config;
+    SampleSource m_source;
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    bool m_finishing = false;
+    bool m_cancelled = false;
+    UploadStats m_stats;
+
+    void run();
+    void setState(UploadState state);
+    // Sleeps for `ms` unless cancelled; returns false when cancelled.
+    bool pause(int ms);
+};
+
+} // namespace brainmirror
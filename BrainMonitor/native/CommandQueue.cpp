@@ -0,0 +1,311 @@
+#include "CommandQueue.h"
+#include "BinaryLog.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace brainmirror {
+
+// Request ids carry the slot index in their low byte
+static_assert(CommandQueue::MaxPending == 256, "request id layout assumes 256 slots");
+
+CommandQueue::CommandQueue(SendFunction send)
+    : m_send(send) {}
+
+CommandQueue::~CommandQueue() {
+    stop();
+}
+
+void CommandQueue::start(const Options& options) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_options = options;
+    m_options.windowPerDevice = std::max(1, std::min(options.windowPerDevice, MaxWindow));
+    if (m_running) return;
+    m_running = true;
+    m_thread = std::thread(&CommandQueue::run, this);
+}
+
+void CommandQueue::setOptions(const Options& options) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_options = options;
+    m_options.windowPerDevice = std::max(1, std::min(options.windowPerDevice, MaxWindow));
+    m_wake.notify_one();
+}
+
+void CommandQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) return;
+        m_running = false;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable()) m_thread.join();
+
+    for (int dev = 0; dev < MaxDevices; ++dev) {
+        cancelDevice(dev);
+    }
+}
+
+int CommandQueue::allocateSlot() {
+    for (int i = 0; i < MaxPending; ++i) {
+        int index = (m_cursor + i) % MaxPending;
+        SlotState state = m_slots[index].state;
+        if (state == SlotState::Free || state == SlotState::Done) {
+            m_cursor = (index + 1) % MaxPending;
+            return index;
+        }
+    }
+    return -1;
+}
+
+uint32_t CommandQueue::submit(int dev, uint8_t cmd, const uint8_t* payload, uint8_t len,
+                              Completion completion, void* user) {
+    if (dev < 0 || dev >= MaxDevices || len > MaxCommandPayload || (len > 0 && !payload)) return 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_running) return 0;
+    int index = allocateSlot();
+    if (index < 0) return 0;
+
+    Slot& slot = m_slots[index];
+    if (++m_generation > 0x00FFFFFFu) m_generation = 1;
+    slot.id = (m_generation << 8) | static_cast<uint32_t>(index);
+    slot.state = SlotState::Queued;
+    slot.dev = dev;
+    slot.cmd = cmd;
+    if (len > 0) std::memcpy(slot.payload, payload, len);
+    slot.length = len;
+    slot.attempts = 0;
+    slot.lastSendFailed = false;
+    slot.next = -1;
+    slot.completion = completion;
+    slot.user = user;
+    slot.result = CommandResult();
+
+    DeviceQueue& device = m_devices[dev];
+    if (device.tail >= 0) m_slots[device.tail].next = index;
+    else device.head = index;
+    device.tail = index;
+
+    m_wake.notify_one();
+    return slot.id;
+}
+
+bool CommandQueue::wait(uint32_t id, int timeoutMs, CommandResult& result) {
+    if (id == 0) return false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    Slot& slot = m_slots[id & 0xFF];
+    auto finished = [&]() { return slot.id != id || slot.state == SlotState::Done; };
+    if (timeoutMs < 0) {
+        m_done.wait(lock, finished);
+    }
+    else if (!m_done.wait_for(lock, std::chrono::milliseconds(timeoutMs), finished)) {
+        return false;
+    }
+
+    if (slot.id != id) return false;    // Slot reused, result no longer available
+    result = slot.result;
+    return true;
+}
+
+void CommandQueue::removeInFlight(DeviceQueue& device, int position) {
+    for (int i = position + 1; i < device.inFlightCount; ++i) {
+        device.inFlight[i - 1] = device.inFlight[i];
+    }
+    device.inFlightCount--;
+}
+
+CommandQueue::Finished CommandQueue::finish(int index, CommandStatus status, const uint8_t* payload, int len) {
+    Slot& slot = m_slots[index];
+    slot.state = SlotState::Done;
+    slot.result.status = status;
+    slot.result.attempts = slot.attempts;
+    slot.result.length = std::max(0, std::min(len, MaxCommandPayload));
+    if (payload && slot.result.length > 0) {
+        std::memcpy(slot.result.payload, payload, slot.result.length);
+    }
+    if (slot.attempts > 0) {
+        slot.result.latencyUs = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - slot.firstSent).count());
+    }
+    return { slot.completion, slot.user, slot.id, slot.dev, slot.cmd, slot.result };
+}
+
+void CommandQueue::notify(const Finished* finished, int count) {
+    if (count == 0) return;
+    m_done.notify_all();
+    for (int i = 0; i < count; ++i) {
+        if (finished[i].completion) {
+            finished[i].completion(finished[i].user, finished[i].id, finished[i].dev, finished[i].cmd, finished[i].result);
+        }
+    }
+}
+
+void CommandQueue::onResponse(int dev, uint8_t cmd, const uint8_t* payload, int len) {
+    if (dev < 0 || dev >= MaxDevices) return;
+
+    Finished finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        DeviceQueue& device = m_devices[dev];
+        int position = -1;
+        for (int i = 0; i < device.inFlightCount; ++i) {
+            if (m_slots[device.inFlight[i]].cmd == cmd) {
+                position = i;
+                break;
+            }
+        }
+        if (position < 0) return;       // Response to a synchronous SDK_SendCommand
+
+        int index = device.inFlight[position];
+        removeInFlight(device, position);
+        finished = finish(index, CommandStatus::Ok, payload, len);
+    }
+    m_wake.notify_one();                // Window space freed
+    notify(&finished, 1);
+}
+
+void CommandQueue::cancelDevice(int dev) {
+    if (dev < 0 || dev >= MaxDevices) return;
+
+    Finished finished[MaxPending];
+    int count = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        DeviceQueue& device = m_devices[dev];
+        for (int i = 0; i < device.inFlightCount; ++i) {
+            finished[count++] = finish(device.inFlight[i], CommandStatus::Cancelled, nullptr, 0);
+        }
+        device.inFlightCount = 0;
+        for (int index = device.head; index >= 0; index = m_slots[index].next) {
+            finished[count++] = finish(index, CommandStatus::Cancelled, nullptr, 0);
+        }
+        device.head = device.tail = -1;
+    }
+    notify(finished, count);
+}
+
+bool CommandQueue::cancel(uint32_t id) {
+    if (id == 0) return false;
+
+    Finished finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        int index = static_cast<int>(id & 0xFF);
+        Slot& slot = m_slots[index];
+        if (slot.id != id || (slot.state != SlotState::Queued && slot.state != SlotState::InFlight)) return false;
+
+        DeviceQueue& device = m_devices[slot.dev];
+        if (slot.state == SlotState::InFlight) {
+            for (int i = 0; i < device.inFlightCount; ++i) {
+                if (device.inFlight[i] == index) {
+                    removeInFlight(device, i);
+                    break;
+                }
+            }
+        }
+        else {
+            int previous = -1;
+            for (int at = device.head; at >= 0 && at != index; at = m_slots[at].next) previous = at;
+            if (previous >= 0) m_slots[previous].next = slot.next;
+            else device.head = slot.next;
+            if (device.tail == index) device.tail = previous;
+        }
+        finished = finish(index, CommandStatus::Cancelled, nullptr, 0);
+    }
+    m_wake.notify_one();                // Window space freed
+    notify(&finished, 1);
+    return true;
+}
+
+void CommandQueue::run() {
+    struct Send {
+        int slot;
+        uint32_t id;
+        int dev;
+        uint8_t cmd;
+        uint8_t payload[MaxCommandPayload];
+        uint8_t length;
+        int attempt;
+    };
+    Send sends[MaxPending];
+    Finished finished[MaxPending];
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_running) {
+        int sendCount = 0;
+        int finishedCount = 0;
+        auto now = Clock::now();
+        auto nextDeadline = Clock::time_point::max();
+        const auto timeout = std::chrono::milliseconds(std::max(1, m_options.timeoutMs));
+
+        for (int dev = 0; dev < MaxDevices; ++dev) {
+            DeviceQueue& device = m_devices[dev];
+
+            // Expired requests: resend or give up
+            for (int i = 0; i < device.inFlightCount;) {
+                Slot& slot = m_slots[device.inFlight[i]];
+                if (slot.deadline > now) {
+                    nextDeadline = std::min(nextDeadline, slot.deadline);
+                    ++i;
+                    continue;
+                }
+                if (slot.attempts <= m_options.retries) {
+                    slot.attempts++;
+                    slot.deadline = now + timeout;
+                    nextDeadline = std::min(nextDeadline, slot.deadline);
+                    Send& send = sends[sendCount++];
+                    send = { device.inFlight[i], slot.id, slot.dev, slot.cmd, {}, slot.length, slot.attempts };
+                    std::memcpy(send.payload, slot.payload, slot.length);
+                    ++i;
+                    continue;
+                }
+                blog::log(blog::Msg_CmdTimeout, slot.dev, slot.cmd, slot.attempts);
+                int index = device.inFlight[i];
+                removeInFlight(device, i);
+                finished[finishedCount++] = finish(index,
+                    slot.lastSendFailed ? CommandStatus::SendFailed : CommandStatus::Timeout, nullptr, 0);
+            }
+
+            // Fill the window from the queue
+            while (device.head >= 0 && device.inFlightCount < m_options.windowPerDevice) {
+                int index = device.head;
+                Slot& slot = m_slots[index];
+                device.head = slot.next;
+                if (device.head < 0) device.tail = -1;
+
+                slot.state = SlotState::InFlight;
+                slot.attempts = 1;
+                slot.firstSent = now;
+                slot.deadline = now + timeout;
+                nextDeadline = std::min(nextDeadline, slot.deadline);
+                device.inFlight[device.inFlightCount++] = index;
+
+                Send& send = sends[sendCount++];
+                send = { index, slot.id, slot.dev, slot.cmd, {}, slot.length, slot.attempts };
+                std::memcpy(send.payload, slot.payload, slot.length);
+            }
+        }
+
+        if (sendCount == 0 && finishedCount == 0) {
+            if (nextDeadline == Clock::time_point::max()) m_wake.wait(lock);
+            else m_wake.wait_until(lock, nextDeadline);
+            continue;
+        }
+
+        lock.unlock();
+        for (int i = 0; i < sendCount; ++i) {
+            Send& send = sends[i];
+            blog::log(blog::Msg_CmdSend, send.dev, send.cmd, send.attempt);
+            bool sent = m_send(send.dev, send.cmd, send.length > 0 ? send.payload : nullptr, send.length);
+            std::lock_guard<std::mutex> relock(m_mutex);
+            Slot& slot = m_slots[send.slot];
+            if (slot.id == send.id) slot.lastSendFailed = !sent;
+        }
+        notify(finished, finishedCount);
+        lock.lock();
+    }
+}
+
+} // namespace brainmirror
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Asynchronous device command queue. Commands are queued per device and sent
+// by one dispatcher thread, up to `windowPerDevice` in flight per device, so
+// every connected headset is configured in parallel. Responses from the
+// vendor commandRespCB are matched to the oldest in-flight request with the
+// same (device, command); unanswered requests are resent after `timeoutMs`
+// up to `retries` times. All bookkeeping uses fixed-size slot arrays.
+namespace brainmirror {
+
+enum class CommandStatus : int {
+    Pending = -1,
+    Ok = 0,             // Response received
+    Timeout = 1,        // No response after all retries
+    SendFailed = 2,     // brainpro_command refused the last attempt
+    Cancelled = 3,      // Device disconnected or SDK cleaned up
+    Rejected = 4,       // Queue full, stopped, or bad arguments
+};
+
+constexpr int MaxCommandPayload = 32;
+
+struct CommandResult {
+    CommandStatus status = CommandStatus::Pending;
+    uint8_t payload[MaxCommandPayload] = {};
+    int length = 0;
+    int attempts = 0;
+    uint32_t latencyUs = 0;     // First send to response/failure
+};
+
+class CommandQueue {
+public:
+    static constexpr int MaxDevices = 16;
+    static constexpr int MaxPending = 256;
+    static constexpr int MaxWindow = 16;
+
+    using SendFunction = bool (*)(int dev, uint8_t cmd, uint8_t* payload, uint8_t len);
+    using Completion = void (*)(void* user, uint32_t id, int dev, uint8_t cmd, const CommandResult& result);
+
+    struct Options {
+        int timeoutMs = 300;
+        int retries = 2;
+        int windowPerDevice = 8;
+    };
+
+    explicit CommandQueue(SendFunction send);
+    ~CommandQueue();
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    void start(const Options& options);
+    // Cancels everything still queued or in flight.
+    void stop();
+    void setOptions(const Options& options);
+
+    // Returns the request id, 0 when rejected. `completion` runs on the
+    // dispatcher or response thread once the request finishes.
+    uint32_t submit(int dev, uint8_t cmd, const uint8_t* payload, uint8_t len,
+                    Completion completion = nullptr, void* user = nullptr);
+
+    // Blocks until the request finishes or timeoutMs (<0: forever) passes.
+    // Results stay available until the slot is reused for a newer request.
+    bool wait(uint32_t id, int timeoutMs, CommandResult& result);
+
+    // commandRespCB
+    void onResponse(int dev, uint8_t cmd, const uint8_t* payload, int len);
+    // Finishes a queued or in-flight request as Cancelled so it is not sent
+    // again; false when it already finished.
+    bool cancel(uint32_t id);
+    void cancelDevice(int dev);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum class SlotState : uint8_t { Free, Queued, InFlight, Done };
+
+    struct Slot {
+        uint32_t id = 0;
+        SlotState state = SlotState::Free;
+        int dev = 0;
+        uint8_t cmd = 0;
+        uint8_t payload[MaxCommandPayload] = {};
+        uint8_t length = 0;
+        int attempts = 0;
+        bool lastSendFailed = false;
+        Clock::time_point firstSent;
+        Clock::time_point deadline;
+        int next = -1;                  // Per-device queue link
+        Completion completion = nullptr;
+        void* user = nullptr;
+        CommandResult result;
+    };
+
+    struct DeviceQueue {
+        int head = -1;
+        int tail = -1;
+        int inFlight[MaxWindow] = {};   // Slot indices in send order
+        int inFlightCount = 0;
+    };
+
+    struct Finished {
+        Completion completion;
+        void* user;
+        uint32_t id;
+        int dev;
+        uint8_t cmd;
+        CommandResult result;
+    };
+
+    SendFunction m_send;
+    Options m_options;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;     // Dispatcher
+    std::condition_variable m_done;     // wait()
+    std::thread m_thread;
+    bool m_running = false;
+
+    Slot m_slots[MaxPending];
+    DeviceQueue m_devices[MaxDevices];
+    int m_cursor = 0;
+    uint32_t m_generation = 0;
+
+    void run();
+    int allocateSlot();
+    void removeInFlight(DeviceQueue& device, int position);
+    // Caller holds m_mutex; the completion callback is returned to run unlocked.
+    Finished finish(int slot, CommandStatus status, const uint8_t* payload, int len);
+    void notify(const Finished* finished, int count);
+};
+
+} // namespace brainmirror
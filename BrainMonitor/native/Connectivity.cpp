@@ -0,0 +1,197 @@
+#include "Connectivity.h"
+#include "BrainwaveAnalysis.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BRAINMIRROR_SSE2 1
+#endif
+
+namespace brainmirror {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr size_t kLanes = 2;    // doubles per SSE2 register
+
+// acc += a * conj(b) over n bins (n is a multiple of kLanes)
+void crossAccumulate(const double* ar, const double* ai, const double* br, const double* bi,
+                     double* accRe, double* accIm, size_t n) {
+#if defined(BRAINMIRROR_SSE2)
+    for (size_t k = 0; k < n; k += kLanes) {
+        __m128d xr = _mm_loadu_pd(ar + k), xi = _mm_loadu_pd(ai + k);
+        __m128d yr = _mm_loadu_pd(br + k), yi = _mm_loadu_pd(bi + k);
+        __m128d re = _mm_add_pd(_mm_mul_pd(xr, yr), _mm_mul_pd(xi, yi));
+        __m128d im = _mm_sub_pd(_mm_mul_pd(xi, yr), _mm_mul_pd(xr, yi));
+        _mm_storeu_pd(accRe + k, _mm_add_pd(_mm_loadu_pd(accRe + k), re));
+        _mm_storeu_pd(accIm + k, _mm_add_pd(_mm_loadu_pd(accIm + k), im));
+    }
+#else
+    for (size_t k = 0; k < n; ++k) {
+        accRe[k] += ar[k] * br[k] + ai[k] * bi[k];
+        accIm[k] += ai[k] * br[k] - ar[k] * bi[k];
+    }
+#endif
+}
+
+} // namespace
+
+bool ConnectivityEngine::compute(const double* const* channels, size_t channelCount, size_t length, double sampleRate,
+                                 const ConnectivityOptions& options, ConnectivityResult& result, std::string& error) {
+    const size_t n = options.segmentSize;
+    if (n < 16 || (n & (n - 1)) != 0 || options.hopSize == 0) {
+        error = "Segment size must be a power of two";
+        return false;
+    }
+    if (channelCount < 2 || !channels || sampleRate <= 0) {
+        error = "At least two channels are required";
+        return false;
+    }
+    if (length < n) {
+        error = "Not enough samples for one analysis segment";
+        return false;
+    }
+    if (options.bands.empty()) {
+        error = "No frequency bands";
+        return false;
+    }
+
+    // Bins covering every band
+    const double resolution = sampleRate / static_cast<double>(n);
+    double low = options.bands[0].lowHz, high = options.bands[0].highHz;
+    for (const auto& band : options.bands) {
+        low = std::min(low, band.lowHz);
+        high = std::max(high, band.highHz);
+    }
+    m_firstBin = static_cast<size_t>(std::ceil(low / resolution));
+    size_t lastBin = std::min(static_cast<size_t>(std::floor(high / resolution)), n / 2);
+    if (lastBin < m_firstBin) {
+        error = "Frequency bands are outside the spectrum";
+        return false;
+    }
+    const size_t usedBins = lastBin - m_firstBin + 1;
+    m_bins = (usedBins + kLanes - 1) / kLanes * kLanes;
+
+    const size_t segments = (length - n) / options.hopSize + 1;
+    const size_t plane = segments * m_bins;
+
+    if (m_window.size() != n) {
+        m_window.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            m_window[i] = 0.5 * (1.0 - std::cos(2.0 * kPi * static_cast<double>(i) / static_cast<double>(n - 1)));
+        }
+    }
+    m_frame.resize(n);
+    m_re.assign(channelCount * plane, 0.0);
+    m_im.assign(channelCount * plane, 0.0);
+    m_unitRe.assign(channelCount * plane, 0.0);
+    m_unitIm.assign(channelCount * plane, 0.0);
+    m_auto.assign(channelCount * m_bins, 0.0);
+
+    // One FFT per channel per frame
+    for (size_t c = 0; c < channelCount; ++c) {
+        for (size_t s = 0; s < segments; ++s) {
+            const double* segment = channels[c] + s * options.hopSize;
+            double mean = 0.0;
+            for (size_t i = 0; i < n; ++i) mean += segment[i];
+            mean /= static_cast<double>(n);
+            for (size_t i = 0; i < n; ++i) {
+                m_frame[i] = std::complex<double>((segment[i] - mean) * m_window[i], 0.0);
+            }
+            fftInPlace(m_frame.data(), n);
+
+            size_t base = c * plane + s * m_bins;
+            for (size_t b = 0; b < usedBins; ++b) {
+                const std::complex<double>& x = m_frame[m_firstBin + b];
+                double magnitude = std::abs(x);
+                m_re[base + b] = x.real();
+                m_im[base + b] = x.imag();
+                m_unitRe[base + b] = magnitude > 0.0 ? x.real() / magnitude : 0.0;
+                m_unitIm[base + b] = magnitude > 0.0 ? x.imag() / magnitude : 0.0;
+                m_auto[c * m_bins + b] += std::norm(x);
+            }
+        }
+    }
+
+    // Band bin ranges relative to m_firstBin
+    struct Range { size_t first, count; };
+    std::vector<Range> ranges;
+    for (const auto& band : options.bands) {
+        size_t first = std::max(static_cast<size_t>(std::ceil(band.lowHz / resolution)), m_firstBin);
+        size_t last = std::min(static_cast<size_t>(std::floor(band.highHz / resolution)), lastBin);
+        ranges.push_back({ first - m_firstBin, last >= first ? last - first + 1 : 0 });
+    }
+
+    const size_t bands = options.bands.size();
+    result.channels = channelCount;
+    result.bands = bands;
+    result.segments = segments;
+    result.coherence.assign(bands * channelCount * channelCount, 0.0f);
+    result.plv.assign(bands * channelCount * channelCount, 0.0f);
+    result.correlation.assign(bands * channelCount * channelCount, 0.0f);
+    for (size_t band = 0; band < bands; ++band) {
+        for (size_t i = 0; i < channelCount; ++i) {
+            result.coherence[result.index(band, i, i)] = 1.0f;
+            result.plv[result.index(band, i, i)] = 1.0f;
+            result.correlation[result.index(band, i, i)] = 1.0f;
+        }
+    }
+
+    m_crossRe.resize(m_bins);
+    m_crossIm.resize(m_bins);
+    m_phaseRe.resize(m_bins);
+    m_phaseIm.resize(m_bins);
+
+    for (size_t i = 0; i < channelCount; ++i) {
+        for (size_t j = i + 1; j < channelCount; ++j) {
+            std::fill(m_crossRe.begin(), m_crossRe.end(), 0.0);
+            std::fill(m_crossIm.begin(), m_crossIm.end(), 0.0);
+            std::fill(m_phaseRe.begin(), m_phaseRe.end(), 0.0);
+            std::fill(m_phaseIm.begin(), m_phaseIm.end(), 0.0);
+
+            for (size_t s = 0; s < segments; ++s) {
+                size_t a = i * plane + s * m_bins;
+                size_t b = j * plane + s * m_bins;
+                crossAccumulate(&m_re[a], &m_im[a], &m_re[b], &m_im[b], m_crossRe.data(), m_crossIm.data(), m_bins);
+                crossAccumulate(&m_unitRe[a], &m_unitIm[a], &m_unitRe[b], &m_unitIm[b], m_phaseRe.data(), m_phaseIm.data(), m_bins);
+            }
+
+            const double* autoI = &m_auto[i * m_bins];
+            const double* autoJ = &m_auto[j * m_bins];
+            for (size_t band = 0; band < bands; ++band) {
+                const Range& range = ranges[band];
+                if (range.count == 0) continue;
+
+                double coherence = 0.0, crossSum = 0.0, powerI = 0.0, powerJ = 0.0;
+                double phaseLocking = 0.0;
+                for (size_t k = range.first; k < range.first + range.count; ++k) {
+                    double denominator = autoI[k] * autoJ[k];
+                    if (denominator > 0.0) {
+                        coherence += (m_crossRe[k] * m_crossRe[k] + m_crossIm[k] * m_crossIm[k]) / denominator;
+                    }
+                    crossSum += m_crossRe[k];
+                    powerI += autoI[k];
+                    powerJ += autoJ[k];
+                    // PLV is the phase consistency of one bin across segments;
+                    // phases of different bins are unrelated, so average the
+                    // per-bin magnitudes rather than the unit vectors.
+                    phaseLocking += std::sqrt(m_phaseRe[k] * m_phaseRe[k] + m_phaseIm[k] * m_phaseIm[k]);
+                }
+                const double binsInBand = static_cast<double>(range.count);
+                const float coh = static_cast<float>(coherence / binsInBand);
+                const float plv = static_cast<float>(phaseLocking / (binsInBand * static_cast<double>(segments)));
+                const double norm = std::sqrt(powerI * powerJ);
+                const float corr = norm > 0.0 ? static_cast<float>(crossSum / norm) : 0.0f;
+
+                result.coherence[result.index(band, i, j)] = result.coherence[result.index(band, j, i)] = coh;
+                result.plv[result.index(band, i, j)] = result.plv[result.index(band, j, i)] = plv;
+                result.correlation[result.index(band, i, j)] = result.correlation[result.index(band, j, i)] = corr;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace brainmirror
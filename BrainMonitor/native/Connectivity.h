@@ -0,0 +1,61 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Pairwise connectivity across channels (and devices in group sessions):
+// magnitude-squared coherence, phase-locking value and band-limited
+// correlation per frequency band.
+//
+// Every channel is transformed once per shared Welch frame; spectra are kept
+// as structure-of-arrays (real / imaginary planes) restricted to the bins the
+// bands need, and each channel pair only runs a vectorized complex
+// multiply-accumulate over those planes. Cost grows with pairs x bins rather
+// than with pairs x FFTs.
+namespace brainmirror {
+
+struct FrequencyBand {
+    double lowHz;
+    double highHz;
+};
+
+struct ConnectivityOptions {
+    size_t segmentSize = 512;       // Power of two
+    size_t hopSize = 256;           // 50% overlap
+    // Same band edges as the single-channel analysis
+    std::vector<FrequencyBand> bands = { { 4.0, 7.0 }, { 8.0, 13.0 }, { 15.0, 25.0 } };
+};
+
+// Matrices are symmetric with a unit diagonal, laid out [band][i][j].
+struct ConnectivityResult {
+    size_t channels = 0;
+    size_t bands = 0;
+    size_t segments = 0;
+    std::vector<float> coherence;
+    std::vector<float> plv;
+    std::vector<float> correlation;
+
+    size_t index(size_t band, size_t i, size_t j) const { return (band * channels + i) * channels + j; }
+};
+
+// Reusable engine; buffers are kept between calls.
+class ConnectivityEngine {
+public:
+    // channels[c] points at `length` samples of channel c.
+    bool compute(const double* const* channels, size_t channelCount, size_t length, double sampleRate,
+                 const ConnectivityOptions& options, ConnectivityResult& result, std::string& error);
+
+private:
+    size_t m_bins = 0;              // Bins kept per frame, padded to the SIMD width
+    size_t m_firstBin = 0;
+    std::vector<double> m_window;
+    std::vector<std::complex<double>> m_frame;
+    std::vector<double> m_re, m_im;         // [channel][segment][bin]
+    std::vector<double> m_unitRe, m_unitIm; // Same, normalized to unit magnitude (phase only)
+    std::vector<double> m_auto;             // [channel][bin] summed over segments
+    std::vector<double> m_crossRe, m_crossIm, m_phaseRe, m_phaseIm;     // One pair, [bin]
+};
+
+} // namespace brainmirror
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "LivePipeline.h"
+
+// Compile-time descriptions of the supported headsets. Each profile becomes
+// one ProfilePipeline instantiation; createPipeline() picks it from the
+// device type reported at scan/connect time.
+//
+// A profile provides: Name, SampleRate, Channels, FftSize (power of two),
+// HopSize (samples between windows), Clip (uV), Filters (biquad cascade),
+// Bands (theta, alpha, beta in Hz) and Total (normalisation range).
+namespace brainmirror {
+namespace live {
+
+// Single-channel forehead headband, 520 Hz. Matches the offline analysis:
+// +/-100 uV clipping, 0.5-30 Hz pass band (the range EDF files are labelled
+// with), theta 4-7 Hz, alpha 8-13 Hz, beta 15-25 Hz. One window per second.
+struct Headband520 {
+    static constexpr const char* Name = "headband-520";
+    static constexpr int SampleRate = 520;
+    static constexpr int Channels = 1;
+    static constexpr size_t FftSize = 1024;
+    static constexpr size_t HopSize = 520;
+    static constexpr double Clip = 100.0;
+    static constexpr std::array<BiquadCoefficients, 2> Filters = {
+        rbjHighPass(SampleRate, 0.5, 0.7071067811865476),
+        rbjLowPass(SampleRate, 30.0, 0.7071067811865476),
+    };
+    static constexpr std::array<Band, BandCount> Bands = { { { 4.0, 7.0 }, { 8.0, 13.0 }, { 15.0, 25.0 } } };
+    static constexpr Band Total = { 1.0, 30.0 };
+};
+
+} // namespace live
+} // namespace brainmirror
@@ -0,0 +1,115 @@
+#include "EdfWriter.h"
+
+#include <algorithm>
+#include <ctime>
+
+namespace brainmirror {
+
+namespace {
+
+constexpr size_t kBufferSamples = 32768;
+constexpr long kRecordCountOffset = 236;
+
+} // namespace
+
+EdfWriter::~EdfWriter() {
+    finish();
+}
+
+void EdfWriter::writeField(const std::string& value, size_t length) {
+    std::string field = value.substr(0, length);
+    field.resize(length, ' ');
+    std::fwrite(field.data(), 1, length, m_file);
+}
+
+bool EdfWriter::open(const std::string& path, const std::string& patientId, const std::string& recordingId) {
+    finish();
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) return false;
+
+    m_buffer.reserve(kBufferSamples);
+    m_records = 0;
+
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+#if defined(_WIN32)
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    char date[16], time[16];
+    std::strftime(date, sizeof(date), "%d.%m.%y", &local);
+    std::strftime(time, sizeof(time), "%H.%M.%S", &local);
+
+    // Same field values EDFWriter.cs produces (its "F6" numbers are cut to 8 chars)
+    writeField("0", 8);
+    writeField(patientId, 80);
+    writeField(recordingId, 80);
+    writeField(date, 8);
+    writeField(time, 8);
+    writeField("256", 8);
+    writeField("", 44);
+    writeField("-1", 8);
+    writeField("0.010000", 8);
+    writeField("1", 4);
+
+    writeField("FP1", 16);
+    writeField("EDF Annotations", 80);
+    writeField("uV", 8);
+    writeField("-3000.000000", 8);
+    writeField("3000.000000", 8);
+    writeField("-32767", 8);
+    writeField("32767", 8);
+    writeField("HP:0.5Hz LP:30Hz", 80);
+    writeField("1", 8);
+    writeField("", 32);
+    return true;
+}
+
+int16_t EdfWriter::toDigital(double sample) const {
+    double physical = std::max(PhysicalMinimum, std::min(PhysicalMaximum, sample));
+    double normalized = (physical - PhysicalMinimum) / (PhysicalMaximum - PhysicalMinimum);
+    int digital = static_cast<int>(DigitalMinimum + normalized * (DigitalMaximum - DigitalMinimum));
+    return static_cast<int16_t>(std::max(DigitalMinimum, std::min(DigitalMaximum, digital)));
+}
+
+void EdfWriter::addSamples(const double* samples, size_t count) {
+    if (!m_file) return;
+    for (size_t i = 0; i < count; ++i) {
+        m_buffer.push_back(toDigital(samples[i]));
+        if (m_buffer.size() == kBufferSamples) flush();
+    }
+    m_records += count;
+}
+
+void EdfWriter::addSamples(const int* samples, size_t count) {
+    if (!m_file) return;
+    for (size_t i = 0; i < count; ++i) {
+        m_buffer.push_back(toDigital(static_cast<double>(samples[i])));
+        if (m_buffer.size() == kBufferSamples) flush();
+    }
+    m_records += count;
+}
+
+void EdfWriter::flush() {
+    // EDF is little endian, as are all supported targets
+    if (!m_buffer.empty()) {
+        std::fwrite(m_buffer.data(), sizeof(int16_t), m_buffer.size(), m_file);
+        m_buffer.clear();
+    }
+}
+
+bool EdfWriter::finish() {
+    if (!m_file) return false;
+
+    flush();
+    if (m_records > 0) {
+        std::fseek(m_file, kRecordCountOffset, SEEK_SET);
+        writeField(std::to_string(m_records), 8);
+    }
+    bool ok = std::fclose(m_file) == 0;
+    m_file = nullptr;
+    return ok;
+}
+
+} // namespace brainmirror
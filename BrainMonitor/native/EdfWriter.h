@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace brainmirror {
+
+// Native counterpart of Services/EDFWriter.cs. Produces byte-identical
+// headers (including the one-sample data records and the 256-byte header
+// size field the existing files carry) so server and EDFAnalyzer tooling
+// read both the same way. Samples are buffered and written in blocks.
+class EdfWriter {
+public:
+    EdfWriter() = default;
+    ~EdfWriter();
+
+    EdfWriter(const EdfWriter&) = delete;
+    EdfWriter& operator=(const EdfWriter&) = delete;
+
+    bool open(const std::string& path, const std::string& patientId = "X X X X",
+              const std::string& recordingId = "Startdate");
+    void addSamples(const double* samples, size_t count);
+    void addSamples(const int* samples, size_t count);
+
+    // Flushes, patches the record count into the header and closes the file.
+    bool finish();
+
+    uint64_t samplesWritten() const { return m_records; }
+
+    static constexpr double PhysicalMinimum = -3000.0;
+    static constexpr double PhysicalMaximum = 3000.0;
+    static constexpr int DigitalMinimum = -32767;
+    static constexpr int DigitalMaximum = 32767;
+
+private:
+    std::FILE* m_file = nullptr;
+    std::vector<int16_t> m_buffer;
+    uint64_t m_records = 0;
+
+    void writeField(const std::string& value, size_t length);
+    void flush();
+    int16_t toDigital(double sample) const;
+};
+
+} // namespace brainmirror
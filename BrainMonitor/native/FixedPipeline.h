@@ -0,0 +1,255 @@
+#pragma once
+
+#include "LivePipeline.h"
+
+#include <climits>
+
+// Fixed-point variant of ProfilePipeline for low-power stations. It works on
+// the raw int samples end to end instead of converting every sample to
+// double:
+//
+//   samples   int32; the clip level maps to 2^SampleBits
+//   biquads   Q30 coefficients, direct form I, 64-bit accumulator
+//   window    Q15
+//   FFT       int32 complex, Q31 twiddles, radix-2 with a 1-bit shift per
+//             stage (the result is the DFT divided by N)
+//   power     |X|^2 summed in uint64; one division per window for the ratios
+//
+// History and work buffers are half the size of the double path. Relative
+// band power stays within FixedRelativeErrorBound of ProfilePipeline for the
+// same input (brainbench checks this in accuracy/fixed_point), and totalPower
+// is reported in the same units.
+namespace brainmirror {
+namespace live {
+
+constexpr double FixedRelativeErrorBound = 0.005;
+
+namespace fx {
+
+constexpr int SampleBits = 20;
+constexpr int CoefficientBits = 30;
+constexpr int WindowBits = 15;
+constexpr int TwiddleBits = 31;
+
+constexpr int32_t toFixed(double value, int bits) {
+    double scaled = value * static_cast<double>(1LL << bits);
+    double rounded = scaled >= 0.0 ? scaled + 0.5 : scaled - 0.5;
+    if (rounded >= static_cast<double>(INT32_MAX)) return INT32_MAX;
+    if (rounded <= static_cast<double>(INT32_MIN)) return INT32_MIN;
+    return static_cast<int32_t>(rounded);
+}
+
+// Arithmetic shift right with round-to-nearest
+template <int Bits>
+constexpr int64_t roundShift(int64_t value) {
+    return (value + (int64_t(1) << (Bits - 1))) >> Bits;
+}
+
+struct BiquadQ30 {
+    int32_t b0, b1, b2, a1, a2;
+};
+
+constexpr BiquadQ30 toQ30(const BiquadCoefficients& c) {
+    return { toFixed(c.b0, CoefficientBits), toFixed(c.b1, CoefficientBits), toFixed(c.b2, CoefficientBits),
+             toFixed(c.a1, CoefficientBits), toFixed(c.a2, CoefficientBits) };
+}
+
+// Direct form I keeps the state in sample units, so rounding happens once per
+// output and the recursive part never sees truncated intermediate values.
+struct BiquadStateQ {
+    int32_t x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+};
+
+template <BiquadQ30 C>
+inline int32_t biquadStep(BiquadStateQ& s, int32_t x) {
+    int64_t acc = int64_t(C.b0) * x + int64_t(C.b1) * s.x1 + int64_t(C.b2) * s.x2
+                - int64_t(C.a1) * s.y1 - int64_t(C.a2) * s.y2;
+    int32_t y = static_cast<int32_t>(roundShift<CoefficientBits>(acc));
+    s.x2 = s.x1;
+    s.x1 = x;
+    s.y2 = s.y1;
+    s.y1 = y;
+    return y;
+}
+
+struct ComplexQ {
+    int32_t re, im;
+};
+
+template <size_t N>
+struct FixedFftTables {
+    std::array<int32_t, N / 2> twiddleRe{};
+    std::array<int32_t, N / 2> twiddleIm{};
+    std::array<uint32_t, N> bitReverse{};
+    std::array<int16_t, N> window{};
+
+    constexpr FixedFftTables() {
+        const FftTables<N> source{};
+        for (size_t k = 0; k < N / 2; ++k) {
+            twiddleRe[k] = toFixed(source.twiddleRe[k], TwiddleBits);
+            twiddleIm[k] = toFixed(source.twiddleIm[k], TwiddleBits);
+        }
+        for (size_t i = 0; i < N; ++i) {
+            bitReverse[i] = source.bitReverse[i];
+            int32_t w = toFixed(source.window[i], WindowBits);
+            window[i] = static_cast<int16_t>(w > INT16_MAX ? INT16_MAX : w);
+        }
+    }
+};
+
+} // namespace fx
+
+template <typename Profile>
+class FixedProfilePipeline final : public Pipeline {
+public:
+    static constexpr int Channels = Profile::Channels;
+    static constexpr size_t N = Profile::FftSize;
+    static constexpr size_t Hop = Profile::HopSize;
+    static constexpr size_t FilterCount = Profile::Filters.size();
+    static constexpr int ClipRaw = static_cast<int>(Profile::Clip);
+    static constexpr int32_t InputScale = static_cast<int32_t>((1 << fx::SampleBits) / Profile::Clip);
+    // Converts sum |X|^2 back to the units of ProfilePipeline::totalPower
+    static constexpr double PowerScale = (static_cast<double>(N) / InputScale) * (static_cast<double>(N) / InputScale);
+    static constexpr fx::FixedFftTables<N> Tables{};
+    static constexpr std::array<fx::BiquadQ30, FilterCount> Filters = [] {
+        std::array<fx::BiquadQ30, FilterCount> q{};
+        for (size_t i = 0; i < FilterCount; ++i) q[i] = fx::toQ30(Profile::Filters[i]);
+        return q;
+    }();
+    static constexpr BinRange TotalBins = bandBins(Profile::Total, Profile::SampleRate, N);
+    static constexpr std::array<BinRange, BandCount> BandBins = {
+        bandBins(Profile::Bands[0], Profile::SampleRate, N),
+        bandBins(Profile::Bands[1], Profile::SampleRate, N),
+        bandBins(Profile::Bands[2], Profile::SampleRate, N),
+    };
+
+    static_assert(Profile::Clip == static_cast<double>(ClipRaw), "The fixed-point path clips raw integer samples");
+    static_assert(InputScale > 0, "Clip level too large for the fixed-point sample range");
+    static_assert(Hop > 0 && Hop <= N, "Hop size must be within the FFT window");
+
+    static constexpr size_t WorkspaceBytes =
+        Channels * N * sizeof(int32_t) + N * sizeof(fx::ComplexQ) + 2 * alignof(std::max_align_t);
+
+    explicit FixedProfilePipeline(Arena& arena) {
+        for (auto& ch : m_channels) ch.history = arena.allocateArray<int32_t>(N);
+        m_work = arena.allocateArray<fx::ComplexQ>(N);
+    }
+
+    bool push(int chan, const int* data, int len) override {
+        if (chan < 0 || chan >= Channels || !data || len <= 0) return false;
+        if (m_resetPending.load(std::memory_order_acquire) && m_resetPending.exchange(false)) reset();
+        ChannelState& ch = m_channels[chan];
+
+        bool completed = false;
+        for (int i = 0; i < len; ++i) {
+            int32_t x = data[i] > ClipRaw ? ClipRaw : (data[i] < -ClipRaw ? -ClipRaw : data[i]);
+            x = filter(ch.filters, x * InputScale, std::make_index_sequence<FilterCount>{});
+
+            ch.history[ch.write] = x;
+            ch.write = ch.write + 1 == N ? 0 : ch.write + 1;
+            if (ch.filled < N) ch.filled++;
+            if (++ch.sinceWindow >= Hop && ch.filled == N) {
+                ch.sinceWindow = 0;
+                analyze(ch);
+                completed = true;
+            }
+        }
+        return completed;
+    }
+
+    bool latest(int chan, BandPower& out) const override {
+        if (chan < 0 || chan >= Channels || m_resetPending.load(std::memory_order_acquire)) return false;
+        return m_channels[chan].published.load(out);
+    }
+
+    const char* profileName() const override { return Profile::Name; }
+    int sampleRate() const override { return Profile::SampleRate; }
+    int channelCount() const override { return Channels; }
+    Arithmetic arithmetic() const override { return Arithmetic::Fixed; }
+
+private:
+    struct ChannelState {
+        int32_t* history = nullptr;         // N samples, ring
+        std::array<fx::BiquadStateQ, FilterCount> filters{};
+        size_t write = 0;
+        size_t filled = 0;
+        size_t sinceWindow = 0;
+        uint32_t epoch = 0;
+        PublishedBandPower published;
+    };
+
+    std::array<ChannelState, Channels> m_channels;
+    fx::ComplexQ* m_work = nullptr;
+
+    void reset() {
+        for (auto& ch : m_channels) {
+            std::fill(ch.history, ch.history + N, 0);
+            ch.filters = {};
+            ch.write = ch.filled = ch.sinceWindow = 0;
+            ch.epoch = 0;
+            ch.published.store(BandPower());
+        }
+    }
+
+    template <size_t... I>
+    static int32_t filter(std::array<fx::BiquadStateQ, FilterCount>& states, int32_t x, std::index_sequence<I...>) {
+        ((x = fx::biquadStep<Filters[I]>(states[I], x)), ...);
+        return x;
+    }
+
+    template <size_t Len>
+    static void stage(fx::ComplexQ* a) {
+        constexpr size_t half = Len / 2;
+        constexpr size_t stride = N / Len;
+        for (size_t i = 0; i < N; i += Len) {
+            for (size_t j = 0; j < half; ++j) {
+                const int64_t wr = Tables.twiddleRe[j * stride], wi = Tables.twiddleIm[j * stride];
+                const fx::ComplexQ u = a[i + j];
+                const fx::ComplexQ x = a[i + j + half];
+                const int64_t vr = fx::roundShift<fx::TwiddleBits>(x.re * wr - x.im * wi);
+                const int64_t vi = fx::roundShift<fx::TwiddleBits>(x.re * wi + x.im * wr);
+                a[i + j] = { static_cast<int32_t>(fx::roundShift<1>(u.re + vr)),
+                             static_cast<int32_t>(fx::roundShift<1>(u.im + vi)) };
+                a[i + j + half] = { static_cast<int32_t>(fx::roundShift<1>(u.re - vr)),
+                                    static_cast<int32_t>(fx::roundShift<1>(u.im - vi)) };
+            }
+        }
+    }
+
+    template <size_t... S>
+    static void stages(fx::ComplexQ* a, std::index_sequence<S...>) {
+        (stage<(size_t(2) << S)>(a), ...);
+    }
+
+    static uint64_t power(const fx::ComplexQ* a, BinRange range) {
+        uint64_t sum = 0;
+        for (size_t k = range.first; k <= range.last; ++k) {
+            sum += static_cast<uint64_t>(int64_t(a[k].re) * a[k].re + int64_t(a[k].im) * a[k].im);
+        }
+        return sum;
+    }
+
+    void analyze(ChannelState& ch) {
+        // Oldest sample first
+        fx::ComplexQ* a = m_work;
+        for (size_t i = 0; i < N; ++i) {
+            size_t source = ch.write + i < N ? ch.write + i : ch.write + i - N;
+            int64_t windowed = fx::roundShift<fx::WindowBits>(int64_t(ch.history[source]) * Tables.window[i]);
+            a[Tables.bitReverse[i]] = { static_cast<int32_t>(windowed), 0 };
+        }
+        stages(a, std::make_index_sequence<cm::log2(N)>{});
+
+        const uint64_t total = power(a, TotalBins);
+        BandPower result;
+        for (int b = 0; b < BandCount; ++b) {
+            result.relative[b] = total > 0
+                ? static_cast<float>(static_cast<double>(power(a, BandBins[b])) / static_cast<double>(total)) : 0.0f;
+        }
+        result.totalPower = static_cast<float>(static_cast<double>(total) * PowerScale);
+        result.epoch = ++ch.epoch;
+        ch.published.store(result);
+    }
+};
+
+} // namespace live
+} // namespace brainmirror
@@ -0,0 +1,213 @@
+#include "HttpClient.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using NativeSocket = SOCKET;
+#define BRAINMIRROR_CLOSE_SOCKET closesocket
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+using NativeSocket = int;
+#define BRAINMIRROR_CLOSE_SOCKET ::close
+#endif
+
+namespace brainmirror {
+
+namespace {
+
+#if defined(_WIN32)
+struct WinsockInit {
+    WinsockInit() {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+    }
+    ~WinsockInit() { WSACleanup(); }
+};
+#endif
+
+std::string lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+// Value of `name` in a header block (name already lower case), or "".
+std::string headerValue(const std::string& headers, const std::string& name) {
+    std::string lowered = lower(headers);
+    size_t pos = lowered.find("\r\n" + name + ":");
+    if (pos == std::string::npos) return "";
+    pos += name.size() + 3;
+    size_t end = headers.find("\r\n", pos);
+    std::string value = headers.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+    size_t first = value.find_first_not_of(" \t");
+    return first == std::string::npos ? "" : value.substr(first);
+}
+
+} // namespace
+
+HttpClient::HttpClient(std::string host, uint16_t port, int timeoutMs)
+    : m_host(std::move(host)), m_port(port), m_timeoutMs(timeoutMs) {
+#if defined(_WIN32)
+    static WinsockInit winsock;
+#endif
+}
+
+HttpClient::~HttpClient() {
+    close();
+}
+
+void HttpClient::close() {
+    if (m_socket != -1) {
+        BRAINMIRROR_CLOSE_SOCKET(static_cast<NativeSocket>(m_socket));
+        m_socket = -1;
+    }
+}
+
+bool HttpClient::connect() {
+    close();
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* results = nullptr;
+    std::string service = std::to_string(m_port);
+    if (getaddrinfo(m_host.c_str(), service.c_str(), &hints, &results) != 0) return false;
+
+    for (addrinfo* ai = results; ai; ai = ai->ai_next) {
+        NativeSocket s = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+#if defined(_WIN32)
+        if (s == INVALID_SOCKET) continue;
+        DWORD timeout = static_cast<DWORD>(m_timeoutMs);
+        setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+        setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+#else
+        if (s < 0) continue;
+        timeval timeout{ m_timeoutMs / 1000, (m_timeoutMs % 1000) * 1000 };
+        setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#endif
+        int noDelay = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+        if (::connect(s, ai->ai_addr, static_cast<int>(ai->ai_addrlen)) == 0) {
+            m_socket = static_cast<intptr_t>(s);
+            break;
+        }
+        BRAINMIRROR_CLOSE_SOCKET(s);
+    }
+    freeaddrinfo(results);
+    return m_socket != -1;
+}
+
+bool HttpClient::sendAll(const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        int flags = 0;
+#if defined(MSG_NOSIGNAL)
+        flags = MSG_NOSIGNAL;
+#endif
+        auto sent = send(static_cast<NativeSocket>(m_socket), p, static_cast<int>(std::min<size_t>(size, 1 << 20)), flags);
+        if (sent <= 0) return false;
+        p += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool HttpClient::readMore(std::string& buffer) {
+    char chunk[8192];
+    auto received = recv(static_cast<NativeSocket>(m_socket), chunk, sizeof(chunk), 0);
+    if (received <= 0) return false;
+    buffer.append(chunk, static_cast<size_t>(received));
+    return true;
+}
+
+bool HttpClient::readResponse(HttpResponse& response, bool& keepAlive) {
+    std::string buffer;
+    size_t headerEnd;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (buffer.size() > 64 * 1024 || !readMore(buffer)) return false;
+    }
+
+    std::string headers = buffer.substr(0, headerEnd + 2);
+    std::string body = buffer.substr(headerEnd + 4);
+    if (headers.compare(0, 5, "HTTP/") != 0) return false;
+    size_t space = headers.find(' ');
+    response.status = space == std::string::npos ? 0 : std::atoi(headers.c_str() + space + 1);
+
+    keepAlive = lower(headerValue(headers, "connection")) != "close";
+    std::string length = headerValue(headers, "content-length");
+    if (lower(headerValue(headers, "transfer-encoding")).find("chunked") != std::string::npos) {
+        std::string decoded;
+        size_t pos = 0;
+        for (;;) {
+            size_t lineEnd;
+            while ((lineEnd = body.find("\r\n", pos)) == std::string::npos) {
+                if (!readMore(body)) return false;
+            }
+            size_t size = std::strtoul(body.c_str() + pos, nullptr, 16);
+            pos = lineEnd + 2;
+            while (body.size() < pos + size + 2) {
+                if (!readMore(body)) return false;
+            }
+            if (size == 0) break;
+            decoded.append(body, pos, size);
+            pos += size + 2;
+        }
+        response.body = std::move(decoded);
+    }
+    else if (!length.empty()) {
+        size_t size = std::strtoul(length.c_str(), nullptr, 10);
+        while (body.size() < size) {
+            if (!readMore(body)) return false;
+        }
+        body.resize(size);
+        response.body = std::move(body);
+    }
+    else {
+        while (readMore(body)) {
+        }
+        keepAlive = false;
+        response.body = std::move(body);
+    }
+    return true;
+}
+
+HttpResponse HttpClient::request(const char* method, const std::string& path,
+                                 const std::vector<std::pair<std::string, std::string>>& headers,
+                                 const void* body, size_t bodySize) {
+    std::string head = std::string(method) + " " + path + " HTTP/1.1\r\nHost: " + m_host + ":" + std::to_string(m_port) +
+        "\r\nContent-Length: " + std::to_string(bodySize) + "\r\nConnection: keep-alive\r\n";
+    for (const auto& header : headers) {
+        head += header.first + ": " + header.second + "\r\n";
+    }
+    head += "\r\n";
+
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool reused = m_socket != -1;
+        if (!reused && !connect()) return HttpResponse();
+
+        HttpResponse response;
+        bool keepAlive = false;
+        if (sendAll(head.data(), head.size()) && (bodySize == 0 || sendAll(body, bodySize)) &&
+            readResponse(response, keepAlive)) {
+            if (!keepAlive) close();
+            return response;
+        }
+        close();
+        // Only a kept-alive connection gets a second try; the server may
+        // have closed it while idle
+        if (!reused) break;
+    }
+    return HttpResponse();
+}
+
+} // namespace brainmirror
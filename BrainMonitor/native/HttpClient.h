@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal blocking HTTP/1.1 client over plain TCP sockets for the uploader.
+// Keeps one keep-alive connection and reconnects on demand. Handles
+// Content-Length and chunked response bodies. No TLS: the upload server is
+// reached over the clinic LAN or a local reverse proxy.
+namespace brainmirror {
+
+struct HttpResponse {
+    int status = 0;             // 0: no response (connection or timeout error)
+    std::string body;
+};
+
+class HttpClient {
+public:
+    HttpClient(std::string host, uint16_t port, int timeoutMs = 10000);
+    ~HttpClient();
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    // Sends one request and waits for the response. Retries once on a fresh
+    // connection when a kept-alive connection turns out to be closed.
+    HttpResponse request(const char* method, const std::string& path,
+                         const std::vector<std::pair<std::string, std::string>>& headers,
+                         const void* body, size_t bodySize);
+
+    void close();
+
+private:
+    std::string m_host;
+    uint16_t m_port;
+    int m_timeoutMs;
+    intptr_t m_socket = -1;
+
+    bool connect();
+    bool sendAll(const void* data, size_t size);
+    bool readResponse(HttpResponse& response, bool& keepAlive);
+    bool readMore(std::string& buffer);
+};
+
+} // namespace brainmirror
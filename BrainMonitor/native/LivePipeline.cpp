@@ -0,0 +1,50 @@
+#include "LivePipeline.h"
+#include "DeviceProfiles.h"
+#include "FixedPipeline.h"
+
+namespace brainmirror {
+namespace live {
+
+namespace {
+
+template <typename Profile>
+std::unique_ptr<Pipeline> create(Arena& arena, Arithmetic arithmetic) {
+    if (arithmetic == Arithmetic::Fixed) return std::make_unique<FixedProfilePipeline<Profile>>(arena);
+    return std::make_unique<ProfilePipeline<Profile>>(arena);
+}
+
+template <typename Profile>
+size_t workspaceBytes(Arithmetic arithmetic) {
+    return arithmetic == Arithmetic::Fixed
+        ? FixedProfilePipeline<Profile>::WorkspaceBytes
+        : ProfilePipeline<Profile>::WorkspaceBytes;
+}
+
+} // namespace
+
+// The dongle reports a type per device but every headset shipped so far is
+// the 520 Hz headband, so unknown types fall back to it. New hardware gets a
+// profile in DeviceProfiles.h and a case here.
+std::unique_ptr<Pipeline> createPipeline(int deviceType, Arena& arena, Arithmetic arithmetic) {
+    switch (deviceType) {
+    default:
+        return create<Headband520>(arena, arithmetic);
+    }
+}
+
+size_t workspaceBytesForType(int deviceType, Arithmetic arithmetic) {
+    switch (deviceType) {
+    default:
+        return workspaceBytes<Headband520>(arithmetic);
+    }
+}
+
+const char* profileNameForType(int deviceType) {
+    switch (deviceType) {
+    default:
+        return Headband520::Name;
+    }
+}
+
+} // namespace live
+} // namespace brainmirror
@@ -0,0 +1,354 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "Arena.h"
+
+// Live band-power pipeline specialized at compile time per device profile.
+// Sample rate, channel count, FFT size, filter cascade and band table are
+// constexpr members of the profile (see DeviceProfiles.h); filter
+// coefficients, twiddles, the window and band bin ranges are generated at
+// compile time so the per-packet path is straight-line code over fixed-size
+// arrays.
+namespace brainmirror {
+namespace live {
+
+constexpr int MaxDevices = 16;      // Connect indices reported by the dongle
+constexpr int BandCount = 3;        // theta, alpha, beta
+
+// ---------------------------------------------------------------------------
+// constexpr math (std::sin/std::cos are not constexpr on MSVC)
+// ---------------------------------------------------------------------------
+namespace cm {
+
+constexpr double Pi = 3.14159265358979323846;
+
+constexpr double reduce(double x) {
+    const double twoPi = 2.0 * Pi;
+    long long k = static_cast<long long>(x / twoPi + (x >= 0 ? 0.5 : -0.5));
+    return x - static_cast<double>(k) * twoPi;
+}
+
+constexpr double sin(double x) {
+    x = reduce(x);
+    double term = x, sum = x, x2 = x * x;
+    for (int n = 1; n < 24; ++n) {
+        term *= -x2 / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double cos(double x) {
+    return sin(x + Pi / 2.0);
+}
+
+constexpr size_t log2(size_t n) {
+    return n <= 1 ? 0 : 1 + log2(n / 2);
+}
+
+} // namespace cm
+
+// ---------------------------------------------------------------------------
+// Filters (RBJ audio EQ cookbook biquads, direct form II transposed)
+// ---------------------------------------------------------------------------
+struct BiquadCoefficients {
+    double b0, b1, b2, a1, a2;
+};
+
+constexpr BiquadCoefficients rbjLowPass(double sampleRate, double cutoff, double q) {
+    double w0 = 2.0 * cm::Pi * cutoff / sampleRate;
+    double c = cm::cos(w0), alpha = cm::sin(w0) / (2.0 * q), a0 = 1.0 + alpha;
+    return { (1.0 - c) / 2.0 / a0, (1.0 - c) / a0, (1.0 - c) / 2.0 / a0, -2.0 * c / a0, (1.0 - alpha) / a0 };
+}
+
+constexpr BiquadCoefficients rbjHighPass(double sampleRate, double cutoff, double q) {
+    double w0 = 2.0 * cm::Pi * cutoff / sampleRate;
+    double c = cm::cos(w0), alpha = cm::sin(w0) / (2.0 * q), a0 = 1.0 + alpha;
+    return { (1.0 + c) / 2.0 / a0, -(1.0 + c) / a0, (1.0 + c) / 2.0 / a0, -2.0 * c / a0, (1.0 - alpha) / a0 };
+}
+
+struct BiquadState {
+    double z1 = 0.0, z2 = 0.0;
+};
+
+template <BiquadCoefficients C>
+inline double biquadStep(BiquadState& s, double x) {
+    double y = C.b0 * x + s.z1;
+    s.z1 = C.b1 * x - C.a1 * y + s.z2;
+    s.z2 = C.b2 * x - C.a2 * y;
+    return y;
+}
+
+// ---------------------------------------------------------------------------
+// FFT tables
+// ---------------------------------------------------------------------------
+template <size_t N>
+struct FftTables {
+    static_assert(N >= 4 && (N & (N - 1)) == 0, "FFT size must be a power of two");
+
+    std::array<double, N / 2> twiddleRe{};
+    std::array<double, N / 2> twiddleIm{};
+    std::array<uint32_t, N> bitReverse{};
+    std::array<double, N> window{};     // Hanning, same definition as the offline analysis
+
+    constexpr FftTables() {
+        for (size_t k = 0; k < N / 2; ++k) {
+            double angle = -2.0 * cm::Pi * static_cast<double>(k) / static_cast<double>(N);
+            twiddleRe[k] = cm::cos(angle);
+            twiddleIm[k] = cm::sin(angle);
+        }
+        const size_t bits = cm::log2(N);
+        for (size_t i = 0; i < N; ++i) {
+            size_t r = 0;
+            for (size_t b = 0; b < bits; ++b) r |= ((i >> b) & 1u) << (bits - 1 - b);
+            bitReverse[i] = static_cast<uint32_t>(r);
+        }
+        for (size_t i = 0; i < N; ++i) {
+            window[i] = 0.5 * (1.0 - cm::cos(2.0 * cm::Pi * static_cast<double>(i) / static_cast<double>(N - 1)));
+        }
+    }
+};
+
+struct Band {
+    double lowHz;
+    double highHz;
+};
+
+struct BinRange {
+    size_t first;
+    size_t last;        // Inclusive
+};
+
+constexpr BinRange bandBins(Band band, double sampleRate, size_t fftSize) {
+    double resolution = sampleRate / static_cast<double>(fftSize);
+    size_t first = static_cast<size_t>(band.lowHz / resolution);
+    if (static_cast<double>(first) * resolution < band.lowHz) first++;
+    size_t last = static_cast<size_t>(band.highHz / resolution);
+    return { first, last < fftSize / 2 ? last : fftSize / 2 - 1 };
+}
+
+// ---------------------------------------------------------------------------
+// Pipeline
+// ---------------------------------------------------------------------------
+struct BandPower {
+    float relative[BandCount] = { 0, 0, 0 };    // Band power / total power, 0..1
+    float totalPower = 0.0f;
+    uint32_t epoch = 0;                         // 0: no complete window yet
+};
+
+// Latest result of one channel, written by the callback thread and read from
+// any thread (seqlock, no locks on either side).
+class PublishedBandPower {
+public:
+    void store(const BandPower& value) {
+        uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int b = 0; b < BandCount; ++b) m_relative[b].store(value.relative[b], std::memory_order_relaxed);
+        m_totalPower.store(value.totalPower, std::memory_order_relaxed);
+        m_epoch.store(value.epoch, std::memory_order_relaxed);
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    bool load(BandPower& out) const {
+        for (;;) {
+            uint32_t before = m_sequence.load(std::memory_order_acquire);
+            if (before & 1u) continue;
+            for (int b = 0; b < BandCount; ++b) out.relative[b] = m_relative[b].load(std::memory_order_relaxed);
+            out.totalPower = m_totalPower.load(std::memory_order_relaxed);
+            out.epoch = m_epoch.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == before) break;
+        }
+        return out.epoch > 0;
+    }
+
+private:
+    std::atomic<uint32_t> m_sequence{ 0 };
+    std::atomic<float> m_relative[BandCount] = {};
+    std::atomic<float> m_totalPower{ 0.0f };
+    std::atomic<uint32_t> m_epoch{ 0 };
+};
+
+// Sample arithmetic of a pipeline: double precision, or the fixed-point path
+// in FixedPipeline.h that works on the raw int samples.
+enum class Arithmetic { Float, Fixed };
+
+// Type-erased handle the wrapper keeps per connect index. The only virtual
+// call on the data path is push(), once per packet.
+class Pipeline {
+public:
+    virtual ~Pipeline() = default;
+
+    // Returns true when the packet completed a new analysis window.
+    virtual bool push(int chan, const int* data, int len) = 0;
+    // Safe to call from any thread while push() runs.
+    virtual bool latest(int chan, BandPower& out) const = 0;
+    virtual const char* profileName() const = 0;
+    virtual int sampleRate() const = 0;
+    virtual int channelCount() const = 0;
+    virtual Arithmetic arithmetic() const = 0;
+
+    // Clears filter state and history before the next push(), on the
+    // callback thread, so a pipeline can be reused for a new connection.
+    void requestReset() { m_resetPending.store(true, std::memory_order_release); }
+
+protected:
+    std::atomic<bool> m_resetPending{ false };
+};
+
+template <typename Profile>
+class ProfilePipeline final : public Pipeline {
+public:
+    static constexpr int Channels = Profile::Channels;
+    static constexpr size_t N = Profile::FftSize;
+    static constexpr size_t Hop = Profile::HopSize;
+    static constexpr size_t FilterCount = Profile::Filters.size();
+    static constexpr FftTables<N> Tables{};
+    static constexpr BinRange TotalBins = bandBins(Profile::Total, Profile::SampleRate, N);
+    static constexpr std::array<BinRange, BandCount> BandBins = {
+        bandBins(Profile::Bands[0], Profile::SampleRate, N),
+        bandBins(Profile::Bands[1], Profile::SampleRate, N),
+        bandBins(Profile::Bands[2], Profile::SampleRate, N),
+    };
+
+    static_assert(Profile::Bands.size() == BandCount, "Profile band table must list theta, alpha, beta");
+    static_assert(Hop > 0 && Hop <= N, "Hop size must be within the FFT window");
+
+    // Epoch history and the FFT work buffer, carved from the arena
+    static constexpr size_t WorkspaceBytes =
+        Channels * N * sizeof(double) + N * sizeof(std::complex<double>) + 2 * alignof(std::max_align_t);
+
+    explicit ProfilePipeline(Arena& arena) {
+        for (auto& ch : m_channels) ch.history = arena.allocateArray<double>(N);
+        m_work = arena.allocateArray<std::complex<double>>(N);
+    }
+
+    bool push(int chan, const int* data, int len) override {
+        if (chan < 0 || chan >= Channels || !data || len <= 0) return false;
+        if (m_resetPending.load(std::memory_order_acquire) && m_resetPending.exchange(false)) reset();
+        ChannelState& ch = m_channels[chan];
+
+        bool completed = false;
+        for (int i = 0; i < len; ++i) {
+            double x = static_cast<double>(data[i]);
+            x = x > Profile::Clip ? Profile::Clip : (x < -Profile::Clip ? -Profile::Clip : x);
+            x = filter(ch.filters, x, std::make_index_sequence<FilterCount>{});
+
+            ch.history[ch.write] = x;
+            ch.write = ch.write + 1 == N ? 0 : ch.write + 1;
+            if (ch.filled < N) ch.filled++;
+            if (++ch.sinceWindow >= Hop && ch.filled == N) {
+                ch.sinceWindow = 0;
+                analyze(ch);
+                completed = true;
+            }
+        }
+        return completed;
+    }
+
+    bool latest(int chan, BandPower& out) const override {
+        if (chan < 0 || chan >= Channels || m_resetPending.load(std::memory_order_acquire)) return false;
+        return m_channels[chan].published.load(out);
+    }
+
+    const char* profileName() const override { return Profile::Name; }
+    int sampleRate() const override { return Profile::SampleRate; }
+    int channelCount() const override { return Channels; }
+    Arithmetic arithmetic() const override { return Arithmetic::Float; }
+
+private:
+    void reset() {
+        for (auto& ch : m_channels) {
+            std::fill(ch.history, ch.history + N, 0.0);
+            ch.filters = {};
+            ch.write = ch.filled = ch.sinceWindow = 0;
+            ch.epoch = 0;
+            ch.published.store(BandPower());
+        }
+    }
+
+    struct ChannelState {
+        double* history = nullptr;         // N samples, ring
+        std::array<BiquadState, FilterCount> filters{};
+        size_t write = 0;
+        size_t filled = 0;
+        size_t sinceWindow = 0;
+        uint32_t epoch = 0;
+        PublishedBandPower published;
+    };
+
+    std::array<ChannelState, Channels> m_channels;
+    std::complex<double>* m_work = nullptr;    // Shared by the channels; push() is single threaded
+
+    template <size_t... I>
+    static double filter(std::array<BiquadState, FilterCount>& states, double x, std::index_sequence<I...>) {
+        ((x = biquadStep<Profile::Filters[I]>(states[I], x)), ...);
+        return x;
+    }
+
+    // One radix-2 butterfly stage; Len is constexpr so the inner loops unroll.
+    template <size_t Len>
+    static void stage(std::complex<double>* a) {
+        constexpr size_t half = Len / 2;
+        constexpr size_t stride = N / Len;
+        for (size_t i = 0; i < N; i += Len) {
+            for (size_t j = 0; j < half; ++j) {
+                std::complex<double> w(Tables.twiddleRe[j * stride], Tables.twiddleIm[j * stride]);
+                std::complex<double> u = a[i + j];
+                std::complex<double> v = a[i + j + half] * w;
+                a[i + j] = u + v;
+                a[i + j + half] = u - v;
+            }
+        }
+    }
+
+    template <size_t... S>
+    static void stages(std::complex<double>* a, std::index_sequence<S...>) {
+        (stage<(size_t(2) << S)>(a), ...);
+    }
+
+    void analyze(ChannelState& ch) {
+        // Oldest sample first
+        std::complex<double>* a = m_work;
+        for (size_t i = 0; i < N; ++i) {
+            size_t source = ch.write + i < N ? ch.write + i : ch.write + i - N;
+            a[Tables.bitReverse[i]] = std::complex<double>(ch.history[source] * Tables.window[i], 0.0);
+        }
+        stages(a, std::make_index_sequence<cm::log2(N)>{});
+
+        double total = 0.0;
+        for (size_t k = TotalBins.first; k <= TotalBins.last; ++k) total += std::norm(a[k]);
+
+        BandPower result;
+        for (int b = 0; b < BandCount; ++b) {
+            double power = 0.0;
+            for (size_t k = BandBins[b].first; k <= BandBins[b].last; ++k) power += std::norm(a[k]);
+            result.relative[b] = total > 0.0 ? static_cast<float>(power / total) : 0.0f;
+        }
+        result.totalPower = static_cast<float>(total);
+        result.epoch = ++ch.epoch;
+        ch.published.store(result);
+    }
+};
+
+// Instantiates the pipeline for the profile matching a DeviceInfo.type. Its
+// buffers come from `arena`, which must outlive the pipeline.
+std::unique_ptr<Pipeline> createPipeline(int deviceType, Arena& arena, Arithmetic arithmetic = Arithmetic::Float);
+
+// Arena bytes createPipeline() takes for deviceType.
+size_t workspaceBytesForType(int deviceType, Arithmetic arithmetic = Arithmetic::Float);
+
+// Profile name used for deviceType, without creating a pipeline.
+const char* profileNameForType(int deviceType);
+
+} // namespace live
+} // namespace brainmirror
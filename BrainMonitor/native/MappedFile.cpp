@@ -0,0 +1,214 @@
+#include "MappedFile.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace brainmirror {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#if defined(_WIN32)
+
+namespace {
+
+std::string lastError(const char* what) {
+    return std::string(what) + " failed (error " + std::to_string(GetLastError()) + ")";
+}
+
+} // namespace
+
+bool MappedFile::open(const std::filesystem::path& path, size_t minSize, std::string& error) {
+    close();
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        error = lastError("CreateFile");
+        return false;
+    }
+    m_file = file;
+
+    LARGE_INTEGER current{};
+    GetFileSizeEx(file, &current);
+    size_t size = static_cast<size_t>(current.QuadPart);
+    if (!map(size < minSize ? minSize : size, error)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::map(size_t size, std::string& error) {
+    HANDLE mapping = CreateFileMappingW(static_cast<HANDLE>(m_file), nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                        static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr);
+    if (!mapping) {
+        error = lastError("CreateFileMapping");
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!view) {
+        error = lastError("MapViewOfFile");
+        CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+    m_data = static_cast<uint8_t*>(view);
+    m_size = size;
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(static_cast<HANDLE>(m_mapping));
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_size = 0;
+}
+
+bool MappedFile::flush() {
+    return m_data && FlushViewOfFile(m_data, m_size) && FlushFileBuffers(static_cast<HANDLE>(m_file));
+}
+
+bool MappedFile::flush(size_t offset, size_t size) {
+    if (!m_data || offset >= m_size) return false;
+    size = std::min(size, m_size - offset);
+    return FlushViewOfFile(m_data + offset, size) && FlushFileBuffers(static_cast<HANDLE>(m_file));
+}
+
+bool MappedFile::reserve(std::string& error) {
+    // Extending the file for the mapping already allocated it
+    if (!m_data) {
+        error = "file is not open";
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    unmap();
+    if (m_file) CloseHandle(static_cast<HANDLE>(m_file));
+    m_file = nullptr;
+}
+
+#else
+
+namespace {
+
+std::string lastError(const char* what) {
+    return std::string(what) + " failed: " + std::strerror(errno);
+}
+
+} // namespace
+
+bool MappedFile::open(const std::filesystem::path& path, size_t minSize, std::string& error) {
+    close();
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = lastError("open");
+        return false;
+    }
+    m_fd = fd;
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        error = "file is in use by another process";
+        close();
+        return false;
+    }
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        error = lastError("fstat");
+        close();
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    if (!map(size < minSize ? minSize : size, error)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::map(size_t size, std::string& error) {
+    struct stat info {};
+    if (fstat(m_fd, &info) == 0 && static_cast<size_t>(info.st_size) < size &&
+        ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+        error = lastError("ftruncate");
+        return false;
+    }
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (view == MAP_FAILED) {
+        error = lastError("mmap");
+        return false;
+    }
+    m_data = static_cast<uint8_t*>(view);
+    m_size = size;
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (m_data) munmap(m_data, m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool MappedFile::flush() {
+    return m_data && msync(m_data, m_size, MS_SYNC) == 0;
+}
+
+bool MappedFile::flush(size_t offset, size_t size) {
+    if (!m_data || offset >= m_size) return false;
+    size = std::min(size, m_size - offset);
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t first = offset / page * page;
+    return msync(m_data + first, offset + size - first, MS_SYNC) == 0;
+}
+
+bool MappedFile::reserve(std::string& error) {
+    if (!m_data) {
+        error = "file is not open";
+        return false;
+    }
+#if defined(__APPLE__)
+    return true;
+#else
+    int result = posix_fallocate(m_fd, 0, static_cast<off_t>(m_size));
+    if (result != 0) {
+        error = std::string("posix_fallocate failed: ") + std::strerror(result);
+        return false;
+    }
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+    unmap();
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+}
+
+#endif
+
+bool MappedFile::resize(size_t size, std::string& error) {
+    if (!m_data) {
+        error = "file is not open";
+        return false;
+    }
+    if (size <= m_size) return true;
+    unmap();
+    return map(size, error);
+}
+
+} // namespace brainmirror
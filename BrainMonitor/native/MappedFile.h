@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace brainmirror {
+
+// Read-write memory mapping of a whole file that can grow. The file is
+// opened exclusively (share mode none on Windows, flock on POSIX) so two
+// processes never write the same mapping; open() fails with an error for
+// the second one.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Creates the file if needed and maps at least minSize bytes.
+    bool open(const std::filesystem::path& path, size_t minSize, std::string& error);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    // Grows the file and remaps it; pointers into the old mapping are invalid afterwards.
+    bool resize(size_t size, std::string& error);
+    // Writes dirty pages back to the file.
+    bool flush();
+    // Writes back only the pages covering [offset, offset + size).
+    bool flush(size_t offset, size_t size);
+    // Allocates disk blocks for the whole mapping up front, so writes into
+    // it never wait on the file system growing a sparse file.
+    bool reserve(std::string& error);
+
+    uint8_t* data() { return m_data; }
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#if defined(_WIN32)
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+
+    bool map(size_t size, std::string& error);
+    void unmap();
+};
+
+} // namespace brainmirror
@@ -0,0 +1,337 @@
+#include "Realtime.h"
+#include "ThreadAffinity.h"
+
+#include <algorithm>
+#include <chrono>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define BRAINMIRROR_CPU_RELAX() _mm_pause()
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BRAINMIRROR_CPU_RELAX() _mm_pause()
+#else
+#define BRAINMIRROR_CPU_RELAX() std::this_thread::yield()
+#endif
+
+namespace brainmirror {
+
+namespace {
+
+uint64_t steadyNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Settings generation already applied to the calling acquisition thread
+struct AppliedSettings {
+    const void* owner = nullptr;
+    uint32_t generation = 0;
+};
+thread_local AppliedSettings t_applied;
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// LatencyHistogram
+// ---------------------------------------------------------------------------
+
+int LatencyHistogram::bucketIndex(uint32_t us) {
+    if (us < SubBuckets) return static_cast<int>(us);
+    int exponent = 31;
+    while (!(us & (1u << exponent))) exponent--;
+    int sub = static_cast<int>((us >> (exponent - 3)) & (SubBuckets - 1));
+    return std::min(BucketCount - 1, SubBuckets + (exponent - 3) * SubBuckets + sub);
+}
+
+uint32_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < SubBuckets) return static_cast<uint32_t>(index);
+    int exponent = (index - SubBuckets) / SubBuckets + 3;
+    int sub = (index - SubBuckets) % SubBuckets;
+    uint64_t upper = ((static_cast<uint64_t>(SubBuckets + sub + 1)) << (exponent - 3)) - 1;
+    return static_cast<uint32_t>(std::min<uint64_t>(upper, UINT32_MAX));
+}
+
+void LatencyHistogram::record(uint32_t us, bool overBudget) {
+    m_buckets[bucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sumUs.fetch_add(us, std::memory_order_relaxed);
+    if (overBudget) m_exceeded.fetch_add(1, std::memory_order_relaxed);
+    uint32_t max = m_maxUs.load(std::memory_order_relaxed);
+    while (us > max && !m_maxUs.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snapshot;
+    uint64_t counts[BucketCount];
+    uint64_t total = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    snapshot.count = total;
+    snapshot.exceeded = m_exceeded.load(std::memory_order_relaxed);
+    snapshot.maxUs = m_maxUs.load(std::memory_order_relaxed);
+    if (total == 0) return snapshot;
+    snapshot.meanUs = static_cast<double>(m_sumUs.load(std::memory_order_relaxed)) /
+        static_cast<double>(m_count.load(std::memory_order_relaxed));
+
+    // Upper bound of the bucket holding the percentile, capped at the maximum
+    auto percentile = [&](double p) {
+        uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BucketCount; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(bucketUpperBound(i), snapshot.maxUs);
+        }
+        return snapshot.maxUs;
+    };
+    snapshot.p50Us = percentile(0.50);
+    snapshot.p90Us = percentile(0.90);
+    snapshot.p99Us = percentile(0.99);
+    snapshot.p999Us = percentile(0.999);
+    return snapshot;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sumUs.store(0, std::memory_order_relaxed);
+    m_exceeded.store(0, std::memory_order_relaxed);
+    m_maxUs.store(0, std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// RealtimeProcessor
+// ---------------------------------------------------------------------------
+
+RealtimeProcessor::RealtimeProcessor(Handler handler, void* user)
+    : m_handler(handler), m_user(user) {
+}
+
+RealtimeProcessor::~RealtimeProcessor() {
+    stop();
+}
+
+void RealtimeProcessor::setAlarmHandler(AlarmHandler handler, void* user) {
+    m_alarmUser.store(user, std::memory_order_relaxed);
+    m_alarm.store(handler, std::memory_order_release);
+}
+
+// Caller holds m_configMutex. Afterwards no dispatch() is running, new
+// ones wait, and the processing thread has drained the ring and exited.
+void RealtimeProcessor::quiesce() {
+    m_mode.store(Paused, std::memory_order_seq_cst);
+    while (m_dispatching.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+    }
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_stopThread.store(true);
+        }
+        m_wake.notify_one();
+        m_thread.join();
+        m_stopThread.store(false);
+    }
+}
+
+bool RealtimeProcessor::configure(const Options& options) {
+    std::lock_guard<std::mutex> lock(m_configMutex);
+    quiesce();
+
+    m_options = options;
+    m_options.priority = std::max(0, std::min(99, options.priority));
+    if (m_options.alarmIntervalMs == 0) m_options.alarmIntervalMs = 1000;
+    m_acquisitionCpuList = cpusFromMask(options.acquisitionCpus);
+    m_acquisitionPinned.store(options.acquisitionCpus ? 0 : -1);
+    m_acquisitionPriority.store(m_options.priority ? 0 : -1);
+    m_processingPinned.store(-1);
+    m_processingPriority.store(-1);
+    m_generation.fetch_add(1);
+
+    int mode = Inline;
+    if (options.offload) {
+        if (!m_ring) m_ring.reset(new Slot[RingSlots]);
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        m_processingPinned.store(options.processingCpus ? 0 : -1);
+        m_processingPriority.store(m_options.priority ? 0 : -1);
+        m_thread = std::thread(&RealtimeProcessor::processingLoop, this);
+        mode = Offload;
+    }
+    else if (options.latencyBudgetUs > 0 || options.acquisitionCpus || m_options.priority) {
+        mode = Monitored;
+    }
+    m_mode.store(mode, std::memory_order_seq_cst);
+    return true;
+}
+
+void RealtimeProcessor::stop() {
+    std::lock_guard<std::mutex> lock(m_configMutex);
+    quiesce();
+    m_options = Options();
+    m_generation.fetch_add(1);
+    m_acquisitionPinned.store(-1);
+    m_acquisitionPriority.store(-1);
+    m_processingPinned.store(-1);
+    m_processingPriority.store(-1);
+    m_mode.store(Inline, std::memory_order_seq_cst);
+}
+
+void RealtimeProcessor::applyAcquisitionSettings() {
+    uint32_t generation = m_generation.load(std::memory_order_acquire);
+    if (t_applied.owner == this && t_applied.generation == generation) return;
+    t_applied.owner = this;
+    t_applied.generation = generation;
+
+    // Written by configure() before the mode is published; the CPU list is
+    // prebuilt because this runs inside the callback's allocation-free scope
+    if (!m_acquisitionCpuList.empty()) {
+        m_acquisitionPinned.store(pinCurrentThread(m_acquisitionCpuList) ? 1 : 0);
+    }
+    if (m_options.priority) {
+        m_acquisitionPriority.store(setCurrentThreadPriority(m_options.priority) ? 1 : 0);
+    }
+}
+
+void RealtimeProcessor::dispatch(int dev, int chan, const int* data, int len) {
+    for (;;) {
+        m_dispatching.fetch_add(1, std::memory_order_seq_cst);
+        int mode = m_mode.load(std::memory_order_seq_cst);
+        if (mode != Paused) {
+            if (mode == Inline) {
+                m_handler(m_user, dev, chan, data, len);
+            }
+            else {
+                applyAcquisitionSettings();
+                uint64_t arrival = steadyNowNs();
+                if (mode == Offload) enqueue(dev, chan, data, len, arrival);
+                else process(dev, chan, data, len, arrival);
+            }
+            m_dispatching.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+        // configure() is switching modes. Block on its mutex rather than
+        // spin: at real-time priority a spinning thread can starve it.
+        m_dispatching.fetch_sub(1, std::memory_order_seq_cst);
+        std::lock_guard<std::mutex> lock(m_configMutex);
+    }
+}
+
+void RealtimeProcessor::enqueue(int dev, int chan, const int* data, int len, uint64_t arrivalNs) {
+    if (len <= 0) return;
+
+    while (m_producerLock.test_and_set(std::memory_order_acquire)) {
+        BRAINMIRROR_CPU_RELAX();
+    }
+    size_t head = m_head.load(std::memory_order_relaxed);
+    size_t slotsNeeded = static_cast<size_t>((len + MaxPacketSamples - 1) / MaxPacketSamples);
+    if (head + slotsNeeded - m_tail.load(std::memory_order_acquire) > RingSlots) {
+        m_producerLock.clear(std::memory_order_release);
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    for (int offset = 0; offset < len; offset += MaxPacketSamples) {
+        Slot& slot = m_ring[head++ & (RingSlots - 1)];
+        slot.arrivalNs = arrivalNs;
+        slot.dev = dev;
+        slot.chan = chan;
+        slot.len = std::min(MaxPacketSamples, len - offset);
+        std::copy(data + offset, data + offset + slot.len, slot.data);
+    }
+    m_head.store(head, std::memory_order_seq_cst);
+    m_producerLock.clear(std::memory_order_release);
+
+    // Pairs with the seq_cst m_sleeping store in processingLoop(): either the
+    // consumer sees the new head or this sees it sleeping. The lock closes
+    // the gap between its predicate check and the wait.
+    if (m_sleeping.load(std::memory_order_seq_cst)) {
+        { std::lock_guard<std::mutex> lock(m_wakeMutex); }
+        m_wake.notify_one();
+    }
+}
+
+void RealtimeProcessor::process(int dev, int chan, const int* data, int len, uint64_t arrivalNs) {
+    m_handler(m_user, dev, chan, data, len);
+
+    uint64_t now = steadyNowNs();
+    uint32_t latencyUs = static_cast<uint32_t>(std::min<uint64_t>((now - arrivalNs) / 1000, UINT32_MAX));
+    uint32_t budget = m_options.latencyBudgetUs;
+    bool over = budget > 0 && latencyUs > budget;
+    m_latency.record(latencyUs, over);
+    if (!over) return;
+
+    AlarmHandler alarm = m_alarm.load(std::memory_order_acquire);
+    uint64_t last = m_lastAlarmNs.load(std::memory_order_relaxed);
+    uint64_t interval = static_cast<uint64_t>(m_options.alarmIntervalMs) * 1000000ull;
+    if (alarm && (last == 0 || now - last >= interval) &&
+        m_lastAlarmNs.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        m_alarms.fetch_add(1, std::memory_order_relaxed);
+        alarm(m_alarmUser.load(std::memory_order_relaxed), dev, chan, latencyUs, budget);
+    }
+}
+
+void RealtimeProcessor::processingLoop() {
+    if (m_options.processingCpus) {
+        m_processingPinned.store(pinCurrentThread(cpusFromMask(m_options.processingCpus)) ? 1 : 0);
+    }
+    if (m_options.priority) {
+        m_processingPriority.store(setCurrentThreadPriority(m_options.priority) ? 1 : 0);
+    }
+
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    uint32_t spins = 0;
+    for (;;) {
+        size_t head = m_head.load(std::memory_order_acquire);
+        if (tail != head) {
+            const Slot& slot = m_ring[tail & (RingSlots - 1)];
+            process(slot.dev, slot.chan, slot.data, slot.len, slot.arrivalNs);
+            m_tail.store(++tail, std::memory_order_release);
+            continue;
+        }
+
+        // Ring empty; quiesce() only stops the thread once producers are done
+        if (m_stopThread.load(std::memory_order_acquire)) break;
+        if (m_options.busyPoll) {
+            // Yield now and then so an equal-priority thread sharing the CPU still runs
+            if (++spins % 1024 == 0) std::this_thread::yield();
+            else BRAINMIRROR_CPU_RELAX();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_sleeping.store(true, std::memory_order_seq_cst);
+        m_wake.wait_for(lock, std::chrono::milliseconds(50), [this, tail]() {
+            return m_head.load(std::memory_order_seq_cst) != tail || m_stopThread.load();
+        });
+        m_sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+RealtimeProcessor::Stats RealtimeProcessor::stats() const {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(m_configMutex);
+        stats.offload = m_options.offload;
+        stats.busyPoll = m_options.offload && m_options.busyPoll;
+    }
+    stats.acquisition.pinned = m_acquisitionPinned.load();
+    stats.acquisition.priority = m_acquisitionPriority.load();
+    stats.processing.pinned = m_processingPinned.load();
+    stats.processing.priority = m_processingPriority.load();
+    stats.latency = m_latency.snapshot();
+    stats.packets = stats.latency.count;
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.alarms = m_alarms.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void RealtimeProcessor::resetStats() {
+    m_latency.reset();
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_alarms.store(0, std::memory_order_relaxed);
+    m_lastAlarmNs.store(0, std::memory_order_relaxed);
+}
+
+} // namespace brainmirror
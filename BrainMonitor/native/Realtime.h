@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Real-time acquisition mode. Live processing of a raw packet normally runs
+// inline on the vendor's acquisition thread. With offloading enabled the
+// acquisition thread only copies the packet into a single-consumer ring and
+// returns to packet intake; a dedicated processing thread drains the ring.
+// Both threads can be pinned to chosen CPUs and raised to real-time
+// priority, and the processing thread can busy-poll the ring instead of
+// sleeping. Every processed packet's latency (arrival in the SDK callback ->
+// processing finished) goes into a histogram, and packets over the latency
+// budget raise a rate-limited alarm.
+namespace brainmirror {
+
+// Latency histogram in microseconds with 8 sub-buckets per power of two
+// (12.5% resolution). record() is lock-free and safe from several threads.
+class LatencyHistogram {
+public:
+    static constexpr int SubBuckets = 8;
+    static constexpr int BucketCount = SubBuckets + 29 * SubBuckets;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t exceeded = 0;
+        uint32_t maxUs = 0;
+        double meanUs = 0.0;
+        uint32_t p50Us = 0;
+        uint32_t p90Us = 0;
+        uint32_t p99Us = 0;
+        uint32_t p999Us = 0;
+    };
+
+    void record(uint32_t us, bool overBudget);
+    Snapshot snapshot() const;
+    void reset();
+
+    static int bucketIndex(uint32_t us);
+    static uint32_t bucketUpperBound(int index);
+
+private:
+    std::atomic<uint64_t> m_buckets[BucketCount] = {};
+    std::atomic<uint64_t> m_count{ 0 };
+    std::atomic<uint64_t> m_sumUs{ 0 };
+    std::atomic<uint64_t> m_exceeded{ 0 };
+    std::atomic<uint32_t> m_maxUs{ 0 };
+};
+
+class RealtimeProcessor {
+public:
+    static constexpr int MaxPacketSamples = 64;     // Longer packets take several slots
+    static constexpr size_t RingSlots = 1024;       // Power of two
+
+    // The processing step for one packet; runs on exactly one thread at a time.
+    using Handler = void (*)(void* user, int dev, int chan, const int* data, int len);
+    using AlarmHandler = void (*)(void* user, int dev, int chan, uint32_t latencyUs, uint32_t budgetUs);
+
+    struct Options {
+        bool offload = false;           // Process on a dedicated thread
+        bool busyPoll = false;          // Processing thread spins instead of sleeping
+        int priority = 0;               // 0: unchanged, 1-99: setCurrentThreadPriority
+        uint64_t acquisitionCpus = 0;   // CPU mask, 0: unchanged
+        uint64_t processingCpus = 0;
+        uint32_t latencyBudgetUs = 0;   // 0: no alarms; latency is recorded whenever any option is set
+        uint32_t alarmIntervalMs = 1000;
+    };
+
+    // -1: not requested, 0: refused by the platform, 1: applied
+    struct ThreadStatus {
+        int pinned = -1;
+        int priority = -1;
+    };
+
+    struct Stats {
+        bool offload = false;
+        bool busyPoll = false;
+        ThreadStatus acquisition;
+        ThreadStatus processing;
+        uint64_t packets = 0;           // Processed
+        uint64_t dropped = 0;           // Ring full
+        uint64_t alarms = 0;
+        LatencyHistogram::Snapshot latency;
+    };
+
+    RealtimeProcessor(Handler handler, void* user);
+    ~RealtimeProcessor();
+    RealtimeProcessor(const RealtimeProcessor&) = delete;
+    RealtimeProcessor& operator=(const RealtimeProcessor&) = delete;
+
+    // API thread. Waits for in-flight packets, drains the ring and restarts
+    // the processing thread as needed. The acquisition thread picks up its
+    // pinning and priority on its next packet.
+    bool configure(const Options& options);
+    // Back to inline processing with no monitoring.
+    void stop();
+
+    void setAlarmHandler(AlarmHandler handler, void* user);
+
+    // Acquisition thread. Never allocates; drops the packet when the ring is
+    // full. Blocks only while configure() switches modes.
+    void dispatch(int dev, int chan, const int* data, int len);
+
+    Stats stats() const;
+    void resetStats();
+
+private:
+    enum Mode : int { Inline, Monitored, Offload, Paused };
+
+    struct Slot {
+        uint64_t arrivalNs;
+        int dev;
+        int chan;
+        int len;
+        int data[MaxPacketSamples];
+    };
+
+    Handler m_handler;
+    void* m_user;
+    mutable std::mutex m_configMutex;   // configure() / stop(); guards m_options writes
+    Options m_options;
+    std::vector<int> m_acquisitionCpuList;
+
+    std::atomic<int> m_mode{ Inline };
+    std::atomic<int> m_dispatching{ 0 };
+    std::atomic<uint32_t> m_generation{ 1 };
+    std::atomic<int> m_acquisitionPinned{ -1 };
+    std::atomic<int> m_acquisitionPriority{ -1 };
+    std::atomic<int> m_processingPinned{ -1 };
+    std::atomic<int> m_processingPriority{ -1 };
+
+    std::unique_ptr<Slot[]> m_ring;
+    alignas(64) std::atomic<size_t> m_head{ 0 };    // Next slot to write
+    alignas(64) std::atomic<size_t> m_tail{ 0 };    // Next slot to process
+    alignas(64) std::atomic_flag m_producerLock = ATOMIC_FLAG_INIT;
+
+    std::thread m_thread;
+    std::atomic<bool> m_stopThread{ false };
+    std::atomic<bool> m_sleeping{ false };
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+
+    std::atomic<AlarmHandler> m_alarm{ nullptr };
+    std::atomic<void*> m_alarmUser{ nullptr };
+    std::atomic<uint64_t> m_lastAlarmNs{ 0 };
+    std::atomic<uint64_t> m_alarms{ 0 };
+    std::atomic<uint64_t> m_dropped{ 0 };
+    LatencyHistogram m_latency;
+
+    void applyAcquisitionSettings();
+    void enqueue(int dev, int chan, const int* data, int len, uint64_t arrivalNs);
+    void process(int dev, int chan, const int* data, int len, uint64_t arrivalNs);
+    void processingLoop();
+    void quiesce();
+};
+
+} // namespace brainmirror
@@ -0,0 +1,255 @@
+#include "RecordingReader.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+namespace brainmirror {
+
+namespace {
+
+constexpr size_t kEdfFixedHeader = 256;
+constexpr size_t kEdfSignalHeader = 256;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+void trim(const char*& begin, const char*& end) {
+    while (begin < end && isSpace(*begin)) ++begin;
+    while (end > begin && isSpace(*(end - 1))) --end;
+}
+
+bool parseDouble(const char* begin, const char* end, double& value) {
+    trim(begin, end);
+    if (begin < end && *begin == '+') ++begin;
+    if (begin == end) return false;
+    auto result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+bool parseInt(const char* begin, const char* end, int& value) {
+    trim(begin, end);
+    if (begin < end && *begin == '+') ++begin;
+    if (begin == end) return false;
+    auto result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+std::string field(const char* data, size_t offset, size_t length) {
+    const char* begin = data + offset;
+    const char* end = begin + length;
+    trim(begin, end);
+    return std::string(begin, end);
+}
+
+bool parseCsv(const char* data, size_t size, Recording& out, std::string& error) {
+    const char* cursor = data;
+    const char* end = data + size;
+
+    // File.WriteAllLines(..., Encoding.UTF8) prefixes a BOM
+    if (size >= 3 && static_cast<unsigned char>(data[0]) == 0xEF &&
+        static_cast<unsigned char>(data[1]) == 0xBB && static_cast<unsigned char>(data[2]) == 0xBF) {
+        cursor += 3;
+    }
+
+    out.samples.reserve(size / 6);
+    while (cursor < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        if (!lineEnd) lineEnd = end;
+
+        // Only the first column carries the sample
+        const char* fieldEnd = static_cast<const char*>(std::memchr(cursor, ',', lineEnd - cursor));
+        if (!fieldEnd) fieldEnd = lineEnd;
+
+        const char* begin = cursor;
+        const char* stop = fieldEnd;
+        trim(begin, stop);
+        if (begin != stop) {
+            double value = 0.0;
+            if (parseDouble(begin, stop, value)) {
+                out.samples.push_back(value);
+            }
+            else {
+                out.skippedLines++;
+            }
+        }
+        cursor = lineEnd + 1;
+    }
+
+    if (out.samples.empty()) {
+        error = "no numeric samples in CSV";
+        return false;
+    }
+    return true;
+}
+
+bool parseEdf(const char* data, size_t size, Recording& out, std::string& error) {
+    if (size < kEdfFixedHeader) {
+        error = "EDF header truncated";
+        return false;
+    }
+    if (std::memcmp(data, "0       ", 8) != 0) {
+        error = "EDF version field is not 0";
+        return false;
+    }
+
+    int declaredHeaderBytes = 0;
+    int declaredRecords = 0;
+    double duration = 0.0;
+    int signalCount = 0;
+    if (!parseInt(data + 184, data + 192, declaredHeaderBytes) ||
+        !parseInt(data + 236, data + 244, declaredRecords) ||
+        !parseDouble(data + 244, data + 252, duration) ||
+        !parseInt(data + 252, data + 256, signalCount)) {
+        error = "EDF header has malformed numeric fields";
+        return false;
+    }
+    if (signalCount <= 0 || signalCount > 512) {
+        error = "EDF signal count out of range";
+        return false;
+    }
+
+    // EDFWriter declares 256 header bytes even though it writes one signal
+    // header, so the layout is derived from the signal count instead.
+    size_t headerBytes = kEdfFixedHeader + kEdfSignalHeader * static_cast<size_t>(signalCount);
+    if (size < headerBytes) {
+        error = "EDF signal headers truncated";
+        return false;
+    }
+    if (declaredHeaderBytes != static_cast<int>(headerBytes)) {
+        out.warnings.push_back("header byte count field does not match signal count");
+    }
+
+    const size_t ns = static_cast<size_t>(signalCount);
+    const char* signals = data + kEdfFixedHeader;
+    auto signalField = [&](size_t fieldOffset, size_t width, size_t index) {
+        return signals + fieldOffset * ns + width * index;
+    };
+
+    // Field offsets inside the signal header block, each multiplied by ns
+    const size_t labelOff = 0, physMinOff = 104, physMaxOff = 112, digMinOff = 120, digMaxOff = 128, samplesOff = 216;
+
+    double physMin = 0, physMax = 0;
+    int digMin = 0, digMax = 0;
+    if (!parseDouble(signalField(physMinOff, 8, 0), signalField(physMinOff, 8, 0) + 8, physMin) ||
+        !parseDouble(signalField(physMaxOff, 8, 0), signalField(physMaxOff, 8, 0) + 8, physMax) ||
+        !parseInt(signalField(digMinOff, 8, 0), signalField(digMinOff, 8, 0) + 8, digMin) ||
+        !parseInt(signalField(digMaxOff, 8, 0), signalField(digMaxOff, 8, 0) + 8, digMax) ||
+        digMax == digMin) {
+        error = "EDF signal scaling fields are invalid";
+        return false;
+    }
+
+    size_t samplesPerRecordTotal = 0;
+    int firstSignalSamples = 0;
+    for (size_t i = 0; i < ns; ++i) {
+        int samples = 0;
+        const char* f = signalField(samplesOff, 8, i);
+        if (!parseInt(f, f + 8, samples) || samples <= 0) {
+            error = "EDF samples-per-record field is invalid";
+            return false;
+        }
+        if (i == 0) firstSignalSamples = samples;
+        samplesPerRecordTotal += static_cast<size_t>(samples);
+    }
+
+    size_t recordBytes = samplesPerRecordTotal * 2;
+    size_t dataBytes = size - headerBytes;
+    size_t availableRecords = dataBytes / recordBytes;
+    if (dataBytes % recordBytes != 0) {
+        out.warnings.push_back("trailing partial data record ignored");
+    }
+
+    size_t records = availableRecords;
+    if (declaredRecords < 0) {
+        out.warnings.push_back("data record count not finalized");
+    }
+    else if (static_cast<size_t>(declaredRecords) != availableRecords) {
+        out.warnings.push_back("data record count does not match file size");
+        records = std::min(records, static_cast<size_t>(declaredRecords));
+    }
+    if (records == 0) {
+        error = "EDF contains no data records";
+        return false;
+    }
+
+    out.signalCount = signalCount;
+    out.dataRecords = static_cast<int>(records);
+    out.recordDuration = duration;
+    out.signalLabel = field(signals, labelOff, 16);
+
+    const double scale = (physMax - physMin) / static_cast<double>(digMax - digMin);
+    out.samples.resize(records * static_cast<size_t>(firstSignalSamples));
+    const unsigned char* body = reinterpret_cast<const unsigned char*>(data + headerBytes);
+    size_t index = 0;
+    for (size_t r = 0; r < records; ++r) {
+        const unsigned char* record = body + r * recordBytes;
+        for (int s = 0; s < firstSignalSamples; ++s) {
+            int16_t digital = static_cast<int16_t>(record[2 * s] | (record[2 * s + 1] << 8));
+            out.samples[index++] = physMin + (static_cast<double>(digital) - digMin) * scale;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+RecordingFormat formatFromPath(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return RecordingFormat::Unknown;
+
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) {
+        return static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+    });
+    if (ext == "csv") return RecordingFormat::Csv;
+    if (ext == "edf") return RecordingFormat::Edf;
+    return RecordingFormat::Unknown;
+}
+
+const char* formatName(RecordingFormat format) {
+    switch (format) {
+    case RecordingFormat::Csv: return "csv";
+    case RecordingFormat::Edf: return "edf";
+    default: return "unknown";
+    }
+}
+
+bool parseRecording(const char* data, size_t size, RecordingFormat hint, Recording& out, std::string& error) {
+    // Keep the sample buffer's capacity so callers can reuse one Recording
+    std::vector<double> samples = std::move(out.samples);
+    samples.clear();
+    out = Recording();
+    out.samples = std::move(samples);
+
+    if (!data || size == 0) {
+        error = "file is empty";
+        return false;
+    }
+
+    RecordingFormat format = hint;
+    if (format == RecordingFormat::Unknown) {
+        format = (size >= 8 && std::memcmp(data, "0       ", 8) == 0) ? RecordingFormat::Edf : RecordingFormat::Csv;
+    }
+
+    out.format = format;
+    return format == RecordingFormat::Edf ? parseEdf(data, size, out, error) : parseCsv(data, size, out, error);
+}
+
+bool readWholeFile(const std::filesystem::path& path, std::vector<char>& buffer) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+
+    std::streamoff length = file.tellg();
+    if (length < 0) return false;
+    file.seekg(0);
+
+    buffer.resize(static_cast<size_t>(length));
+    return length == 0 || static_cast<bool>(file.read(buffer.data(), length));
+}
+
+} // namespace brainmirror
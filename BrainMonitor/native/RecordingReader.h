@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace brainmirror {
+
+enum class RecordingFormat {
+    Unknown = 0,
+    Csv,
+    Edf,
+};
+
+// Parsed single-channel recording as written by TestProcessPage:
+// CSV is one "F2" value per line, EDF comes from Services/EDFWriter.cs.
+struct Recording {
+    RecordingFormat format = RecordingFormat::Unknown;
+    std::vector<double> samples;
+
+    // EDF header fields (zero for CSV)
+    int signalCount = 0;
+    int dataRecords = 0;
+    double recordDuration = 0.0;
+    std::string signalLabel;
+
+    size_t skippedLines = 0;            // CSV lines that did not parse as a number
+    std::vector<std::string> warnings;  // Recoverable header inconsistencies
+};
+
+// Parses an in-memory file. Returns false and sets error when the content is
+// not a usable recording; warnings are collected for recoverable issues.
+bool parseRecording(const char* data, size_t size, RecordingFormat hint, Recording& out, std::string& error);
+
+// Picks the format from the file extension (".csv" / ".edf").
+RecordingFormat formatFromPath(const std::string& path);
+
+// Reads a whole file into buffer, reusing its capacity.
+bool readWholeFile(const std::filesystem::path& path, std::vector<char>& buffer);
+
+const char* formatName(RecordingFormat format);
+
+} // namespace brainmirror
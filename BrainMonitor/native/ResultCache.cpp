@@ -0,0 +1,423 @@
+#include "ResultCache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace brainmirror {
+
+namespace {
+
+constexpr char kMagic[8] = { 'B', 'M', 'R', 'C', 'A', 'C', 'H', 'E' };
+constexpr uint32_t kLayoutVersion = 1;
+constexpr uint64_t kInitialCapacity = 1024;    // Power of two
+constexpr uint32_t kEmpty = 0;
+constexpr uint32_t kFilled = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t layoutVersion;
+    uint32_t entrySize;
+    uint32_t pipelineVersion;
+    uint32_t paramsHash;
+    uint64_t capacity;
+    uint64_t count;
+    uint32_t rebuilding;    // Set while grow() rewrites the table
+    uint8_t reserved[20];
+};
+static_assert(sizeof(FileHeader) == 64, "cache header layout");
+
+struct Entry {
+    uint64_t contentHash;
+    uint64_t contentSize;
+    uint32_t pipelineVersion;
+    uint32_t paramsHash;
+    uint32_t state;
+    uint32_t checksum;      // Over everything after this field; detects torn writes
+    int32_t format;
+    uint32_t success;
+    double theta;
+    double alpha;
+    double beta;
+    double finalIndex;
+    double mean;
+    double stdDeviation;
+    uint64_t sampleCount;
+    uint64_t clippedCount;
+    uint64_t skippedLines;
+    uint32_t warnings;
+    uint32_t parsed;
+    char error[72];
+    float psd[CachedPsdBins];
+};
+static_assert(sizeof(Entry) == 512, "cache entry layout");
+
+constexpr size_t kChecksumOffset = offsetof(Entry, format);
+
+uint32_t entryChecksum(const Entry& entry) {
+    uint64_t hash = contentHash64(reinterpret_cast<const uint8_t*>(&entry) + kChecksumOffset,
+                                  sizeof(Entry) - kChecksumOffset, entry.contentHash ^ entry.contentSize);
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+bool sameKey(const Entry& entry, const CacheKey& key) {
+    return entry.contentHash == key.contentHash && entry.contentSize == key.contentSize &&
+           entry.pipelineVersion == key.pipelineVersion && entry.paramsHash == key.paramsHash;
+}
+
+FileHeader* header(MappedFile& file) {
+    return reinterpret_cast<FileHeader*>(file.data());
+}
+
+Entry* slots(MappedFile& file) {
+    return reinterpret_cast<Entry*>(file.data() + sizeof(FileHeader));
+}
+
+size_t fileSizeFor(uint64_t capacity) {
+    return sizeof(FileHeader) + static_cast<size_t>(capacity) * sizeof(Entry);
+}
+
+// Linear probe: the matching slot, else the first empty one, else nullptr.
+Entry* probe(Entry* table, uint64_t capacity, const CacheKey& key) {
+    uint64_t mask = capacity - 1;
+    for (uint64_t i = 0; i < capacity; ++i) {
+        Entry& entry = table[(key.contentHash + i) & mask];
+        if (entry.state == kEmpty) return &entry;
+        if (sameKey(entry, key)) return &entry;
+    }
+    return nullptr;
+}
+
+constexpr uint64_t P1 = 11400714785074694791ull;
+constexpr uint64_t P2 = 14029467366897019727ull;
+constexpr uint64_t P3 = 1609587929392839161ull;
+constexpr uint64_t P4 = 9650029242287828579ull;
+constexpr uint64_t P5 = 2870177450012600261ull;
+
+inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t round64(uint64_t acc, uint64_t input) {
+    acc += input * P2;
+    acc = rotl(acc, 31);
+    return acc * P1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t value) {
+    acc ^= round64(0, value);
+    return acc * P1 + P4;
+}
+
+} // namespace
+
+uint64_t contentHash64(const void* data, size_t size, uint64_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint64_t h;
+
+    if (size >= 32) {
+        uint64_t v1 = seed + P1 + P2;
+        uint64_t v2 = seed + P2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - P1;
+        const uint8_t* limit = end - 32;
+        do {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    }
+    else {
+        h = seed + P5;
+    }
+
+    h += static_cast<uint64_t>(size);
+    for (; p + 8 <= end; p += 8) {
+        h ^= round64(0, read64(p));
+        h = rotl(h, 27) * P1 + P4;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * P1;
+        h = rotl(h, 23) * P2 + P3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= static_cast<uint64_t>(*p) * P5;
+        h = rotl(h, 11) * P1;
+    }
+
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint32_t analysisParamsHash() {
+    const double params[] = {
+        analysis::SamplingRate, analysis::FrequencyResolution, analysis::OutlierLimit,
+        analysis::ThetaLowFreq, analysis::ThetaHighFreq,
+        analysis::AlphaLowFreq, analysis::AlphaHighFreq,
+        analysis::BetaLowFreq, analysis::BetaHighFreq,
+        static_cast<double>(CachedPsdBins), CachedPsdBinHz,
+    };
+    uint64_t hash = contentHash64(params, sizeof(params));
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+CacheKey makeCacheKey(const char* data, size_t size, RecordingFormat hint) {
+    CacheKey key;
+    key.contentHash = contentHash64(data, size);
+    key.contentSize = size;
+    key.pipelineVersion = analysis::PipelineVersion;
+    key.paramsHash = analysisParamsHash() ^ (static_cast<uint32_t>(hint) * 0x9E3779B1u);
+    return key;
+}
+
+void summarizeSpectrum(const std::vector<double>& relative, float* psd) {
+    const size_t perBin = static_cast<size_t>(CachedPsdBinHz / analysis::FrequencyResolution + 0.5);
+    const size_t count = std::min(relative.size(), perBin * CachedPsdBins);
+    std::fill(psd, psd + CachedPsdBins, 0.0f);
+    for (size_t i = 0; i < count; ++i) {
+        psd[i / perBin] += static_cast<float>(relative[i]);
+    }
+}
+
+ResultCache::~ResultCache() {
+    close();
+}
+
+bool ResultCache::open(const std::filesystem::path& path, std::string& error) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_file.close();
+    m_hits = 0;
+    m_misses = 0;
+
+    if (!m_file.open(path, fileSizeFor(kInitialCapacity), error)) return false;
+
+    const FileHeader* h = header(m_file);
+    bool valid = std::memcmp(h->magic, kMagic, sizeof(kMagic)) == 0 &&
+                 h->layoutVersion == kLayoutVersion && h->entrySize == sizeof(Entry) &&
+                 h->pipelineVersion == static_cast<uint32_t>(analysis::PipelineVersion) &&
+                 h->paramsHash == analysisParamsHash() && !h->rebuilding &&
+                 h->capacity >= kInitialCapacity && (h->capacity & (h->capacity - 1)) == 0 &&
+                 m_file.size() >= fileSizeFor(h->capacity);
+    if (valid) return true;
+
+    if (!initialize(kInitialCapacity, error)) {
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+bool ResultCache::initialize(uint64_t capacity, std::string& error) {
+    if (m_file.size() < fileSizeFor(capacity) && !m_file.resize(fileSizeFor(capacity), error)) return false;
+    std::memset(m_file.data(), 0, fileSizeFor(capacity));
+    FileHeader* h = header(m_file);
+    std::memcpy(h->magic, kMagic, sizeof(kMagic));
+    h->layoutVersion = kLayoutVersion;
+    h->entrySize = sizeof(Entry);
+    h->pipelineVersion = static_cast<uint32_t>(analysis::PipelineVersion);
+    h->paramsHash = analysisParamsHash();
+    h->capacity = capacity;
+    h->count = 0;
+    return true;
+}
+
+void ResultCache::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_file.isOpen()) m_file.flush();
+    m_file.close();
+}
+
+bool ResultCache::isOpen() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_file.isOpen();
+}
+
+bool ResultCache::lookup(const CacheKey& key, CachedAnalysis& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file.isOpen()) return false;
+
+    const Entry* entry = probe(slots(m_file), header(m_file)->capacity, key);
+    if (!entry || entry->state != kFilled || entryChecksum(*entry) != entry->checksum) {
+        m_misses++;
+        return false;
+    }
+
+    out.format = static_cast<RecordingFormat>(entry->format);
+    out.parsed = entry->parsed != 0;
+    out.result.success = entry->success != 0;
+    out.result.errorMessage.assign(entry->error, strnlen(entry->error, sizeof(entry->error)));
+    out.result.thetaValue = entry->theta;
+    out.result.alphaValue = entry->alpha;
+    out.result.betaValue = entry->beta;
+    out.result.brainwaveFinalIndex = entry->finalIndex;
+    out.result.sampleCount = static_cast<size_t>(entry->sampleCount);
+    out.result.clippedCount = static_cast<size_t>(entry->clippedCount);
+    out.result.meanValue = entry->mean;
+    out.result.stdDeviation = entry->stdDeviation;
+    out.warnings = entry->warnings;
+    out.skippedLines = static_cast<size_t>(entry->skippedLines);
+    std::memcpy(out.psd, entry->psd, sizeof(out.psd));
+    m_hits++;
+    return true;
+}
+
+bool ResultCache::store(const CacheKey& key, const CachedAnalysis& value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file.isOpen()) return false;
+
+    FileHeader* h = header(m_file);
+    std::string error;
+    if ((h->count + 1) * 10 > h->capacity * 7) {
+        if (!grow(error)) return false;
+        h = header(m_file);
+    }
+
+    Entry* slot = probe(slots(m_file), h->capacity, key);
+    if (!slot) return false;
+
+    Entry entry{};
+    entry.contentHash = key.contentHash;
+    entry.contentSize = key.contentSize;
+    entry.pipelineVersion = key.pipelineVersion;
+    entry.paramsHash = key.paramsHash;
+    entry.state = kFilled;
+    entry.format = static_cast<int32_t>(value.format);
+    entry.success = value.result.success ? 1 : 0;
+    entry.parsed = value.parsed ? 1 : 0;
+    entry.theta = value.result.thetaValue;
+    entry.alpha = value.result.alphaValue;
+    entry.beta = value.result.betaValue;
+    entry.finalIndex = value.result.brainwaveFinalIndex;
+    entry.mean = value.result.meanValue;
+    entry.stdDeviation = value.result.stdDeviation;
+    entry.sampleCount = value.result.sampleCount;
+    entry.clippedCount = value.result.clippedCount;
+    entry.skippedLines = value.skippedLines;
+    entry.warnings = static_cast<uint32_t>(value.warnings);
+    std::strncpy(entry.error, value.result.errorMessage.c_str(), sizeof(entry.error) - 1);
+    std::memcpy(entry.psd, value.psd, sizeof(entry.psd));
+    entry.checksum = entryChecksum(entry);
+
+    bool isNew = slot->state == kEmpty;
+    // Payload first, state last: a crash in between leaves an empty slot or
+    // an entry whose checksum no longer matches, never a wrong result.
+    std::memcpy(reinterpret_cast<uint8_t*>(slot) + offsetof(Entry, checksum),
+                reinterpret_cast<const uint8_t*>(&entry) + offsetof(Entry, checksum),
+                sizeof(Entry) - offsetof(Entry, checksum));
+    std::memcpy(slot, &entry, offsetof(Entry, state));
+    slot->state = kFilled;
+    if (isNew) h->count++;
+    return true;
+}
+
+bool ResultCache::grow(std::string& error) {
+    uint64_t capacity = header(m_file)->capacity;
+    const Entry* table = slots(m_file);
+    std::vector<Entry> live;
+    live.reserve(static_cast<size_t>(header(m_file)->count));
+    for (uint64_t i = 0; i < capacity; ++i) {
+        if (table[i].state == kFilled && entryChecksum(table[i]) == table[i].checksum) {
+            live.push_back(table[i]);
+        }
+    }
+
+    header(m_file)->rebuilding = 1;
+    if (!m_file.resize(fileSizeFor(capacity * 2), error)) {
+        // Mapping is gone; the cache stays closed until reopened.
+        m_file.close();
+        return false;
+    }
+    if (!initialize(capacity * 2, error)) return false;
+
+    FileHeader* h = header(m_file);
+    h->rebuilding = 1;
+    Entry* newTable = slots(m_file);
+    for (const Entry& entry : live) {
+        CacheKey key{ entry.contentHash, entry.contentSize, entry.pipelineVersion, entry.paramsHash };
+        Entry* slot = probe(newTable, h->capacity, key);
+        if (slot && slot->state == kEmpty) {
+            *slot = entry;
+            h->count++;
+        }
+    }
+    h->rebuilding = 0;
+    return true;
+}
+
+void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file.isOpen()) return;
+    std::string error;
+    initialize(header(m_file)->capacity, error);
+}
+
+bool ResultCache::flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_file.isOpen() && m_file.flush();
+}
+
+ResultCache::Stats ResultCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    if (m_file.isOpen()) {
+        const auto* h = reinterpret_cast<const FileHeader*>(m_file.data());
+        stats.entries = h->count;
+        stats.capacity = h->capacity;
+        stats.fileBytes = m_file.size();
+    }
+    return stats;
+}
+
+bool analyzeRecordingCached(ResultCache* cache, const char* data, size_t size, RecordingFormat hint,
+                            Recording& recording, BrainwaveAnalyzer& analyzer, CachedAnalysis& out) {
+    CacheKey key = makeCacheKey(data, size, hint);
+    if (cache && cache->lookup(key, out)) return true;
+
+    out = CachedAnalysis();
+    out.format = hint;
+    std::string error;
+    if (!parseRecording(data, size, hint, recording, error)) {
+        out.result.errorMessage = error;
+    }
+    else {
+        out.parsed = true;
+        out.format = recording.format;
+        out.warnings = recording.warnings.size();
+        out.skippedLines = recording.skippedLines;
+        out.result = analyzer.processClosedEyesData(recording.samples);
+        if (out.result.success) summarizeSpectrum(analyzer.relativePowerSpectrum(), out.psd);
+    }
+
+    if (cache) cache->store(key, out);
+    return false;
+}
+
+} // namespace brainmirror
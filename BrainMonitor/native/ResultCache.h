@@ -0,0 +1,97 @@
+#pragma once
+
+#include "BrainwaveAnalysis.h"
+#include "MappedFile.h"
+#include "RecordingReader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+
+// Content-addressed cache of analysis results. A recording is identified by
+// a 64-bit hash of its bytes plus its size, and a result is only reused when
+// the pipeline version and the analysis parameters it was computed with
+// still match. Results live in a memory-mapped open-addressing table of
+// fixed 512-byte entries, so reopening history or re-running a report costs
+// one file read and hash per recording instead of parse + filter + FFT.
+namespace brainmirror {
+
+// Relative power spectrum kept per entry: 0.5 Hz bins from 0 to 40 Hz
+// (percent of 3-30 Hz power, summed over the 0.1 Hz analysis indices).
+constexpr int CachedPsdBins = 80;
+constexpr double CachedPsdBinHz = 0.5;
+
+struct CacheKey {
+    uint64_t contentHash = 0;
+    uint64_t contentSize = 0;
+    uint32_t pipelineVersion = 0;
+    uint32_t paramsHash = 0;    // analysisParamsHash() mixed with the format hint
+};
+
+struct CachedAnalysis {
+    RecordingFormat format = RecordingFormat::Unknown;
+    bool parsed = false;        // false: not a usable recording, result.errorMessage says why
+    BrainwaveResult result;     // errorMessage is truncated to 71 bytes in the cache
+    size_t warnings = 0;
+    size_t skippedLines = 0;
+    float psd[CachedPsdBins] = {};
+};
+
+// XXH64 of data, ~10x faster than byte-wise FNV on large recordings.
+uint64_t contentHash64(const void* data, size_t size, uint64_t seed = 0);
+
+// Hash of every constant that changes analysis output (rate, resolution,
+// band edges, outlier limit, PSD layout).
+uint32_t analysisParamsHash();
+
+CacheKey makeCacheKey(const char* data, size_t size, RecordingFormat hint);
+
+// Sums the analyzer's relative spectrum into CachedPsdBins bins.
+void summarizeSpectrum(const std::vector<double>& relative, float* psd);
+
+class ResultCache {
+public:
+    struct Stats {
+        uint64_t entries = 0;
+        uint64_t capacity = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t fileBytes = 0;
+    };
+
+    ResultCache() = default;
+    ~ResultCache();
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    // Opens or creates the cache file. A file written by another pipeline
+    // version or parameter set, or left mid-rehash by a crash, is cleared.
+    bool open(const std::filesystem::path& path, std::string& error);
+    void close();
+    bool isOpen() const;
+
+    bool lookup(const CacheKey& key, CachedAnalysis& out);
+    bool store(const CacheKey& key, const CachedAnalysis& value);
+    void clear();
+    bool flush();
+
+    Stats stats() const;
+
+private:
+    mutable std::mutex m_mutex;
+    MappedFile m_file;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+
+    bool initialize(uint64_t capacity, std::string& error);
+    bool grow(std::string& error);
+};
+
+// Parses and analyzes a recording, consulting the cache first when one is
+// given. Returns true when the result came from the cache.
+bool analyzeRecordingCached(ResultCache* cache, const char* data, size_t size, RecordingFormat hint,
+                            Recording& recording, BrainwaveAnalyzer& analyzer, CachedAnalysis& out);
+
+} // namespace brainmirror
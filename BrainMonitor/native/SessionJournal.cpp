@@ -0,0 +1,445 @@
+#include "SessionJournal.h"
+
+#include "ResultCache.h"
+#include "SessionRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace brainmirror {
+
+namespace {
+
+constexpr char kMagic[8] = { 'B', 'M', 'J', 'O', 'U', 'R', 'N', 'L' };
+constexpr uint32_t kLayoutVersion = 2;
+constexpr size_t kDataOffset = 4096;        // Records start on their own page
+constexpr size_t kGranularity = 64 * 1024;
+
+enum RecordType : uint8_t {
+    Record_Samples = 1,     // Payload: int32 samples of (dev, chan)
+    Record_Marker = 2,      // Payload: MarkerPayload + MarkerEntry[count]
+    Record_End = 3,
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t layoutVersion;
+    uint32_t dataOffset;
+    uint64_t sessionSalt;
+    uint64_t startUnixMs;
+    uint32_t streams;
+    uint32_t samplesPerStream;
+    uint64_t durableOffset;     // Checkpoint: records below this offset are on disk
+    uint64_t checkpoints;
+    uint32_t epoch;
+    uint32_t checksum;          // Of everything above
+};
+static_assert(sizeof(FileHeader) == 64, "journal header layout");
+
+// Records are 4-byte aligned. The checksum covers the rest of the header
+// and the payload, seeded with the session salt, so records left over from
+// an earlier session never validate.
+struct RecordHeader {
+    uint32_t checksum;
+    uint32_t size;              // Payload bytes, a multiple of 4
+    uint32_t sequence;          // Consecutive from 0 within a session
+    uint32_t epoch;             // Recovery count when written; never decreases
+    uint8_t type;
+    uint8_t dev;
+    uint8_t chan;
+    uint8_t reserved;
+};
+static_assert(sizeof(RecordHeader) == 20, "journal record layout");
+
+struct MarkerPayload {
+    char label[SessionRecorder::MaxLabel];
+    uint32_t count;
+};
+
+struct MarkerEntry {
+    uint8_t dev;
+    uint8_t chan;
+    uint16_t reserved;
+    uint32_t position;
+};
+
+constexpr int kMaxStreams = SessionRecorder::MaxDevices * SessionRecorder::MaxChannels;
+constexpr size_t kMaxMarkerRecord = sizeof(RecordHeader) + sizeof(MarkerPayload) + kMaxStreams * sizeof(MarkerEntry);
+
+uint32_t headerChecksum(const FileHeader& header) {
+    return static_cast<uint32_t>(contentHash64(&header, offsetof(FileHeader, checksum)));
+}
+
+uint32_t recordChecksum(const uint8_t* record, size_t size, uint64_t salt) {
+    return static_cast<uint32_t>(contentHash64(record + sizeof(uint32_t), sizeof(RecordHeader) - sizeof(uint32_t) + size, salt));
+}
+
+uint64_t unixNowMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// Worst case for packets of 8 samples or more, plus every marker
+size_t journalCapacity(int streams, size_t samplesPerStream) {
+    size_t samples = static_cast<size_t>(streams) * samplesPerStream;
+    size_t bytes = kDataOffset + samples * (8 * sizeof(int32_t) + sizeof(RecordHeader)) / 8
+        + SessionRecorder::MaxMarkers * kMaxMarkerRecord + sizeof(RecordHeader) + kGranularity;
+    return (bytes + kGranularity - 1) / kGranularity * kGranularity;
+}
+
+} // namespace
+
+SessionJournal::~SessionJournal() {
+    close();
+}
+
+bool SessionJournal::open(const std::filesystem::path& path, int flushIntervalMs, std::string& error) {
+    close();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file.open(path, kDataOffset, error)) return false;
+    m_flushIntervalMs = std::max(flushIntervalMs > 0 ? flushIntervalMs : 200, 10);
+    m_sessionSalt = 0;
+    m_capacity.store(m_file.size());
+    m_written.store(0);
+    m_durable.store(0);
+    m_records.store(0);
+    m_dropped.store(0);
+    m_checkpoints.store(0);
+    m_stopFlusher = false;
+    m_flushRequested = false;
+    m_flusher = std::thread(&SessionJournal::flusherLoop, this);
+    return true;
+}
+
+void SessionJournal::close() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopFlusher = true;
+    }
+    m_flushWake.notify_one();
+    if (m_flusher.joinable()) m_flusher.join();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    deactivate();
+    if (m_file.isOpen()) checkpointLocked();
+    m_file.close();
+    m_sessionSalt = 0;
+    m_capacity.store(0);
+}
+
+bool SessionJournal::isOpen() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_file.isOpen();
+}
+
+// Once this returns no writer is inside writeRecord() and none will start
+void SessionJournal::deactivate() {
+    m_active.store(false);
+    while (m_writeLock.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    m_writeLock.clear(std::memory_order_release);
+}
+
+bool SessionJournal::beginSession(int streams, size_t samplesPerStream, std::string& error) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file.isOpen()) {
+        error = "journal is not open";
+        return false;
+    }
+    deactivate();
+
+    size_t capacity = journalCapacity(streams, samplesPerStream);
+    if (!m_file.resize(capacity, error) || !m_file.reserve(error)) return false;
+    m_capacity.store(m_file.size());
+
+    std::random_device random;
+    m_sessionSalt = (static_cast<uint64_t>(random()) << 32 | random()) | 1;
+    m_epoch = 0;
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.layoutVersion = kLayoutVersion;
+    header.dataOffset = static_cast<uint32_t>(kDataOffset);
+    header.sessionSalt = m_sessionSalt;
+    header.startUnixMs = unixNowMs();
+    header.streams = static_cast<uint32_t>(streams);
+    header.samplesPerStream = static_cast<uint32_t>(samplesPerStream);
+    header.durableOffset = kDataOffset;
+    header.checksum = headerChecksum(header);
+    std::memcpy(m_file.data(), &header, sizeof(header));
+    if (!m_file.flush()) {
+        error = "cannot sync the journal";
+        return false;
+    }
+
+    m_writeOffset = kDataOffset;
+    m_sequence = 0;
+    m_written.store(kDataOffset, std::memory_order_release);
+    m_durable.store(kDataOffset);
+    m_records.store(0);
+    m_dropped.store(0);
+    m_checkpoints.store(0);
+    m_active.store(true);
+    return true;
+}
+
+bool SessionJournal::writeRecord(uint8_t type, uint8_t dev, uint8_t chan, const void* payload, size_t size) {
+    if (!m_active.load(std::memory_order_relaxed)) return false;
+
+    while (m_writeLock.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    if (!m_active.load(std::memory_order_relaxed)) {
+        m_writeLock.clear(std::memory_order_release);
+        return false;
+    }
+    size_t total = sizeof(RecordHeader) + size;
+    if (m_writeOffset + total > m_file.size()) {
+        m_writeLock.clear(std::memory_order_release);
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint8_t* record = m_file.data() + m_writeOffset;
+    RecordHeader header{ 0, static_cast<uint32_t>(size), m_sequence, m_epoch, type, dev, chan, 0 };
+    std::memcpy(record, &header, sizeof(header));
+    if (size > 0) std::memcpy(record + sizeof(header), payload, size);
+    uint32_t checksum = recordChecksum(record, size, m_sessionSalt);
+    std::memcpy(record, &checksum, sizeof(checksum));
+
+    m_writeOffset += total;
+    m_sequence++;
+    m_written.store(m_writeOffset, std::memory_order_release);
+    m_writeLock.clear(std::memory_order_release);
+    m_records.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void SessionJournal::appendSamples(int dev, int chan, const int* data, size_t count) {
+    if (count == 0 || !m_active.load(std::memory_order_relaxed)) return;
+    writeRecord(Record_Samples, static_cast<uint8_t>(dev), static_cast<uint8_t>(chan), data, count * sizeof(int32_t));
+}
+
+void SessionJournal::appendMarker(const SessionRecorder& recorder, int phase) {
+    if (!m_active.load()) return;
+
+    int devs[kMaxStreams];
+    int chans[kMaxStreams];
+    size_t positions[kMaxStreams];
+    int count = recorder.markerPositions(phase, devs, chans, positions, kMaxStreams);
+
+    uint8_t payload[sizeof(MarkerPayload) + kMaxStreams * sizeof(MarkerEntry)] = {};
+    MarkerPayload marker{};
+    const char* label = recorder.phaseLabel(phase);
+    if (label) std::strncpy(marker.label, label, sizeof(marker.label) - 1);
+    marker.count = static_cast<uint32_t>(count);
+    std::memcpy(payload, &marker, sizeof(marker));
+    for (int i = 0; i < count; ++i) {
+        MarkerEntry entry{ static_cast<uint8_t>(devs[i]), static_cast<uint8_t>(chans[i]), 0,
+                           static_cast<uint32_t>(positions[i]) };
+        std::memcpy(payload + sizeof(marker) + i * sizeof(entry), &entry, sizeof(entry));
+    }
+    if (writeRecord(Record_Marker, 0, 0, payload, sizeof(marker) + count * sizeof(MarkerEntry))) {
+        requestCheckpoint();
+    }
+}
+
+void SessionJournal::appendEnd() {
+    if (writeRecord(Record_End, 0, 0, nullptr, 0)) {
+        m_active.store(false);
+        requestCheckpoint();
+    }
+}
+
+void SessionJournal::requestCheckpoint() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_flushRequested = true;
+    }
+    m_flushWake.notify_one();
+}
+
+bool SessionJournal::checkpoint() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return checkpointLocked();
+}
+
+// Caller holds m_mutex. Syncs the records written since the last
+// checkpoint, then the header that makes them durable.
+bool SessionJournal::checkpointLocked() {
+    if (!m_file.isOpen() || m_sessionSalt == 0) return true;
+    size_t written = m_written.load(std::memory_order_acquire);
+    size_t durable = m_durable.load();
+    if (written <= durable) return true;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!m_file.flush(durable, written - durable)) return false;
+
+    FileHeader header;
+    std::memcpy(&header, m_file.data(), sizeof(header));
+    header.durableOffset = written;
+    header.checkpoints++;
+    header.checksum = headerChecksum(header);
+    std::memcpy(m_file.data(), &header, sizeof(header));
+    if (!m_file.flush(0, sizeof(header))) return false;
+
+    m_durable.store(written);
+    m_checkpoints.fetch_add(1);
+    m_lastCheckpointUs.store(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count()));
+    return true;
+}
+
+void SessionJournal::flusherLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopFlusher) {
+        m_flushWake.wait_for(lock, std::chrono::milliseconds(m_flushIntervalMs), [this]() {
+            return m_stopFlusher || m_flushRequested;
+        });
+        m_flushRequested = false;
+        checkpointLocked();
+    }
+}
+
+bool SessionJournal::recover(SessionRecorder& recorder, Recovery& info, std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+    info = Recovery();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file.isOpen()) {
+        error = "journal is not open";
+        return false;
+    }
+    deactivate();
+
+    FileHeader header;
+    std::memcpy(&header, m_file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.sessionSalt == 0) {
+        error = "journal holds no session";
+        return false;
+    }
+    if (header.layoutVersion != kLayoutVersion || header.dataOffset != kDataOffset ||
+        header.checksum != headerChecksum(header) || header.streams == 0 || header.samplesPerStream == 0) {
+        error = "journal header is damaged";
+        return false;
+    }
+    if (header.epoch == std::numeric_limits<uint32_t>::max()) {
+        error = "journal was recovered too often";
+        return false;
+    }
+    if (!recorder.begin(static_cast<int>(header.streams), header.samplesPerStream)) {
+        error = "cannot start the session recorder";
+        return false;
+    }
+
+    // Replay records up to the first torn, stale or out-of-order one
+    const uint8_t* data = m_file.data();
+    size_t size = m_file.size();
+    size_t offset = kDataOffset;
+    uint32_t sequence = 0;
+    uint32_t epoch = 0;
+    std::vector<size_t> markers;
+    while (offset + sizeof(RecordHeader) <= size && !info.ended) {
+        RecordHeader record;
+        std::memcpy(&record, data + offset, sizeof(record));
+        if (record.size > size - offset - sizeof(RecordHeader) || record.size % sizeof(int32_t) != 0 ||
+            record.sequence != sequence || record.epoch < epoch || record.epoch > header.epoch ||
+            record.checksum != recordChecksum(data + offset, record.size, header.sessionSalt)) {
+            break;
+        }
+
+        const uint8_t* payload = data + offset + sizeof(RecordHeader);
+        if (record.type == Record_Samples) {
+            size_t count = record.size / sizeof(int32_t);
+            recorder.append(record.dev, record.chan, reinterpret_cast<const int*>(payload), static_cast<int>(count));
+            info.samples += count;
+        }
+        else if (record.type == Record_Marker) {
+            markers.push_back(offset);
+        }
+        else if (record.type == Record_End) {
+            info.ended = true;
+        }
+        else {
+            break;
+        }
+        epoch = record.epoch;
+        offset += sizeof(RecordHeader) + record.size;
+        sequence++;
+        info.records++;
+    }
+
+    // Markers last, so positions recorded ahead of their samples still land
+    for (size_t markerOffset : markers) {
+        const uint8_t* payload = data + markerOffset + sizeof(RecordHeader);
+        MarkerPayload marker;
+        std::memcpy(&marker, payload, sizeof(marker));
+        marker.label[sizeof(marker.label) - 1] = '\0';
+        int count = static_cast<int>(std::min<uint32_t>(marker.count, kMaxStreams));
+
+        int devs[kMaxStreams];
+        int chans[kMaxStreams];
+        size_t positions[kMaxStreams];
+        for (int i = 0; i < count; ++i) {
+            MarkerEntry entry;
+            std::memcpy(&entry, payload + sizeof(marker) + i * sizeof(entry), sizeof(entry));
+            devs[i] = entry.dev;
+            chans[i] = entry.chan;
+            positions[i] = entry.position;
+        }
+        if (recorder.restoreMarker(marker.label, devs, chans, positions, count)) info.markers++;
+    }
+    if (info.ended) recorder.end();
+
+    // Continue after the last intact record in a new epoch, so leftovers of
+    // a torn tail can never be mistaken for records written from now on
+    m_sessionSalt = header.sessionSalt;
+    m_epoch = header.epoch + 1;
+    info.durableBytes = header.durableOffset > kDataOffset ? header.durableOffset - kDataOffset : 0;
+    header.epoch = m_epoch;
+    header.durableOffset = offset;
+    header.checksum = headerChecksum(header);
+    std::memcpy(m_file.data(), &header, sizeof(header));
+    m_file.flush();
+
+    m_writeOffset = offset;
+    m_sequence = sequence;
+    m_written.store(offset, std::memory_order_release);
+    m_durable.store(offset);
+    m_records.store(info.records);
+    m_dropped.store(0);
+    m_checkpoints.store(header.checkpoints);
+    m_active.store(!info.ended);
+
+    info.streams = static_cast<int>(header.streams);
+    info.samplesPerStream = header.samplesPerStream;
+    info.startUnixMs = header.startUnixMs;
+    info.recoveredBytes = offset - kDataOffset;
+    info.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+SessionJournal::Stats SessionJournal::stats() const {
+    Stats stats;
+    stats.capacity = m_capacity.load();
+    stats.open = stats.capacity > 0;
+    stats.active = m_active.load();
+    size_t written = m_written.load();
+    size_t durable = m_durable.load();
+    stats.writtenBytes = written > kDataOffset ? written - kDataOffset : 0;
+    stats.durableBytes = durable > kDataOffset ? durable - kDataOffset : 0;
+    stats.records = m_records.load();
+    stats.droppedRecords = m_dropped.load();
+    stats.checkpoints = m_checkpoints.load();
+    stats.lastCheckpointUs = m_lastCheckpointUs.load();
+    return stats;
+}
+
+} // namespace brainmirror
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Write-ahead journal of the recording session, so a crash or an SDK
+// re-init mid-test does not throw the session away. Every sample the
+// SessionRecorder stores, every phase marker and the session end are
+// appended as checksummed records to a preallocated, memory-mapped file.
+// The callback thread only copies into the mapping; a background thread
+// syncs the new bytes every flush interval (and right after markers) and
+// records the synced length in the header as a checkpoint.
+//
+// recover() replays the intact records into a SessionRecorder, which is
+// a memcpy per packet, and journaling then continues after them. After a
+// process crash everything written survives in the page cache; after a
+// power loss the data up to the last checkpoint does.
+namespace brainmirror {
+
+class SessionRecorder;
+
+class SessionJournal {
+public:
+    struct Stats {
+        bool open = false;
+        bool active = false;            // A session is being journaled
+        uint64_t capacity = 0;          // File bytes
+        uint64_t writtenBytes = 0;      // End of the last complete record
+        uint64_t durableBytes = 0;      // Synced by the last checkpoint
+        uint64_t records = 0;
+        uint64_t droppedRecords = 0;    // Journal full
+        uint64_t checkpoints = 0;
+        uint32_t lastCheckpointUs = 0;
+    };
+
+    struct Recovery {
+        int streams = 0;
+        size_t samplesPerStream = 0;
+        uint64_t startUnixMs = 0;       // Session start
+        uint64_t records = 0;
+        uint64_t samples = 0;
+        int markers = 0;
+        bool ended = false;             // The session had finished
+        uint64_t durableBytes = 0;      // Synced before the crash
+        uint64_t recoveredBytes = 0;    // Intact records replayed
+        double elapsedMs = 0.0;
+    };
+
+    SessionJournal() = default;
+    ~SessionJournal();
+    SessionJournal(const SessionJournal&) = delete;
+    SessionJournal& operator=(const SessionJournal&) = delete;
+
+    // Opens or creates the journal file; its content is left alone until
+    // beginSession() or recover(). Checkpoints run every flushIntervalMs.
+    bool open(const std::filesystem::path& path, int flushIntervalMs, std::string& error);
+    // Takes a final checkpoint and closes the file.
+    void close();
+    bool isOpen() const;
+
+    // Starts journaling a new session, discarding the previous one. The
+    // recorder must not be recording.
+    bool beginSession(int streams, size_t samplesPerStream, std::string& error);
+    // Callback thread, with the samples the recorder stored. Never blocks
+    // on I/O or allocates; other writers only hold it for a memcpy.
+    void appendSamples(int dev, int chan, const int* data, size_t count);
+    // After recorder.mark() / recorder.end().
+    void appendMarker(const SessionRecorder& recorder, int phase);
+    void appendEnd();
+
+    // Syncs everything written so far and records it as durable.
+    bool checkpoint();
+
+    // Rebuilds the journaled session into the recorder: samples, phase
+    // markers and end. Call before data collection starts. Returns false
+    // when the journal holds no session.
+    bool recover(SessionRecorder& recorder, Recovery& info, std::string& error);
+
+    Stats stats() const;
+
+private:
+    mutable std::mutex m_mutex;         // File, header and checkpoints; never taken on the callback path
+    MappedFile m_file;
+    int m_flushIntervalMs = 200;
+    uint64_t m_sessionSalt = 0;         // Seeds record checksums; 0 before the first session
+    uint32_t m_epoch = 0;               // Bumped by every recovery
+
+    alignas(64) std::atomic_flag m_writeLock = ATOMIC_FLAG_INIT;
+    size_t m_writeOffset = 0;           // Guarded by m_writeLock
+    uint32_t m_sequence = 0;            // Guarded by m_writeLock
+    std::atomic<bool> m_active{ false };
+    std::atomic<size_t> m_written{ 0 };
+    std::atomic<uint64_t> m_records{ 0 };
+    std::atomic<uint64_t> m_dropped{ 0 };
+
+    std::atomic<size_t> m_durable{ 0 };
+    std::atomic<uint64_t> m_checkpoints{ 0 };
+    std::atomic<uint32_t> m_lastCheckpointUs{ 0 };
+    std::atomic<uint64_t> m_capacity{ 0 };
+
+    std::thread m_flusher;
+    std::condition_variable m_flushWake;
+    bool m_stopFlusher = false;         // Guarded by m_mutex
+    bool m_flushRequested = false;      // Guarded by m_mutex
+
+    void deactivate();
+    bool writeRecord(uint8_t type, uint8_t dev, uint8_t chan, const void* payload, size_t size);
+    void requestCheckpoint();
+    bool checkpointLocked();
+    void flusherLoop();
+};
+
+} // namespace brainmirror
@@ -0,0 +1,286 @@
+#include "SessionRecorder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace brainmirror {
+
+namespace {
+
+constexpr int kUnbound = -1;
+constexpr int kBinding = -2;
+
+} // namespace
+
+SessionRecorder::SessionRecorder() {
+    resetSlots();
+}
+
+void SessionRecorder::stopWriters() {
+    m_recording.store(false);
+    while (m_writers.load() != 0) {
+        std::this_thread::yield();
+    }
+}
+
+void SessionRecorder::resetSlots() {
+    for (auto& device : m_slots) {
+        for (auto& slot : device) slot.store(kUnbound, std::memory_order_relaxed);
+    }
+    m_boundStreams.store(0, std::memory_order_relaxed);
+}
+
+bool SessionRecorder::begin(int streams, size_t samplesPerStream) {
+    if (streams <= 0 || samplesPerStream == 0) return false;
+    streams = std::min(streams, MaxDevices * MaxChannels);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stopWriters();
+
+    // Reallocate only when the previous session's buffers are too small
+    if (streams > m_bufferStreams || samplesPerStream > m_bufferSamples) {
+        m_streams.reset();
+        m_streams = std::make_unique<Stream[]>(streams);
+        for (int i = 0; i < streams; ++i) {
+            m_streams[i].samples = std::make_unique<int[]>(samplesPerStream);
+        }
+        for (auto& marker : m_markers) {
+            marker.positions = std::make_unique<size_t[]>(streams);
+        }
+        m_bufferStreams = streams;
+        m_bufferSamples = samplesPerStream;
+    }
+    // Reused buffers may be larger; the session only gets what was asked for
+    m_streamCapacity = streams;
+    m_samplesPerStream = samplesPerStream;
+
+    for (int i = 0; i < m_bufferStreams; ++i) {
+        m_streams[i].count.store(0, std::memory_order_relaxed);
+        m_streams[i].dev = -1;
+        m_streams[i].chan = -1;
+    }
+    resetSlots();
+    m_markerCount = 0;
+    m_samples.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+
+    m_state = State::Recording;
+    m_recording.store(true);
+    return true;
+}
+
+// Caller holds m_mutex
+bool SessionRecorder::placeMarker(const char* label) {
+    if (m_markerCount >= MaxMarkers) return false;
+
+    Marker& marker = m_markers[m_markerCount];
+    std::memset(marker.label, 0, sizeof(marker.label));
+    if (label) std::strncpy(marker.label, label, MaxLabel - 1);
+    for (int i = 0; i < m_streamCapacity; ++i) {
+        marker.positions[i] = m_streams[i].count.load(std::memory_order_acquire);
+    }
+    m_markerCount++;
+    return true;
+}
+
+bool SessionRecorder::mark(const char* label) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state != State::Recording) return false;
+    return placeMarker(label);
+}
+
+bool SessionRecorder::end() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state != State::Recording) return false;
+    stopWriters();
+    m_state = State::Ended;
+    return true;
+}
+
+void SessionRecorder::release() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stopWriters();
+    resetSlots();
+    m_streams.reset();
+    for (auto& marker : m_markers) marker.positions.reset();
+    m_bufferStreams = 0;
+    m_bufferSamples = 0;
+    m_streamCapacity = 0;
+    m_samplesPerStream = 0;
+    m_markerCount = 0;
+    m_state = State::Idle;
+}
+
+SessionRecorder::Stream* SessionRecorder::bind(int dev, int chan) {
+    std::atomic<int>& slot = m_slots[dev][chan];
+    int index = slot.load(std::memory_order_acquire);
+    if (index >= 0) return &m_streams[index];
+    if (index == kBinding) return nullptr;
+
+    int expected = kUnbound;
+    if (!slot.compare_exchange_strong(expected, kBinding)) {
+        return expected >= 0 ? &m_streams[expected] : nullptr;
+    }
+
+    index = m_boundStreams.load(std::memory_order_relaxed);
+    while (index < m_streamCapacity &&
+           !m_boundStreams.compare_exchange_weak(index, index + 1)) {
+    }
+    if (index >= m_streamCapacity) {
+        slot.store(kUnbound, std::memory_order_release);
+        return nullptr;
+    }
+
+    m_streams[index].dev = dev;
+    m_streams[index].chan = chan;
+    slot.store(index, std::memory_order_release);
+    return &m_streams[index];
+}
+
+size_t SessionRecorder::append(int dev, int chan, const int* data, int len) {
+    if (!m_recording.load(std::memory_order_relaxed)) return 0;
+    if (dev < 0 || dev >= MaxDevices || chan < 0 || chan >= MaxChannels || !data || len <= 0) return 0;
+
+    // begin()/end() wait for m_writers to drain after clearing m_recording
+    size_t stored = 0;
+    m_writers.fetch_add(1);
+    if (m_recording.load()) {
+        Stream* stream = bind(dev, chan);
+        if (stream) {
+            size_t count = stream->count.load(std::memory_order_relaxed);
+            stored = std::min(static_cast<size_t>(len), m_samplesPerStream - count);
+            std::memcpy(stream->samples.get() + count, data, stored * sizeof(int));
+            stream->count.store(count + stored, std::memory_order_release);
+        }
+        m_samples.fetch_add(stored, std::memory_order_relaxed);
+        if (stored < static_cast<size_t>(len)) {
+            m_dropped.fetch_add(len - stored, std::memory_order_relaxed);
+        }
+    }
+    m_writers.fetch_sub(1);
+    return stored;
+}
+
+int SessionRecorder::phaseCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_markerCount;
+}
+
+const char* SessionRecorder::phaseLabel(int phase) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (phase < 0 || phase >= m_markerCount) return nullptr;
+    return m_markers[phase].label;
+}
+
+int SessionRecorder::findPhase(const char* label) const {
+    if (!label) return -1;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (int i = m_markerCount - 1; i >= 0; --i) {
+        if (std::strncmp(m_markers[i].label, label, MaxLabel - 1) == 0) return i;
+    }
+    return -1;
+}
+
+const SessionRecorder::Stream* SessionRecorder::find(int dev, int chan) const {
+    if (dev < 0 || dev >= MaxDevices || chan < 0 || chan >= MaxChannels) return nullptr;
+    int index = m_slots[dev][chan].load(std::memory_order_acquire);
+    return index >= 0 ? &m_streams[index] : nullptr;
+}
+
+bool SessionRecorder::phaseSlice(int dev, int chan, int phase, const int** data, size_t* count) const {
+    if (!data || !count) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (phase < 0 || phase >= m_markerCount) return false;
+
+    const Stream* stream = find(dev, chan);
+    if (!stream) return false;
+
+    size_t streamIndex = static_cast<size_t>(stream - m_streams.get());
+    size_t first = m_markers[phase].positions[streamIndex];
+    size_t last = phase + 1 < m_markerCount
+        ? m_markers[phase + 1].positions[streamIndex]
+        : stream->count.load(std::memory_order_acquire);
+
+    *data = stream->samples.get() + first;
+    *count = last - first;
+    return true;
+}
+
+bool SessionRecorder::streamSlice(int dev, int chan, const int** data, size_t* count) const {
+    if (!data || !count) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const Stream* stream = find(dev, chan);
+    if (!stream) return false;
+    *data = stream->samples.get();
+    *count = stream->count.load(std::memory_order_acquire);
+    return true;
+}
+
+int SessionRecorder::boundStreams(int* devs, int* chans, int max) const {
+    if (!devs || !chans || max <= 0) return 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    int written = 0;
+    for (int dev = 0; dev < MaxDevices; ++dev) {
+        for (int chan = 0; chan < MaxChannels && written < max; ++chan) {
+            if (m_slots[dev][chan].load(std::memory_order_acquire) >= 0) {
+                devs[written] = dev;
+                chans[written] = chan;
+                ++written;
+            }
+        }
+    }
+    return written;
+}
+
+int SessionRecorder::markerPositions(int phase, int* devs, int* chans, size_t* positions, int max) const {
+    if (!devs || !chans || !positions || max <= 0) return 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (phase < 0 || phase >= m_markerCount) return 0;
+
+    int written = 0;
+    for (int dev = 0; dev < MaxDevices; ++dev) {
+        for (int chan = 0; chan < MaxChannels && written < max; ++chan) {
+            int index = m_slots[dev][chan].load(std::memory_order_acquire);
+            if (index < 0) continue;
+            devs[written] = dev;
+            chans[written] = chan;
+            positions[written] = m_markers[phase].positions[index];
+            ++written;
+        }
+    }
+    return written;
+}
+
+bool SessionRecorder::restoreMarker(const char* label, const int* devs, const int* chans,
+                                    const size_t* positions, int count) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state != State::Recording || !placeMarker(label)) return false;
+
+    Marker& marker = m_markers[m_markerCount - 1];
+    for (int i = 0; i < m_streamCapacity; ++i) marker.positions[i] = 0;
+    for (int i = 0; i < count; ++i) {
+        const Stream* stream = find(devs[i], chans[i]);
+        if (!stream) continue;
+        size_t index = static_cast<size_t>(stream - m_streams.get());
+        marker.positions[index] = std::min(positions[i], stream->count.load(std::memory_order_acquire));
+    }
+    return true;
+}
+
+SessionRecorder::Stats SessionRecorder::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.state = m_state;
+    stats.streams = std::min(m_boundStreams.load(std::memory_order_relaxed), m_streamCapacity);
+    stats.streamCapacity = m_streamCapacity;
+    stats.samplesPerStream = m_samplesPerStream;
+    stats.markers = m_markerCount;
+    stats.samples = m_samples.load(std::memory_order_relaxed);
+    stats.droppedSamples = m_dropped.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace brainmirror
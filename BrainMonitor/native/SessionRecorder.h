@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// Records raw samples for a test session straight from the SDK callback into
+// preallocated per-(device, channel) buffers. Phase markers store the write
+// index of every stream at the moment they are placed, so a phase is exactly
+// the samples between two markers, independent of UI timer ticks. Phase
+// slices are handed out as pointers into the buffers and stay valid until
+// the next begin().
+namespace brainmirror {
+
+class SessionRecorder {
+public:
+    static constexpr int MaxDevices = 16;
+    static constexpr int MaxChannels = 8;
+    static constexpr int MaxMarkers = 64;
+    static constexpr int MaxLabel = 32;
+
+    enum class State { Idle, Recording, Ended };
+
+    struct Stats {
+        State state = State::Idle;
+        int streams = 0;            // Streams bound to a (device, channel)
+        int streamCapacity = 0;     // Streams the session can bind
+        size_t samplesPerStream = 0;
+        int markers = 0;
+        uint64_t samples = 0;
+        uint64_t droppedSamples = 0;    // Buffer full or no free stream
+    };
+
+    SessionRecorder();
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    // Starts a session with room for `streams` (device, channel) streams of
+    // `samplesPerStream` samples each. Buffers from an earlier session are
+    // reused when they are large enough. Samples before the first mark()
+    // belong to no phase.
+    bool begin(int streams, size_t samplesPerStream);
+    // Places a marker at the current end of every stream.
+    bool mark(const char* label);
+    // Stops recording; data and markers stay readable.
+    bool end();
+    // Releases the buffers.
+    void release();
+
+    // Callback thread. Lock-free; never allocates. Returns the number of
+    // samples stored (0 when not recording, fewer when the stream is full).
+    size_t append(int dev, int chan, const int* data, int len);
+
+    // Phase p spans marker p up to marker p+1 (or the end of the stream).
+    int phaseCount() const;
+    const char* phaseLabel(int phase) const;
+    int findPhase(const char* label) const;     // Last phase with this label, -1 if none
+    bool phaseSlice(int dev, int chan, int phase, const int** data, size_t* count) const;
+    // Everything recorded for the stream, including samples before the first marker.
+    bool streamSlice(int dev, int chan, const int** data, size_t* count) const;
+    // (device, channel) of every bound stream in device/channel order; returns the number written.
+    int boundStreams(int* devs, int* chans, int max) const;
+
+    // Start position of the phase in every bound stream; returns the number
+    // written. Streams bound later started the phase at 0.
+    int markerPositions(int phase, int* devs, int* chans, size_t* positions, int max) const;
+    // Appends a marker at explicit positions, as returned by markerPositions()
+    // in an earlier run. Positions past the end of a stream are clamped.
+    bool restoreMarker(const char* label, const int* devs, const int* chans, const size_t* positions, int count);
+
+    Stats stats() const;
+
+private:
+    struct Stream {
+        std::unique_ptr<int[]> samples;
+        std::atomic<size_t> count{ 0 };
+        int dev = -1;
+        int chan = -1;
+    };
+
+    struct Marker {
+        char label[MaxLabel] = {};
+        std::unique_ptr<size_t[]> positions;    // Per stream, sized to the stream pool
+    };
+
+    mutable std::mutex m_mutex;         // API calls; the callback path never takes it
+    std::unique_ptr<Stream[]> m_streams;
+    int m_bufferStreams = 0;            // Allocated, kept across sessions
+    size_t m_bufferSamples = 0;
+    int m_streamCapacity = 0;           // Limits of the current session, at most the above
+    size_t m_samplesPerStream = 0;
+    Marker m_markers[MaxMarkers];
+    int m_markerCount = 0;
+    State m_state = State::Idle;
+
+    std::atomic<bool> m_recording{ false };
+    std::atomic<int> m_writers{ 0 };
+    std::atomic<int> m_boundStreams{ 0 };
+    std::atomic<int> m_slots[MaxDevices][MaxChannels];
+    std::atomic<uint64_t> m_samples{ 0 };
+    std::atomic<uint64_t> m_dropped{ 0 };
+
+    void stopWriters();
+    void resetSlots();
+    Stream* bind(int dev, int chan);
+    const Stream* find(int dev, int chan) const;
+    bool placeMarker(const char* label);
+};
+
+} // namespace brainmirror
@@ -0,0 +1,567 @@
+#include "SimBackend.h"
+#include "brnpro_if.h"
+#include "ble_device.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace jfbrnpro_if;
+
+namespace brainmirror {
+namespace sim {
+
+namespace {
+
+constexpr int kMaxConnected = 16;
+constexpr double kPi = 3.14159265358979323846;
+
+struct Callbacks {
+    postDataOutputCB post = nullptr;
+    rawDataOutputCB raw = nullptr;
+    battInfoOutCB batt = nullptr;
+    commandRespCB resp = nullptr;
+    eventCB event = nullptr;
+    void* user = nullptr;
+};
+
+struct PendingResponse {
+    std::chrono::steady_clock::time_point due;
+    int dev = 0;
+    uint8_t cmd = 0;
+    uint8_t payload[4] = { 0 };
+    int len = 0;
+};
+
+struct SimDevice {
+    std::string mac;
+    std::string name;
+    int type = 0;
+    int index = -1;
+    bool connected = false;
+};
+
+struct SimState {
+    std::mutex mutex;
+    SimConfig config;
+    Callbacks callbacks;
+    std::vector<SimDevice> devices;     // Everything jfboard_scan reported
+    bool portOpen = false;
+
+    std::thread generator;
+    std::atomic<bool> generating{ false };
+
+    std::thread responder;
+    std::condition_variable responderWake;
+    bool responderStop = false;
+    std::vector<PendingResponse> responses;
+
+    std::atomic<uint64_t> packets{ 0 };
+    std::atomic<uint64_t> samples{ 0 };
+    unsigned rng = 1;
+};
+
+SimState& state() {
+    static SimState* instance = new SimState();
+    return *instance;
+}
+
+thread_local uint64_t t_packetTimestampNs = 0;
+
+uint64_t steadyNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Caller holds the state mutex.
+SimDevice* findDevice(SimState& s, const std::string& mac) {
+    for (auto& device : s.devices) {
+        if (device.mac == mac) return &device;
+    }
+    return nullptr;
+}
+
+SimDevice* findByIndex(SimState& s, int index) {
+    for (auto& device : s.devices) {
+        if (device.connected && device.index == index) return &device;
+    }
+    return nullptr;
+}
+
+int freeIndex(SimState& s) {
+    for (int index = 0; index < kMaxConnected; ++index) {
+        if (!findByIndex(s, index)) return index;
+    }
+    return -1;
+}
+
+void fireEvent(const Callbacks& cb, uint32_t event, uint32_t param, const std::string& mac) {
+    if (cb.event) {
+        std::string copy = mac;
+        cb.event(cb.user, event, param, copy.empty() ? nullptr : &copy[0]);
+    }
+}
+
+// Caller holds the state mutex; events are returned so they fire unlocked.
+bool connectLocked(SimState& s, const std::string& mac, int type, std::vector<std::string>& connectedMacs) {
+    SimDevice* device = findDevice(s, mac);
+    if (!device) {
+        SimDevice added;
+        added.mac = mac;
+        added.name = "SIM" + mac.substr(mac.size() > 4 ? mac.size() - 4 : 0);
+        added.type = type;
+        s.devices.push_back(added);
+        device = &s.devices.back();
+    }
+    if (device->connected) return true;
+
+    int index = freeIndex(s);
+    if (index < 0) return false;
+    device->index = index;
+    device->connected = true;
+    connectedMacs.push_back(device->mac);
+    return true;
+}
+
+void generatorLoop() {
+    SimState& s = state();
+    SimConfig config;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        config = s.config;
+    }
+
+    const int perPacket = std::max(1, config.samplesPerPacket);
+    const auto interval = std::chrono::nanoseconds(1000000000ll * perPacket / std::max(1, config.sampleRate));
+    const int packetsPerSecond = std::max(1, config.sampleRate / perPacket);
+
+    std::vector<int> buffer(perPacket);
+    int indices[kMaxConnected];
+    uint64_t sampleClock = 0;
+    uint64_t tick = 0;
+    unsigned rng = config.seed;
+    auto next = std::chrono::steady_clock::now();
+
+    while (s.generating.load(std::memory_order_acquire)) {
+        Callbacks cb;
+        int count = 0;
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            cb = s.callbacks;
+            for (const auto& device : s.devices) {
+                if (device.connected && count < kMaxConnected) indices[count++] = device.index;
+            }
+        }
+
+        for (int d = 0; d < count; ++d) {
+            for (int chan = 0; chan < config.channels; ++chan) {
+                for (int i = 0; i < perPacket; ++i) {
+                    double t = static_cast<double>(sampleClock + i) / config.sampleRate;
+                    rng = rng * 1664525u + 1013904223u;
+                    double noise = (static_cast<double>(rng >> 8) / 16777216.0 - 0.5) * 20.0;
+                    buffer[i] = static_cast<int>(30.0 * std::sin(2.0 * kPi * 10.0 * t + indices[d]) +
+                        20.0 * std::sin(2.0 * kPi * 6.0 * t + chan) + noise);
+                }
+                if (cb.raw) {
+                    t_packetTimestampNs = steadyNowNs();
+                    cb.raw(cb.user, indices[d], chan, buffer.data(), perPacket);
+                    t_packetTimestampNs = 0;
+                }
+                s.packets.fetch_add(1, std::memory_order_relaxed);
+                s.samples.fetch_add(perPacket, std::memory_order_relaxed);
+            }
+
+            if (tick % packetsPerSecond == 0) {
+                uint32_t psd[8] = { 10, 20, 30, 40, 30, 20, 10, 5 };
+                if (cb.post) cb.post(cb.user, indices[d], 0, 50, 50, 0, psd);
+                if (cb.batt) cb.batt(cb.user, indices[d], 80, 3900);
+            }
+        }
+
+        sampleClock += perPacket;
+        tick++;
+        if (config.realtime) {
+            next += interval;
+            std::this_thread::sleep_until(next);
+        }
+    }
+}
+
+void responderLoop() {
+    SimState& s = state();
+    std::unique_lock<std::mutex> lock(s.mutex);
+    while (!s.responderStop) {
+        if (s.responses.empty()) {
+            s.responderWake.wait(lock);
+            continue;
+        }
+
+        auto earliest = std::min_element(s.responses.begin(), s.responses.end(),
+            [](const PendingResponse& a, const PendingResponse& b) { return a.due < b.due; });
+        if (earliest->due > std::chrono::steady_clock::now()) {
+            s.responderWake.wait_until(lock, earliest->due);
+            continue;
+        }
+
+        PendingResponse response = *earliest;
+        s.responses.erase(earliest);
+        Callbacks cb = s.callbacks;
+        lock.unlock();
+        if (cb.resp) cb.resp(cb.user, response.dev, response.cmd, response.payload, response.len);
+        lock.lock();
+    }
+}
+
+void stopGenerator(SimState& s) {
+    s.generating.store(false, std::memory_order_release);
+    if (s.generator.joinable() && s.generator.get_id() != std::this_thread::get_id()) {
+        s.generator.join();
+    }
+}
+
+} // namespace
+
+void configure(const SimConfig& config) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    state().config = config;
+}
+
+SimConfig currentConfig() {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    return state().config;
+}
+
+void injectDisconnect(int connectIndex) {
+    SimState& s = state();
+    Callbacks cb;
+    std::string mac;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        SimDevice* device = findByIndex(s, connectIndex);
+        if (!device) return;
+        device->connected = false;
+        mac = device->mac;
+        cb = s.callbacks;
+    }
+    fireEvent(cb, Event_devDisconnect, static_cast<uint32_t>(connectIndex), mac);
+}
+
+void injectDongleReboot() {
+    SimState& s = state();
+    Callbacks cb;
+    std::vector<std::pair<int, std::string>> dropped;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (auto& device : s.devices) {
+            if (device.connected) {
+                device.connected = false;
+                dropped.emplace_back(device.index, device.mac);
+            }
+        }
+        s.responses.clear();
+        cb = s.callbacks;
+    }
+    fireEvent(cb, Event_dongleReboot, 0, std::string());
+    for (const auto& device : dropped) {
+        fireEvent(cb, Event_devDisconnect, static_cast<uint32_t>(device.first), device.second);
+    }
+}
+
+void deliverRawPacket(int dev, int chan, int* data, int len) {
+    SimState& s = state();
+    rawDataOutputCB raw = s.callbacks.raw;
+    if (raw) raw(s.callbacks.user, dev, chan, data, len);
+    s.packets.fetch_add(1, std::memory_order_relaxed);
+    s.samples.fetch_add(static_cast<uint64_t>(len), std::memory_order_relaxed);
+}
+
+uint64_t packetsDelivered() {
+    return state().packets.load(std::memory_order_relaxed);
+}
+
+uint64_t samplesDelivered() {
+    return state().samples.load(std::memory_order_relaxed);
+}
+
+uint64_t currentPacketTimestampNs() {
+    return t_packetTimestampNs;
+}
+
+} // namespace sim
+} // namespace brainmirror
+
+// ---------------------------------------------------------------------------
+// jfbrnpro_if implementation
+// ---------------------------------------------------------------------------
+
+using brainmirror::sim::state;
+
+namespace jfbrnpro_if
+{
+
+ble_device::ble_device(std::string& mac, std::string& name, int type, int index)
+    : m_mac(mac), m_name(name), m_type(type), m_index(index) {}
+
+ble_device::ble_device(std::string& mac, int type, int index)
+    : m_mac(mac), m_type(type), m_index(index) {}
+
+// "MAC,type name", as printed by the vendor demo
+ble_device::ble_device(std::string& line) {
+    size_t comma = line.find(',');
+    m_mac = line.substr(0, comma);
+    if (comma != std::string::npos) {
+        size_t space = line.find(' ', comma);
+        m_type = std::atoi(line.substr(comma + 1, space - comma - 1).c_str());
+        if (space != std::string::npos) m_name = line.substr(space + 1);
+    }
+}
+
+ble_device::ble_device() = default;
+
+std::string ble_device::getDeviceMac() { return m_mac; }
+std::string ble_device::getDeviceName() { return m_name; }
+int ble_device::getDeviceType() { return m_type; }
+int ble_device::getConnectIndex() { return m_index; }
+void ble_device::setConnectIndex(int idx) { m_index = idx; }
+void ble_device::updateDeviceName(const std::string& name) { m_name = name; }
+ble_device::dev_state ble_device::getDeviceState() { return m_state; }
+void ble_device::setDeviceState(dev_state state) { m_state = state; }
+
+std::string jfboard_checkPort() { return "SIM0"; }
+std::string jfboard_checkPort(const int) { return "SIM0"; }
+const char* jfboard_checkPortC() { return "SIM0"; }
+bool jfboard_setBaudrate(int) { return true; }
+
+bool jfboard_connect(std::string&, int) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    state().portOpen = true;
+    return true;
+}
+
+bool jfboard_connect(const char* port) {
+    std::string name = port ? port : "";
+    return jfboard_connect(name);
+}
+
+void jfboard_disconnect() {
+    auto& s = state();
+    brainmirror::sim::stopGenerator(s);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.portOpen = false;
+    for (auto& device : s.devices) device.connected = false;
+}
+
+bool jfboard_scan() {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (!s.portOpen) return false;
+
+    for (int i = 0; i < s.config.deviceCount; ++i) {
+        char mac[24];   // "51000000" + up to 8 hex digits
+        snprintf(mac, sizeof(mac), "51000000%04X", static_cast<unsigned>(i));
+        if (brainmirror::sim::findDevice(s, mac)) continue;
+        brainmirror::sim::SimDevice device;
+        device.mac = mac;
+        char name[24];  // "SIM" + up to 11 characters of an int
+        snprintf(name, sizeof(name), "SIM%04d", i);
+        device.name = name;
+        s.devices.push_back(device);
+    }
+    return true;
+}
+
+std::vector<ble_device> jfboard_getScanDevices() {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    std::vector<ble_device> result;
+    for (auto& device : s.devices) {
+        ble_device entry(device.mac, device.name, device.type, device.index);
+        entry.setDeviceState(device.connected ? ble_device::connected : ble_device::disconnected);
+        result.push_back(entry);
+    }
+    return result;
+}
+
+std::vector<ble_device> jfboard_getDevices() {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    std::vector<ble_device> result;
+    for (auto& device : s.devices) {
+        if (!device.connected) continue;
+        ble_device entry(device.mac, device.name, device.type, device.index);
+        entry.setDeviceState(ble_device::connected);
+        result.push_back(entry);
+    }
+    return result;
+}
+
+int jfboard_getConnectedDevicesNum(void) {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return static_cast<int>(std::count_if(s.devices.begin(), s.devices.end(),
+        [](const brainmirror::sim::SimDevice& d) { return d.connected; }));
+}
+
+bool brainpro_groupConnect(std::vector<ble_device>& devices, int) {
+    auto& s = state();
+    std::vector<std::string> connected;
+    brainmirror::sim::Callbacks cb;
+    bool any = false;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.portOpen) return false;
+        for (auto& device : devices) {
+            std::string mac = device.getDeviceMac();
+            if (brainmirror::sim::connectLocked(s, mac, device.getDeviceType(), connected)) {
+                auto* sim = brainmirror::sim::findDevice(s, mac);
+                device.setConnectIndex(sim->index);
+                device.setDeviceState(ble_device::connected);
+                any = true;
+            }
+        }
+        cb = s.callbacks;
+    }
+    for (const auto& mac : connected) {
+        brainmirror::sim::fireEvent(cb, Event_devConnected, 0, mac);
+    }
+    return any;
+}
+
+bool brainpro_groupAdd(ble_device& device) {
+    std::vector<ble_device> devices{ device };
+    bool result = brainpro_groupConnect(devices);
+    device = devices[0];
+    return result;
+}
+
+bool brainpro_connect(ble_device& device) { return brainpro_groupAdd(device); }
+
+bool brainpro_connect(std::string& mac) {
+    ble_device device(mac, 0);
+    return brainpro_groupAdd(device);
+}
+
+bool brainpro_connect(const char* mac, int type) {
+    std::string text = mac ? mac : "";
+    ble_device device(text, type);
+    return brainpro_groupAdd(device);
+}
+
+bool brainpro_disconnect(ble_device& device) {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto* sim = brainmirror::sim::findDevice(s, device.getDeviceMac());
+    if (!sim || !sim->connected) return false;
+    sim->connected = false;
+    device.setDeviceState(ble_device::disconnected);
+    return true;
+}
+
+ble_device::dev_state brainpro_updateDeviceState(ble_device& device) {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto* sim = brainmirror::sim::findDevice(s, device.getDeviceMac());
+    ble_device::dev_state current = sim && sim->connected ? ble_device::connected : ble_device::disconnected;
+    device.setDeviceState(current);
+    return current;
+}
+
+bool brainpro_start() {
+    auto& s = state();
+    if (s.generating.exchange(true)) return true;
+    if (s.generator.joinable()) s.generator.join();
+    s.generator = std::thread(brainmirror::sim::generatorLoop);
+    return true;
+}
+
+bool brainpro_stop() {
+    brainmirror::sim::stopGenerator(state());
+    return true;
+}
+
+bool brainpro_exit() {
+    return brainpro_stop();
+}
+
+bool brainpro_command(int dev, uint8_t cmd, uint8_t* payload, uint8_t len) {
+    auto& s = state();
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!brainmirror::sim::findByIndex(s, dev)) return false;
+
+        s.rng = s.rng * 1664525u + 1013904223u;
+        if (static_cast<int>((s.rng >> 16) % 100) < s.config.commandDropPercent) return true;
+
+        brainmirror::sim::PendingResponse response;
+        response.due = std::chrono::steady_clock::now() + std::chrono::milliseconds(s.config.commandLatencyMs);
+        response.dev = dev;
+        response.cmd = cmd;
+        response.len = std::min<int>(payload ? len : 0, 3) + 1;
+        response.payload[0] = 0x00;     // Status: OK
+        for (int i = 1; i < response.len; ++i) response.payload[i] = payload[i - 1];
+        s.responses.push_back(response);
+    }
+    s.responderWake.notify_one();
+    return true;
+}
+
+bool brainpro_command(int dev, uint8_t cmd) {
+    return brainpro_command(dev, cmd, nullptr, 0);
+}
+
+void brainpro_install_callback(postDataOutputCB postOutput, rawDataOutputCB rawOutput, battInfoOutCB battInfo,
+                               commandRespCB cmdResp, eventCB setEvent, void* userData) {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.callbacks.post = postOutput;
+    s.callbacks.raw = rawOutput;
+    s.callbacks.batt = battInfo;
+    s.callbacks.resp = cmdResp;
+    s.callbacks.event = setEvent;
+    s.callbacks.user = userData;
+}
+
+std::string jfsdk_version() {
+    return "SIM-1.0";
+}
+
+void jfsdk_init(int) {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.packets = 0;
+    s.samples = 0;
+    s.rng = s.config.seed;
+    s.responderStop = false;
+    if (!s.responder.joinable()) {
+        s.responder = std::thread(brainmirror::sim::responderLoop);
+    }
+}
+
+void jfsdk_cleanup() {
+    auto& s = state();
+    brainmirror::sim::stopGenerator(s);
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.responderStop = true;
+        s.responses.clear();
+    }
+    s.responderWake.notify_one();
+    if (s.responder.joinable()) s.responder.join();
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.devices.clear();
+    s.portOpen = false;
+    s.callbacks = brainmirror::sim::Callbacks();
+}
+
+void jfsdk_sleep(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+}
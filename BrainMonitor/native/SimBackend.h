@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+// Simulated implementation of the vendor jfbrnpro_if API (lib/brnpro_if.h),
+// compiled into the SDK instead of jfsdklib.lib when BRAINMIRROR_SIM_BACKEND
+// is enabled. Used by the benchmark and soak tools, and for non-Windows builds.
+namespace brainmirror {
+namespace sim {
+
+struct SimConfig {
+    int deviceCount = 4;            // Devices reported by jfboard_scan
+    int channels = 1;               // rawData callbacks per device per packet
+    int sampleRate = 520;
+    int samplesPerPacket = 13;      // 40 packets/s at 520 Hz
+    bool realtime = true;           // false: generate packets as fast as possible
+    int commandLatencyMs = 5;       // Delay before a command response is delivered
+    int commandDropPercent = 0;     // Commands that never get a response
+    unsigned seed = 1;
+};
+
+// Applies to the next jfsdk_init / jfboard_scan.
+void configure(const SimConfig& config);
+SimConfig currentConfig();
+
+// Fault injection. Both fire the same events the real dongle would.
+void injectDisconnect(int connectIndex);
+void injectDongleReboot();
+
+// Delivers one raw packet synchronously through the installed callback,
+// bypassing the generator thread. Used to measure per-packet dispatch cost.
+void deliverRawPacket(int dev, int chan, int* data, int len);
+
+// Counters since jfsdk_init
+uint64_t packetsDelivered();
+uint64_t samplesDelivered();
+
+// Creation time (steady clock, ns) of the packet currently being delivered
+// on this thread; 0 outside a generator callback.
+uint64_t currentPacketTimestampNs();
+
+} // namespace sim
+} // namespace brainmirror
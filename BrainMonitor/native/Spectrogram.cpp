@@ -0,0 +1,201 @@
+#include "Spectrogram.h"
+#include "BrainwaveAnalysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace brainmirror {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kPowerFloor = 1e-12;
+
+// Power per [frame][bin], level by level
+struct PowerGrid {
+    size_t frames = 0;
+    size_t bins = 0;
+    std::vector<float> power;
+
+    float at(size_t frame, size_t bin) const { return power[frame * bins + bin]; }
+};
+
+PowerGrid computeStft(const double* samples, size_t count, const SpectrogramOptions& options, size_t bins) {
+    const size_t n = options.fftSize;
+    PowerGrid grid;
+    grid.bins = bins;
+    grid.frames = count >= n ? (count - n) / options.hopSize + 1 : 0;
+    grid.power.resize(grid.frames * bins);
+
+    std::vector<double> window(n);
+    for (size_t i = 0; i < n; ++i) {
+        window[i] = 0.5 * (1.0 - std::cos(2.0 * kPi * static_cast<double>(i) / static_cast<double>(n - 1)));
+    }
+
+    std::vector<std::complex<double>> buffer(n);
+    for (size_t frame = 0; frame < grid.frames; ++frame) {
+        const double* segment = samples + frame * options.hopSize;
+        double mean = 0.0;
+        for (size_t i = 0; i < n; ++i) mean += segment[i];
+        mean /= static_cast<double>(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            buffer[i] = std::complex<double>((segment[i] - mean) * window[i], 0.0);
+        }
+        fftInPlace(buffer.data(), n);
+
+        float* row = &grid.power[frame * bins];
+        for (size_t bin = 0; bin < bins; ++bin) {
+            row[bin] = static_cast<float>(std::norm(buffer[bin]) / static_cast<double>(n));
+        }
+    }
+    return grid;
+}
+
+PowerGrid halveTime(const PowerGrid& source) {
+    PowerGrid result;
+    result.bins = source.bins;
+    result.frames = (source.frames + 1) / 2;
+    result.power.resize(result.frames * result.bins);
+    for (size_t frame = 0; frame < result.frames; ++frame) {
+        size_t first = frame * 2;
+        size_t second = std::min(first + 1, source.frames - 1);
+        for (size_t bin = 0; bin < result.bins; ++bin) {
+            result.power[frame * result.bins + bin] = 0.5f * (source.at(first, bin) + source.at(second, bin));
+        }
+    }
+    return result;
+}
+
+uint8_t quantize(float power, float minDb, float maxDb) {
+    double db = 10.0 * std::log10(std::max(static_cast<double>(power), kPowerFloor));
+    double scaled = (db - minDb) / (maxDb - minDb) * 254.0;
+    return static_cast<uint8_t>(1 + std::clamp(static_cast<int>(std::lround(scaled)), 0, 254));
+}
+
+bool writeAll(std::FILE* file, const void* data, size_t size) {
+    return size == 0 || std::fwrite(data, 1, size, file) == size;
+}
+
+} // namespace
+
+bool writeSpectrogram(const double* samples, size_t count, double sampleRate,
+                      const SpectrogramOptions& options, const std::filesystem::path& path, std::string& error) {
+    if (options.fftSize < 16 || (options.fftSize & (options.fftSize - 1)) != 0) {
+        error = "FFT size must be a power of two";
+        return false;
+    }
+    if (options.hopSize == 0 || options.tileWidth == 0 || options.tileHeight == 0 || sampleRate <= 0) {
+        error = "Invalid spectrogram options";
+        return false;
+    }
+    if (!samples || count < options.fftSize) {
+        error = "Not enough samples for one spectrogram frame";
+        return false;
+    }
+
+    const double binHz = sampleRate / static_cast<double>(options.fftSize);
+    const size_t bins = std::min(options.fftSize / 2 + 1,
+        static_cast<size_t>(options.maxFrequency / binHz) + 1);
+
+    std::vector<PowerGrid> levels;
+    levels.push_back(computeStft(samples, count, options, bins));
+    while (levels.back().frames > options.tileWidth) {
+        levels.push_back(halveTime(levels.back()));
+    }
+
+    float peak = kPowerFloor;
+    for (float p : levels.front().power) peak = std::max(peak, p);
+    const float maxDb = static_cast<float>(10.0 * std::log10(peak));
+    const float minDb = static_cast<float>(maxDb - options.dynamicRangeDb);
+
+    SpectrogramHeader header{};
+    std::memcpy(header.magic, "BMSPEC1", 8);
+    header.version = SpectrogramVersion;
+    header.headerSize = sizeof(SpectrogramHeader);
+    header.sampleRate = static_cast<float>(sampleRate);
+    header.fftSize = static_cast<uint32_t>(options.fftSize);
+    header.hopSize = static_cast<uint32_t>(options.hopSize);
+    header.frameCount = static_cast<uint32_t>(levels.front().frames);
+    header.freqBins = static_cast<uint32_t>(bins);
+    header.binHz = static_cast<float>(binHz);
+    header.minDb = minDb;
+    header.maxDb = maxDb;
+    header.levelCount = static_cast<uint32_t>(levels.size());
+    header.tileWidth = options.tileWidth;
+    header.tileHeight = options.tileHeight;
+
+    const size_t tileBytes = static_cast<size_t>(options.tileWidth) * options.tileHeight;
+    const size_t tilesY = (bins + options.tileHeight - 1) / options.tileHeight;
+
+    std::vector<SpectrogramLevel> levelTable;
+    size_t totalTiles = 0;
+    for (const auto& level : levels) {
+        SpectrogramLevel entry{};
+        entry.frames = static_cast<uint32_t>(level.frames);
+        entry.tilesX = static_cast<uint32_t>((level.frames + options.tileWidth - 1) / options.tileWidth);
+        entry.tilesY = static_cast<uint32_t>(tilesY);
+        entry.firstTile = static_cast<uint32_t>(totalTiles);
+        totalTiles += static_cast<size_t>(entry.tilesX) * entry.tilesY;
+        levelTable.push_back(entry);
+    }
+
+    uint64_t offset = sizeof(SpectrogramHeader) + levelTable.size() * sizeof(SpectrogramLevel) +
+        totalTiles * sizeof(SpectrogramTile);
+    std::vector<SpectrogramTile> tileTable(totalTiles);
+    for (auto& tile : tileTable) {
+        tile.offset = offset;
+        tile.size = static_cast<uint32_t>(tileBytes);
+        offset += tileBytes;
+    }
+
+    const std::u8string utf8Path = path.u8string();
+    const std::string displayPath(utf8Path.begin(), utf8Path.end());
+#if defined(_WIN32)
+    std::FILE* file = _wfopen(path.c_str(), L"wb");
+#else
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+#endif
+    if (!file) {
+        error = "Cannot create " + displayPath;
+        return false;
+    }
+
+    bool ok = writeAll(file, &header, sizeof(header)) &&
+        writeAll(file, levelTable.data(), levelTable.size() * sizeof(SpectrogramLevel)) &&
+        writeAll(file, tileTable.data(), tileTable.size() * sizeof(SpectrogramTile));
+
+    std::vector<uint8_t> tile(tileBytes);
+    for (size_t l = 0; ok && l < levels.size(); ++l) {
+        const PowerGrid& grid = levels[l];
+        for (size_t ty = 0; ok && ty < levelTable[l].tilesY; ++ty) {
+            for (size_t tx = 0; ok && tx < levelTable[l].tilesX; ++tx) {
+                std::fill(tile.begin(), tile.end(), 0);
+                for (size_t row = 0; row < options.tileHeight; ++row) {
+                    size_t bin = ty * options.tileHeight + row;
+                    if (bin >= grid.bins) break;
+                    for (size_t column = 0; column < options.tileWidth; ++column) {
+                        size_t frame = tx * options.tileWidth + column;
+                        if (frame >= grid.frames) break;
+                        tile[row * options.tileWidth + column] = quantize(grid.at(frame, bin), minDb, maxDb);
+                    }
+                }
+                ok = writeAll(file, tile.data(), tile.size());
+            }
+        }
+    }
+
+    if (std::fclose(file) != 0) ok = false;
+    if (!ok) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        error = "Failed writing " + displayPath;
+    }
+    return ok;
+}
+
+} // namespace brainmirror
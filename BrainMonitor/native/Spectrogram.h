@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// STFT spectrogram written as a multi-resolution tile pyramid (.bmspec), so
+// report views can show a zoomable time-frequency image by reading only the
+// tiles on screen instead of recomputing from raw data.
+//
+// File layout (little endian):
+//   SpectrogramHeader                       64 bytes
+//   SpectrogramLevel[levelCount]            16 bytes each, level 0 = full resolution
+//   SpectrogramTile[total tiles]            16 bytes each, per level row-major (ty, tx)
+//   tile data                               tileWidth * tileHeight uint8 per tile
+//
+// A tile holds tileHeight frequency rows (lowest frequency first) of
+// tileWidth frames. Values are dB quantized over [minDb, maxDb] to 1..255;
+// 0 marks padding past the last frame or frequency bin. Each level halves the
+// time resolution of the one below (power averaged) until it fits one tile.
+namespace brainmirror {
+
+#pragma pack(push, 1)
+struct SpectrogramHeader {
+    char magic[8];              // "BMSPEC1"
+    uint32_t version;
+    uint32_t headerSize;
+    float sampleRate;
+    uint32_t fftSize;
+    uint32_t hopSize;           // Samples between level-0 frames
+    uint32_t frameCount;        // Level-0 frames
+    uint32_t freqBins;          // Rows, starting at 0 Hz
+    float binHz;
+    float minDb;
+    float maxDb;
+    uint32_t levelCount;
+    uint16_t tileWidth;
+    uint16_t tileHeight;
+    uint32_t reserved[2];
+};
+
+struct SpectrogramLevel {
+    uint32_t frames;
+    uint32_t tilesX;
+    uint32_t tilesY;
+    uint32_t firstTile;         // Index into the tile table
+};
+
+struct SpectrogramTile {
+    uint64_t offset;            // From the start of the file
+    uint32_t size;
+    uint32_t reserved;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SpectrogramHeader) == 64, "bmspec header layout");
+static_assert(sizeof(SpectrogramLevel) == 16, "bmspec level layout");
+static_assert(sizeof(SpectrogramTile) == 16, "bmspec tile layout");
+
+constexpr uint32_t SpectrogramVersion = 1;
+
+struct SpectrogramOptions {
+    size_t fftSize = 512;           // ~1 s at 520 Hz
+    size_t hopSize = 65;            // 8 frames per second at 520 Hz
+    double maxFrequency = 60.0;     // Rows above this are not stored
+    double dynamicRangeDb = 80.0;   // minDb = maxDb - dynamicRangeDb
+    uint16_t tileWidth = 256;
+    uint16_t tileHeight = 64;
+};
+
+bool writeSpectrogram(const double* samples, size_t count, double sampleRate,
+                      const SpectrogramOptions& options, const std::filesystem::path& path, std::string& error);
+
+} // namespace brainmirror
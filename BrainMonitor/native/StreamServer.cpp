@@ -0,0 +1,464 @@
+#include "StreamServer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using NativeSocket = SOCKET;
+using PollFd = WSAPOLLFD;
+using IoSlice = WSABUF;
+#define BRAINMIRROR_CLOSE_SOCKET closesocket
+#define BRAINMIRROR_POLL WSAPoll
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+using NativeSocket = int;
+using PollFd = pollfd;
+using IoSlice = iovec;
+#define BRAINMIRROR_CLOSE_SOCKET ::close
+#define BRAINMIRROR_POLL ::poll
+#endif
+
+namespace brainmirror {
+
+namespace {
+
+#if defined(_WIN32)
+struct WinsockInit {
+    WinsockInit() {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+    }
+    ~WinsockInit() { WSACleanup(); }
+};
+#endif
+
+constexpr size_t kHelloBytes = sizeof(stream::FrameHeader) + sizeof(stream::HelloPayload);
+constexpr int kMaxSlices = 64;              // Frames per scatter-gather send
+constexpr int kSendSocketBuffer = 1 << 20;
+
+uint64_t steadyNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void setSlice(IoSlice& slice, const void* data, size_t size) {
+#if defined(_WIN32)
+    slice.buf = static_cast<char*>(const_cast<void*>(data));
+    slice.len = static_cast<ULONG>(size);
+#else
+    slice.iov_base = const_cast<void*>(data);
+    slice.iov_len = size;
+#endif
+}
+
+bool setNonBlocking(NativeSocket s) {
+#if defined(_WIN32)
+    u_long enable = 1;
+    return ioctlsocket(s, FIONBIO, &enable) == 0;
+#else
+    int flags = fcntl(s, F_GETFL, 0);
+    return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+bool wouldBlock() {
+#if defined(_WIN32)
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+// Bytes sent, 0 when the socket buffer is full, -1 on a broken connection.
+long long sendSlices(NativeSocket s, IoSlice* slices, int count) {
+#if defined(_WIN32)
+    DWORD sent = 0;
+    if (WSASend(s, slices, static_cast<DWORD>(count), &sent, 0, nullptr, nullptr) == 0) return sent;
+#else
+    msghdr message{};
+    message.msg_iov = slices;
+    message.msg_iovlen = static_cast<decltype(message.msg_iovlen)>(count);
+    int flags = 0;
+#if defined(MSG_NOSIGNAL)
+    flags = MSG_NOSIGNAL;
+#endif
+    ssize_t sent = sendmsg(s, &message, flags);
+    if (sent >= 0) return sent;
+#endif
+    return wouldBlock() ? 0 : -1;
+}
+
+size_t frameBytes(const stream::FrameHeader& header) {
+    return sizeof(uint32_t) + header.size;
+}
+
+} // namespace
+
+struct StreamServer::Subscriber {
+    NativeSocket socket;
+    size_t cursor = 0;          // Next ring slot to send
+    size_t offset = 0;          // Bytes of the frame at cursor already sent
+    // Sent before the ring frames: the Hello, or the rest of a partly sent
+    // frame when the subscriber skips ahead
+    uint8_t pending[sizeof(Slot)];
+    size_t pendingSize = 0;
+    size_t pendingSent = 0;
+    bool blocked = false;
+};
+
+StreamServer::StreamServer() {
+#if defined(_WIN32)
+    static WinsockInit winsock;
+#endif
+}
+
+StreamServer::~StreamServer() {
+    stop();
+}
+
+bool StreamServer::start(const Options& options, std::string& error) {
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+    if (m_running.load()) {
+        error = "stream server is already running";
+        return false;
+    }
+    if (options.tcpPort < 0 && options.unixPath.empty()) {
+        error = "no TCP port or Unix socket path";
+        return false;
+    }
+    m_options = options;
+    if (m_options.maxSubscribers < 1) m_options.maxSubscribers = 1;
+    if (!m_ring) m_ring = std::make_unique<Slot[]>(RingSlots);
+
+    if (options.tcpPort >= 0) {
+        NativeSocket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+#if !defined(_WIN32)
+        int reuse = 1;
+        if (s >= 0) setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(options.tcpPort));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        if (s == static_cast<NativeSocket>(-1) ||
+            bind(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(s, 16) != 0 || !setNonBlocking(s) ||
+            getsockname(s, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            if (s != static_cast<NativeSocket>(-1)) BRAINMIRROR_CLOSE_SOCKET(s);
+            error = "cannot listen on 127.0.0.1:" + std::to_string(options.tcpPort);
+            return false;
+        }
+        m_tcpListener = static_cast<intptr_t>(s);
+        m_boundPort.store(ntohs(address.sin_port));
+    }
+
+    if (!options.unixPath.empty()) {
+#if defined(_WIN32)
+        closeListeners();
+        error = "Unix sockets are not supported on this platform";
+        return false;
+#else
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (options.unixPath.size() >= sizeof(address.sun_path)) {
+            closeListeners();
+            error = "Unix socket path is too long";
+            return false;
+        }
+        std::memcpy(address.sun_path, options.unixPath.c_str(), options.unixPath.size() + 1);
+        ::unlink(options.unixPath.c_str());     // Stale socket from a previous run
+
+        int s = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (s < 0 || bind(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(s, 16) != 0 || !setNonBlocking(s)) {
+            if (s >= 0) ::close(s);
+            closeListeners();
+            error = "cannot listen on " + options.unixPath;
+            return false;
+        }
+        m_unixListener = s;
+#endif
+    }
+
+    m_head.store(0);
+    m_tail.store(0);
+    m_sequence = 0;
+    m_subscribers.store(0);
+    m_stopThread.store(false);
+    m_running.store(true);
+    m_thread = std::thread(&StreamServer::senderLoop, this);
+    return true;
+}
+
+void StreamServer::stop() {
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+    if (!m_running.load()) return;
+
+    m_stopThread.store(true);
+    {
+        std::lock_guard<std::mutex> wakeLock(m_wakeMutex);
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable()) m_thread.join();
+    closeListeners();
+    m_running.store(false);
+}
+
+void StreamServer::closeListeners() {
+    if (m_tcpListener != -1) BRAINMIRROR_CLOSE_SOCKET(static_cast<NativeSocket>(m_tcpListener));
+    if (m_unixListener != -1) {
+        BRAINMIRROR_CLOSE_SOCKET(static_cast<NativeSocket>(m_unixListener));
+#if !defined(_WIN32)
+        ::unlink(m_options.unixPath.c_str());
+#endif
+    }
+    m_tcpListener = -1;
+    m_unixListener = -1;
+    m_boundPort.store(0);
+}
+
+void StreamServer::publish(int dev, int chan, const int* data, int len) {
+    if (m_subscribers.load(std::memory_order_relaxed) == 0 || len <= 0) return;
+    uint64_t arrivalNs = steadyNowNs();
+
+    while (m_producerLock.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    size_t head = m_head.load(std::memory_order_relaxed);
+    size_t slotsNeeded = static_cast<size_t>((len + MaxFrameSamples - 1) / MaxFrameSamples);
+    if (head + slotsNeeded - m_tail.load(std::memory_order_acquire) > RingSlots) {
+        // Sequence numbers still advance so subscribers see the gap
+        m_sequence += static_cast<uint32_t>(slotsNeeded);
+        m_producerLock.clear(std::memory_order_release);
+        m_dropped.fetch_add(slotsNeeded, std::memory_order_relaxed);
+        return;
+    }
+    for (int offset = 0; offset < len; offset += MaxFrameSamples) {
+        Slot& slot = m_ring[head++ & (RingSlots - 1)];
+        int count = std::min(MaxFrameSamples, len - offset);
+        slot.header.size = static_cast<uint32_t>(sizeof(stream::FrameHeader) - sizeof(uint32_t) + count * sizeof(int32_t));
+        slot.header.type = stream::Frame_Samples;
+        slot.header.device = static_cast<uint8_t>(dev);
+        slot.header.channel = static_cast<uint8_t>(chan);
+        slot.header.flags = 0;
+        slot.header.sequence = m_sequence++;
+        slot.header.sampleCount = static_cast<uint16_t>(count);
+        slot.header.reserved = 0;
+        slot.header.timestampNs = arrivalNs;
+        std::memcpy(slot.samples, data + offset, static_cast<size_t>(count) * sizeof(int32_t));
+    }
+    m_head.store(head, std::memory_order_seq_cst);
+    m_producerLock.clear(std::memory_order_release);
+    m_published.fetch_add(slotsNeeded, std::memory_order_relaxed);
+
+    // Pairs with the seq_cst m_sleeping store in senderLoop()
+    if (m_sleeping.load(std::memory_order_seq_cst)) {
+        { std::lock_guard<std::mutex> lock(m_wakeMutex); }
+        m_wake.notify_one();
+    }
+}
+
+void StreamServer::senderLoop() {
+    std::vector<Subscriber> subscribers;
+    subscribers.reserve(static_cast<size_t>(m_options.maxSubscribers));
+    std::vector<PollFd> polls;
+    IoSlice slices[kMaxSlices + 1];
+    char discard[512];
+
+    auto closeSubscriber = [&](size_t index) {
+        BRAINMIRROR_CLOSE_SOCKET(subscribers[index].socket);
+        subscribers.erase(subscribers.begin() + static_cast<std::ptrdiff_t>(index));
+        m_subscribers.store(static_cast<int>(subscribers.size()));
+    };
+
+    auto acceptFrom = [&](intptr_t listener) {
+        if (listener == -1) return;
+        for (;;) {
+            NativeSocket s = accept(static_cast<NativeSocket>(listener), nullptr, nullptr);
+            if (s == static_cast<NativeSocket>(-1)) break;
+            if (static_cast<int>(subscribers.size()) >= m_options.maxSubscribers || !setNonBlocking(s)) {
+                BRAINMIRROR_CLOSE_SOCKET(s);
+                continue;
+            }
+            int noDelay = 1;
+            setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+            int buffer = kSendSocketBuffer;
+            setsockopt(s, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&buffer), sizeof(buffer));
+#if defined(SO_NOSIGPIPE)
+            int noSigpipe = 1;
+            setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &noSigpipe, sizeof(noSigpipe));
+#endif
+
+            Subscriber subscriber;
+            subscriber.socket = s;
+            stream::FrameHeader header{};
+            header.size = static_cast<uint32_t>(kHelloBytes - sizeof(uint32_t));
+            header.type = stream::Frame_Hello;
+            header.timestampNs = steadyNowNs();
+            stream::HelloPayload hello{};
+            hello.protocolVersion = stream::ProtocolVersion;
+            hello.nominalSampleRate = 520;
+            hello.unixTimeNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+            std::memcpy(subscriber.pending, &header, sizeof(header));
+            std::memcpy(subscriber.pending + sizeof(header), &hello, sizeof(hello));
+            subscriber.pendingSize = kHelloBytes;
+
+            // Start at the live edge; the producer only writes once the count is non-zero
+            subscriber.cursor = m_head.load(std::memory_order_acquire);
+            subscribers.push_back(subscriber);
+            m_subscribers.store(static_cast<int>(subscribers.size()));
+        }
+    };
+
+    // Sends as much as the socket takes. Returns false on a broken connection.
+    auto pump = [&](Subscriber& sub, size_t head) {
+        sub.blocked = false;
+        if (head - sub.cursor > RingSlots / 2) {
+            size_t skipped = head - sub.cursor;
+            if (sub.offset > 0) {
+                // Keep the stream framed: finish the current frame first
+                const Slot& slot = m_ring[sub.cursor & (RingSlots - 1)];
+                sub.pendingSize = frameBytes(slot.header) - sub.offset;
+                sub.pendingSent = 0;
+                std::memcpy(sub.pending, reinterpret_cast<const uint8_t*>(&slot) + sub.offset, sub.pendingSize);
+                sub.offset = 0;
+                skipped--;
+            }
+            m_skipped.fetch_add(skipped, std::memory_order_relaxed);
+            sub.cursor = head;
+        }
+
+        for (int round = 0; round < 16; ++round) {
+            int count = 0;
+            if (sub.pendingSent < sub.pendingSize) {
+                setSlice(slices[count++], sub.pending + sub.pendingSent, sub.pendingSize - sub.pendingSent);
+            }
+            for (size_t i = sub.cursor; i != head && count <= kMaxSlices; ++i) {
+                const Slot& slot = m_ring[i & (RingSlots - 1)];
+                size_t skip = i == sub.cursor ? sub.offset : 0;
+                setSlice(slices[count++], reinterpret_cast<const uint8_t*>(&slot) + skip, frameBytes(slot.header) - skip);
+            }
+            if (count == 0) return true;
+
+            long long sent = sendSlices(sub.socket, slices, count);
+            if (sent < 0) return false;
+            if (sent == 0) {
+                sub.blocked = true;
+                return true;
+            }
+            m_bytesSent.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+
+            size_t remaining = static_cast<size_t>(sent);
+            if (sub.pendingSent < sub.pendingSize) {
+                size_t part = std::min(remaining, sub.pendingSize - sub.pendingSent);
+                sub.pendingSent += part;
+                remaining -= part;
+            }
+            while (remaining > 0) {
+                size_t left = frameBytes(m_ring[sub.cursor & (RingSlots - 1)].header) - sub.offset;
+                if (remaining < left) {
+                    sub.offset += remaining;
+                    break;
+                }
+                remaining -= left;
+                sub.offset = 0;
+                sub.cursor++;
+            }
+        }
+        return true;
+    };
+
+    while (!m_stopThread.load(std::memory_order_acquire)) {
+        acceptFrom(m_tcpListener);
+        acceptFrom(m_unixListener);
+
+        size_t head = m_head.load(std::memory_order_acquire);
+        size_t blocked = 0;
+        for (size_t i = 0; i < subscribers.size();) {
+            if (!pump(subscribers[i], head)) {
+                closeSubscriber(i);
+                continue;
+            }
+            if (subscribers[i].blocked) blocked++;
+            ++i;
+        }
+
+        size_t tail = head;
+        bool caughtUp = m_head.load(std::memory_order_acquire) == head;
+        for (const auto& sub : subscribers) {
+            if (head - sub.cursor > head - tail) tail = sub.cursor;
+            if (!sub.blocked && sub.cursor != head) caughtUp = false;
+        }
+        m_tail.store(tail, std::memory_order_release);
+        if (!subscribers.empty() && !caughtUp) continue;
+
+        // Wait for connections, hang-ups and, when every subscriber is
+        // blocked, writable sockets
+        bool allBlocked = !subscribers.empty() && blocked == subscribers.size();
+        polls.clear();
+        for (intptr_t listener : { m_tcpListener, m_unixListener }) {
+            if (listener != -1) polls.push_back(PollFd{ static_cast<NativeSocket>(listener), POLLIN, 0 });
+        }
+        size_t firstSubscriber = polls.size();
+        for (const auto& sub : subscribers) {
+            polls.push_back(PollFd{ sub.socket, static_cast<short>(sub.blocked ? POLLOUT : POLLIN), 0 });
+        }
+        int timeoutMs = subscribers.empty() ? 100 : (allBlocked ? 2 : 0);
+        BRAINMIRROR_POLL(polls.data(), static_cast<unsigned long>(polls.size()), timeoutMs);
+
+        // Subscribers never send; readable means data to discard or a hang-up
+        for (size_t i = subscribers.size(); i-- > 0;) {
+            short revents = polls[firstSubscriber + i].revents;
+            if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                closeSubscriber(i);
+            }
+            else if (!subscribers[i].blocked && (revents & POLLIN)) {
+                auto received = recv(subscribers[i].socket, discard, sizeof(discard), 0);
+                if (received == 0 || (received < 0 && !wouldBlock())) closeSubscriber(i);
+            }
+        }
+
+        if (!subscribers.empty() && !allBlocked) {
+            // Blocked subscribers are retried every millisecond; the others
+            // are woken by publish()
+            auto timeout = std::chrono::milliseconds(blocked > 0 ? 1 : 20);
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_sleeping.store(true, std::memory_order_seq_cst);
+            m_wake.wait_for(lock, timeout, [this, head]() {
+                return m_head.load(std::memory_order_seq_cst) != head || m_stopThread.load();
+            });
+            m_sleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    for (auto& sub : subscribers) BRAINMIRROR_CLOSE_SOCKET(sub.socket);
+    m_subscribers.store(0);
+}
+
+StreamServer::Stats StreamServer::stats() const {
+    Stats stats;
+    stats.running = m_running.load();
+    stats.tcpPort = m_boundPort.load();
+    stats.subscribers = m_subscribers.load();
+    stats.published = m_published.load();
+    stats.dropped = m_dropped.load();
+    stats.skipped = m_skipped.load();
+    stats.bytesSent = m_bytesSent.load();
+    return stats;
+}
+
+} // namespace brainmirror
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Local streaming endpoint for live raw data. External monitors, recorders
+// and research tools connect over TCP on 127.0.0.1 (or a Unix domain socket
+// on POSIX) and receive every raw packet the SDK sees.
+//
+// The acquisition thread writes each packet once into a preallocated ring of
+// ready-to-send frames and returns; it does no socket work and its cost does
+// not depend on the number of subscribers. A single sender thread writes the
+// frames to every subscriber with scatter-gather sends straight from the ring
+// slots. Each subscriber has its own cursor; one that falls too far behind
+// skips ahead (visible as a sequence gap) instead of holding the ring.
+//
+// Wire format, little-endian: every frame starts with a FrameHeader. The
+// first frame on a connection is a Hello, then Samples frames follow.
+namespace brainmirror {
+namespace stream {
+
+constexpr uint32_t ProtocolVersion = 1;
+
+enum FrameType : uint8_t {
+    Frame_Hello = 0,
+    Frame_Samples = 1,      // Payload: sampleCount int32 raw samples
+};
+
+struct FrameHeader {
+    uint32_t size;          // Bytes after this field (rest of header + payload)
+    uint8_t type;
+    uint8_t device;         // Connect index
+    uint8_t channel;
+    uint8_t flags;          // Reserved, 0
+    uint32_t sequence;      // Consecutive per server; a gap means frames were lost
+    uint16_t sampleCount;
+    uint16_t reserved;
+    uint64_t timestampNs;   // Steady clock at arrival in the SDK raw data callback
+};
+static_assert(sizeof(FrameHeader) == 24, "stream frame header layout");
+
+// Follows the Hello header. unixTimeNs is the wall clock at the header's
+// timestampNs, so clients can map frame timestamps to wall time.
+struct HelloPayload {
+    uint32_t protocolVersion;
+    uint32_t nominalSampleRate;
+    uint64_t unixTimeNs;
+};
+static_assert(sizeof(HelloPayload) == 16, "stream hello layout");
+
+} // namespace stream
+
+class StreamServer {
+public:
+    static constexpr int MaxFrameSamples = 64;      // Longer packets are split
+    static constexpr size_t RingSlots = 4096;       // Power of two
+
+    struct Options {
+        int tcpPort = 0;            // -1: no TCP listener, 0: any free port
+        std::string unixPath;       // Empty: no Unix socket (POSIX only)
+        int maxSubscribers = 8;
+    };
+
+    struct Stats {
+        bool running = false;
+        int tcpPort = 0;            // Bound port, 0 when not listening on TCP
+        int subscribers = 0;
+        uint64_t published = 0;     // Frames written to the ring
+        uint64_t dropped = 0;       // Ring full (sender stalled)
+        uint64_t skipped = 0;       // Frames slow subscribers skipped
+        uint64_t bytesSent = 0;
+    };
+
+    StreamServer();
+    ~StreamServer();
+    StreamServer(const StreamServer&) = delete;
+    StreamServer& operator=(const StreamServer&) = delete;
+
+    bool start(const Options& options, std::string& error);
+    void stop();
+
+    // Acquisition thread. Returns immediately when nobody is subscribed;
+    // never allocates or blocks.
+    void publish(int dev, int chan, const int* data, int len);
+
+    Stats stats() const;
+
+private:
+    struct Slot {
+        stream::FrameHeader header;
+        int32_t samples[MaxFrameSamples];
+    };
+    struct Subscriber;
+
+    std::mutex m_controlMutex;      // start() / stop()
+    Options m_options;
+    std::unique_ptr<Slot[]> m_ring;
+    intptr_t m_tcpListener = -1;
+    intptr_t m_unixListener = -1;
+    std::atomic<int> m_boundPort{ 0 };
+
+    alignas(64) std::atomic<size_t> m_head{ 0 };    // Next slot to write
+    alignas(64) std::atomic<size_t> m_tail{ 0 };    // Oldest slot a subscriber still needs
+    alignas(64) std::atomic_flag m_producerLock = ATOMIC_FLAG_INIT;
+    uint32_t m_sequence = 0;                        // Guarded by m_producerLock
+
+    std::atomic<int> m_subscribers{ 0 };
+    std::atomic<bool> m_running{ false };
+    std::atomic<bool> m_stopThread{ false };
+    std::atomic<bool> m_sleeping{ false };
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::thread m_thread;
+
+    std::atomic<uint64_t> m_published{ 0 };
+    std::atomic<uint64_t> m_dropped{ 0 };
+    std::atomic<uint64_t> m_skipped{ 0 };
+    std::atomic<uint64_t> m_bytesSent{ 0 };
+
+    void senderLoop();
+    void closeListeners();
+};
+
+} // namespace brainmirror
@@ -0,0 +1,147 @@
+#include "ThreadAffinity.h"
+
+#include <thread>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#endif
+
+namespace brainmirror {
+
+namespace {
+
+std::vector<int> allCpus() {
+    unsigned count = std::thread::hardware_concurrency();
+    if (count == 0) count = 1;
+    std::vector<int> cpus;
+    for (unsigned i = 0; i < count; ++i) {
+        cpus.push_back(static_cast<int>(i));
+    }
+    return cpus;
+}
+
+#if !defined(_WIN32)
+// Parses sysfs cpulist syntax, e.g. "0-3,8-11".
+std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream stream(text);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        size_t dash = range.find('-');
+        try {
+            if (dash == std::string::npos) {
+                cpus.push_back(std::stoi(range));
+            }
+            else {
+                int first = std::stoi(range.substr(0, dash));
+                int last = std::stoi(range.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+        catch (...) {
+            // Ignore malformed entries
+        }
+    }
+    return cpus;
+}
+#endif
+
+} // namespace
+
+std::vector<std::vector<int>> numaNodeCpus() {
+    std::vector<std::vector<int>> nodes;
+
+#if defined(_WIN32)
+    ULONG highestNode = 0;
+    if (GetNumaHighestNodeNumber(&highestNode)) {
+        for (ULONG node = 0; node <= highestNode; ++node) {
+            ULONGLONG mask = 0;
+            if (!GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &mask) || mask == 0) continue;
+            std::vector<int> cpus;
+            for (int cpu = 0; cpu < 64; ++cpu) {
+                if (mask & (1ull << cpu)) cpus.push_back(cpu);
+            }
+            nodes.push_back(cpus);
+        }
+    }
+#else
+    // Node IDs can be sparse (offlined or hot-plugged nodes), so list them
+    std::vector<std::pair<int, std::filesystem::path>> nodeDirs;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+            !std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            continue;
+        }
+        nodeDirs.emplace_back(std::atoi(name.c_str() + 4), entry.path());
+    }
+    std::sort(nodeDirs.begin(), nodeDirs.end());
+    for (const auto& node : nodeDirs) {
+        std::ifstream file(node.second / "cpulist");
+        if (!file) continue;
+        std::string text;
+        std::getline(file, text);
+        std::vector<int> cpus = parseCpuList(text);
+        if (!cpus.empty()) nodes.push_back(cpus);
+    }
+#endif
+
+    if (nodes.empty()) {
+        nodes.push_back(allCpus());
+    }
+    return nodes;
+}
+
+bool pinCurrentThread(const std::vector<int>& cpus) {
+    if (cpus.empty()) return false;
+
+#if defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) mask |= DWORD_PTR(1) << cpu;
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+}
+
+std::vector<int> cpusFromMask(uint64_t mask) {
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < 64; ++cpu) {
+        if (mask & (1ull << cpu)) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+bool setCurrentThreadPriority(int priority) {
+    if (priority < 1 || priority > 99) return false;
+
+#if defined(_WIN32)
+    return SetThreadPriority(GetCurrentThread(),
+        priority >= 50 ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_HIGHEST) != 0;
+#else
+    sched_param param{};
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#endif
+}
+
+} // namespace brainmirror
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace brainmirror {
+
+// CPUs grouped by NUMA node. Always returns at least one node; on platforms
+// without topology information that node lists every logical CPU.
+std::vector<std::vector<int>> numaNodeCpus();
+
+// Restricts the calling thread to the given logical CPUs. Returns false if
+// the platform refuses or the list is empty.
+bool pinCurrentThread(const std::vector<int>& cpus);
+
+// Logical CPUs set in a 64-bit mask (bit n = CPU n).
+std::vector<int> cpusFromMask(uint64_t mask);
+
+// Raises the calling thread to real-time priority `priority` (1-99):
+// SCHED_FIFO on Linux, which needs CAP_SYS_NICE or an rtprio limit;
+// on Windows 1-49 maps to THREAD_PRIORITY_HIGHEST and 50-99 to
+// THREAD_PRIORITY_TIME_CRITICAL. Returns false if the platform refuses.
+bool setCurrentThreadPriority(int priority);
+
+} // namespace brainmirror
@@ -0,0 +1,114 @@
+#include "WorkStealingPool.h"
+#include "ThreadAffinity.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace brainmirror {
+
+namespace {
+
+struct alignas(64) WorkRange {
+    std::mutex mutex;
+    size_t begin = 0;
+    size_t end = 0;
+    size_t node = 0;
+};
+
+bool takeOwn(WorkRange& range, size_t& index) {
+    std::lock_guard<std::mutex> lock(range.mutex);
+    if (range.begin >= range.end) return false;
+    index = range.begin++;
+    return true;
+}
+
+// Moves the upper half of the victim's remaining slice into thief.
+bool steal(WorkRange& victim, WorkRange& thief) {
+    size_t stolenBegin = 0, stolenEnd = 0;
+    {
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        size_t remaining = victim.end - victim.begin;
+        if (victim.begin >= victim.end) return false;
+        size_t mid = victim.begin + remaining / 2;
+        stolenBegin = mid;
+        stolenEnd = victim.end;
+        victim.end = mid;
+    }
+    std::lock_guard<std::mutex> lock(thief.mutex);
+    thief.begin = stolenBegin;
+    thief.end = stolenEnd;
+    return true;
+}
+
+size_t remainingWork(WorkRange& range) {
+    std::lock_guard<std::mutex> lock(range.mutex);
+    return range.end > range.begin ? range.end - range.begin : 0;
+}
+
+} // namespace
+
+void parallelFor(size_t count, const ParallelOptions& options,
+                 const std::function<void(size_t index, unsigned worker)>& body) {
+    if (count == 0) return;
+
+    unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    threads = static_cast<unsigned>(std::min<size_t>(threads, count));
+
+    std::vector<std::vector<int>> nodes;
+    if (options.numaAware) nodes = numaNodeCpus();
+
+    std::vector<std::unique_ptr<WorkRange>> ranges;
+    for (unsigned w = 0; w < threads; ++w) {
+        auto range = std::make_unique<WorkRange>();
+        range->begin = count * w / threads;
+        range->end = count * (w + 1) / threads;
+        range->node = nodes.empty() ? 0 : w % nodes.size();
+        ranges.push_back(std::move(range));
+    }
+
+    auto worker = [&](unsigned self) {
+        WorkRange& own = *ranges[self];
+        if (nodes.size() > 1) {
+            pinCurrentThread(nodes[own.node]);
+        }
+
+        for (;;) {
+            size_t index = 0;
+            if (takeOwn(own, index)) {
+                body(index, self);
+                continue;
+            }
+
+            // Prefer the busiest victim on our node, then anywhere
+            WorkRange* victim = nullptr;
+            size_t best = 0;
+            for (int pass = 0; pass < 2 && !victim; ++pass) {
+                for (unsigned w = 0; w < threads; ++w) {
+                    if (w == self) continue;
+                    if (pass == 0 && ranges[w]->node != own.node) continue;
+                    size_t remaining = remainingWork(*ranges[w]);
+                    if (remaining > best) {
+                        best = remaining;
+                        victim = ranges[w].get();
+                    }
+                }
+            }
+            if (!victim) break;
+            steal(*victim, own);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w < threads; ++w) {
+        pool.emplace_back(worker, w);
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+} // namespace brainmirror
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace brainmirror {
+
+struct ParallelOptions {
+    unsigned threads = 0;       // 0 = hardware concurrency
+    bool numaAware = true;      // Pin workers to NUMA nodes, steal within a node first
+};
+
+// Runs body(index, worker) for every index in [0, count) and returns when all
+// are done. Each worker starts with a contiguous slice of the index space and
+// steals half of the largest remaining slice when it runs dry. Buffers a
+// worker allocates inside body are first touched on that worker's node.
+void parallelFor(size_t count, const ParallelOptions& options,
+                 const std::function<void(size_t index, unsigned worker)>& body);
+
+} // namespace brainmirror
@@ -0,0 +1,162 @@
+// blogdump : decodes binary log files written by BrainMirrorSDK (SDK_StartLogging)
+// into readable text. Usage: blogdump [--raw-order] file.blog [file.blog ...]
+
+#include "BinaryLog.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace brainmirror::blog;
+
+struct Format {
+    int argc = 0;
+    std::string text;
+};
+
+// Number of arguments the format consumes, or -1 when it uses anything but
+// %lld, %llx and %%. Format text comes from the file, so it is never handed
+// to printf unchecked.
+static int formatArgumentCount(const std::string& text)
+{
+    int count = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '%') continue;
+        if (text.compare(i, 2, "%%") == 0) {
+            i += 1;
+        }
+        else if (text.compare(i, 4, "%lld") == 0 || text.compare(i, 4, "%llx") == 0) {
+            i += 3;
+            count++;
+        }
+        else {
+            return -1;
+        }
+    }
+    return count;
+}
+
+static void formatRecord(const Format& format, const Record& record, char* out, size_t size)
+{
+    const char* f = format.text.c_str();
+    const long long* a = reinterpret_cast<const long long*>(record.args);
+    const int argc = std::min<int>(record.argc, kMaxArgs);
+    if (formatArgumentCount(format.text) != argc) {
+        int used = snprintf(out, size, "[bad format for message %u]", record.id);
+        for (int i = 0; i < argc && used >= 0 && static_cast<size_t>(used) < size; ++i) {
+            used += snprintf(out + used, size - used, " %lld", a[i]);
+        }
+        return;
+    }
+    if (argc == 0) {
+        // Only %% conversions left
+        size_t length = 0;
+        for (size_t i = 0; i < format.text.size() && length + 1 < size; ++i) {
+            out[length++] = format.text[i];
+            if (format.text[i] == '%') ++i;
+        }
+        out[length] = '\0';
+        return;
+    }
+    switch (argc) {
+    case 1: snprintf(out, size, f, a[0]); break;
+    case 2: snprintf(out, size, f, a[0], a[1]); break;
+    case 3: snprintf(out, size, f, a[0], a[1], a[2]); break;
+    case 4: snprintf(out, size, f, a[0], a[1], a[2], a[3]); break;
+    case 5: snprintf(out, size, f, a[0], a[1], a[2], a[3], a[4]); break;
+    default: snprintf(out, size, f, a[0], a[1], a[2], a[3], a[4], a[5]); break;
+    }
+}
+
+static bool dumpFile(const char* path, bool keepOrder)
+{
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    FileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        std::memcmp(header.magic, kFileMagic, sizeof(header.magic)) != 0 ||
+        header.version != kFileVersion) {
+        fprintf(stderr, "%s: not a BrainMirror binary log\n", path);
+        std::fclose(file);
+        return false;
+    }
+
+    std::map<int, Format> formats;
+    for (uint32_t i = 0; i < header.formatCount; ++i) {
+        FormatEntry entry{};
+        if (std::fread(&entry, sizeof(entry), 1, file) != 1) break;
+        Format format;
+        format.argc = entry.argc;
+        format.text.resize(entry.length);
+        if (entry.length && std::fread(&format.text[0], 1, entry.length, file) != entry.length) break;
+        formats[entry.id] = format;
+    }
+
+    std::vector<Record> records;
+    Record record{};
+    while (std::fread(&record, sizeof(record), 1, file) == 1) {
+        records.push_back(record);
+    }
+    std::fclose(file);
+
+    // Threads are flushed one buffer at a time, so restore global time order.
+    if (!keepOrder) {
+        std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+            return a.timestampNs < b.timestampNs;
+        });
+    }
+
+    char text[512];
+    for (const auto& r : records) {
+        int64_t wallNs = header.wallClockNs + (static_cast<int64_t>(r.timestampNs) - header.steadyNs);
+        std::time_t seconds = static_cast<std::time_t>(wallNs / 1000000000);
+        std::tm local{};
+#if defined(_WIN32)
+        localtime_s(&local, &seconds);
+#else
+        localtime_r(&seconds, &local);
+#endif
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+
+        auto it = formats.find(r.id);
+        if (it == formats.end()) {
+            snprintf(text, sizeof(text), "[unknown message %u]", r.id);
+        }
+        else {
+            formatRecord(it->second, r, text, sizeof(text));
+        }
+        printf("%s.%06lld t%u %s\n", stamp, static_cast<long long>((wallNs / 1000) % 1000000), r.threadId, text);
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    bool keepOrder = false;
+    int files = 0;
+    bool ok = true;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--raw-order") == 0) {
+            keepOrder = true;
+            continue;
+        }
+        ok = dumpFile(argv[i], keepOrder) && ok;
+        files++;
+    }
+
+    if (files == 0) {
+        fprintf(stderr, "Usage: blogdump [--raw-order] file.blog [file.blog ...]\n");
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
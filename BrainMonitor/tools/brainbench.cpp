@@ -0,0 +1,774 @@
+// brainbench : performance suite for the BrainMirrorSDK hot paths, driven by
+// the simulated device backend (BRAINMIRROR_SIM_BACKEND).
+//
+// Usage: brainbench [--filter text] [--min-time seconds] [--json file]
+//                   [--compare baseline.json] [--threshold percent]
+//
+// Every case reports latency percentiles per operation and items/s. --json
+// writes machine-readable results; --compare checks p50 against a previous
+// run and exits with 3 when any case regressed by more than --threshold.
+// When the SDK is built with BRAINMIRROR_ALLOC_AUDIT, the callback cases also
+// report heap allocations made inside SDK callbacks and the run exits with 4
+// if the steady state allocated at all. accuracy/fixed_point exits with 5
+// when the fixed-point pipeline drifts past live::FixedRelativeErrorBound.
+
+#include "BrainMonitorWrapper.h"
+#include "BrainwaveAnalysis.h"
+#include "Connectivity.h"
+#include "EdfWriter.h"
+#include "FixedPipeline.h"
+#include "LivePipeline.h"
+#include "SessionJournal.h"
+#include "SessionRecorder.h"
+#include "SimBackend.h"
+#include "StreamServer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace brainmirror;
+using Clock = std::chrono::steady_clock;
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations = 0;
+    double itemsPerSecond = 0.0;
+    double meanNs = 0.0;
+    double p50Ns = 0.0;
+    double p90Ns = 0.0;
+    double p99Ns = 0.0;
+    double maxNs = 0.0;
+    std::map<std::string, double> counters;
+};
+
+struct BenchOptions {
+    std::string filter;
+    double minTime = 0.5;
+};
+
+static BenchOptions g_options;
+static std::vector<BenchResult> g_results;
+
+static double percentile(std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) return 0.0;
+    size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static void report(const BenchResult& result);
+
+static void record(BenchResult result, std::vector<double>& samples)
+{
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double s : samples) sum += s;
+    result.meanNs = samples.empty() ? 0.0 : sum / samples.size();
+    result.p50Ns = percentile(samples, 0.50);
+    result.p90Ns = percentile(samples, 0.90);
+    result.p99Ns = percentile(samples, 0.99);
+    result.maxNs = samples.empty() ? 0.0 : samples.back();
+    report(result);
+}
+
+static void report(const BenchResult& result)
+{
+    printf("%-48s %12.0f %12.0f %12.0f %12llu %14.0f\n", result.name.c_str(),
+        result.p50Ns, result.p90Ns, result.p99Ns,
+        static_cast<unsigned long long>(result.iterations), result.itemsPerSecond);
+    for (const auto& counter : result.counters) {
+        printf("    %-44s %.3f\n", counter.first.c_str(), counter.second);
+    }
+    fflush(stdout);
+    g_results.push_back(result);
+}
+
+static bool selected(const std::string& name)
+{
+    return g_options.filter.empty() || name.find(g_options.filter) != std::string::npos;
+}
+
+// Times op() repeatedly for at least --min-time. Cheap operations are batched
+// so each timed sample spans at least ~2 us; percentiles are per operation.
+static void measure(const std::string& name, double itemsPerOp, const std::function<void()>& op)
+{
+    if (!selected(name)) return;
+
+    for (int i = 0; i < 3; ++i) op();     // Warm-up
+
+    int batch = 1;
+    for (;;) {
+        auto start = Clock::now();
+        for (int i = 0; i < batch; ++i) op();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (ns >= 2000.0 || batch >= (1 << 20)) break;
+        batch *= 2;
+    }
+
+    std::vector<double> samples;
+    samples.reserve(1 << 16);
+    uint64_t ops = 0;
+    auto begin = Clock::now();
+    double elapsed = 0.0;
+    while (elapsed < g_options.minTime || samples.size() < 10) {
+        auto start = Clock::now();
+        for (int i = 0; i < batch; ++i) op();
+        auto end = Clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() / batch);
+        ops += batch;
+        elapsed = std::chrono::duration<double>(end - begin).count();
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = ops;
+    result.itemsPerSecond = elapsed > 0 ? static_cast<double>(ops) * itemsPerOp / elapsed : 0.0;
+    record(result, samples);
+}
+
+// ---------------------------------------------------------------------------
+// SDK fixtures
+// ---------------------------------------------------------------------------
+
+static std::atomic<uint64_t> g_callbackSamples{ 0 };
+static int g_allocationFailures = 0;
+static int g_accuracyFailures = 0;
+
+// Attaches the callback-thread allocation count since the last
+// SDK_ResetAllocationAudit to the most recent result (audit builds only).
+static void recordAllocations()
+{
+    AllocationAudit audit{};
+    if (!SDK_GetAllocationAudit(&audit) || !audit.enabled || g_results.empty()) return;
+    BenchResult& result = g_results.back();
+    result.counters["hot_path_allocations"] = static_cast<double>(audit.allocations);
+    result.counters["arena_growths"] = audit.arenaGrowths;
+    if (audit.allocations > 0) {
+        fprintf(stderr, "%s: %llu heap allocations (%llu bytes) in SDK callbacks\n", result.name.c_str(),
+            audit.allocations, audit.bytes);
+        g_allocationFailures++;
+    }
+}
+
+static void countingRawCallback(int, int, int*, int len)
+{
+    g_callbackSamples.fetch_add(static_cast<uint64_t>(len), std::memory_order_relaxed);
+}
+
+static void resetSdk()
+{
+    DeviceInfo info{};
+    while (SDK_GetConnectedDevicesCount() > 0 && SDK_GetConnectedDevice(0, &info)) {
+        if (!SDK_DisconnectDevice(info.mac)) break;
+    }
+    SDK_StopDataCollection();
+    SDK_DisconnectPort();
+    SDK_Cleanup();
+}
+
+static bool setupSdk(int devices, bool realtime, bool connect)
+{
+    resetSdk();
+    sim::SimConfig config;
+    config.deviceCount = devices;
+    config.realtime = realtime;
+    sim::configure(config);
+
+    if (!SDK_Init()) return false;
+    SDK_SetRawDataCallback(countingRawCallback);
+    if (!SDK_ConnectPort(SDK_CheckPort())) return false;
+    if (!SDK_ScanDevices()) return false;
+
+    if (connect) {
+        for (int i = 0; i < SDK_GetScanDevicesCount(); ++i) {
+            DeviceInfo info{};
+            SDK_GetScanDevice(i, &info);
+            SDK_ConnectDevice(info.mac, info.type);
+        }
+    }
+    return true;
+}
+
+static std::vector<double> syntheticEeg(size_t count)
+{
+    std::vector<double> data(count);
+    unsigned rng = 7;
+    for (size_t i = 0; i < count; ++i) {
+        double t = static_cast<double>(i) / analysis::SamplingRate;
+        rng = rng * 1664525u + 1013904223u;
+        double noise = (static_cast<double>(rng >> 8) / 16777216.0 - 0.5) * 20.0;
+        data[i] = 30.0 * std::sin(2.0 * 3.14159265358979 * 10.0 * t) + 20.0 * std::sin(2.0 * 3.14159265358979 * 6.0 * t) + noise;
+    }
+    return data;
+}
+
+// ---------------------------------------------------------------------------
+// Cases
+// ---------------------------------------------------------------------------
+
+static void benchCallbackDispatch()
+{
+    for (int devices : { 1, 4, 16 }) {
+        std::string name = "callback/raw_dispatch/devices:" + std::to_string(devices);
+        if (!selected(name)) continue;
+        setupSdk(devices, false, true);
+
+        int packet[13];
+        for (int i = 0; i < 13; ++i) packet[i] = i * 3 - 20;
+        auto deliver = [&]() {
+            for (int dev = 0; dev < devices; ++dev) {
+                sim::deliverRawPacket(dev, 0, packet, 13);
+            }
+        };
+        // Warm up past the first analysis window before counting allocations
+        for (int i = 0; i < 100; ++i) deliver();
+        SDK_ResetAllocationAudit(0);
+        measure(name, devices, deliver);
+        recordAllocations();
+    }
+}
+
+static void benchDeviceQueries()
+{
+    for (int devices : { 1, 16 }) {
+        std::string suffix = "/devices:" + std::to_string(devices);
+        setupSdk(devices, false, false);
+
+        DeviceInfo info{};
+        measure("device/get_scan_device" + suffix, devices, [&]() {
+            for (int i = 0; i < devices; ++i) SDK_GetScanDevice(i, &info);
+        });
+        measure("device/scan_devices" + suffix, 1, []() {
+            SDK_ScanDevices();
+        });
+
+        setupSdk(devices, false, true);
+        measure("device/get_connected_device" + suffix, devices, [&]() {
+            for (int i = 0; i < devices; ++i) SDK_GetConnectedDevice(i, &info);
+        });
+        measure("device/get_connected_count" + suffix, 1, []() {
+            SDK_GetConnectedDevicesCount();
+        });
+    }
+}
+
+static void benchBandIndex()
+{
+    BrainwaveAnalyzer analyzer;
+    for (int seconds : { 10, 60, 180 }) {
+        std::string name = "dsp/band_index/seconds:" + std::to_string(seconds);
+        if (!selected(name)) continue;
+        std::vector<double> data = syntheticEeg(static_cast<size_t>(analysis::SamplingRate * seconds));
+        measure(name, static_cast<double>(data.size()), [&]() {
+            analyzer.processClosedEyesData(data);
+        });
+    }
+}
+
+// Per-packet cost of the compile-time specialized live pipeline, including
+// the once-per-second window analysis amortized over its 40 packets.
+static void benchLivePipeline()
+{
+    for (live::Arithmetic arithmetic : { live::Arithmetic::Float, live::Arithmetic::Fixed }) {
+        Arena arena;
+        auto pipeline = live::createPipeline(0, arena, arithmetic);
+        std::string name = std::string("dsp/live_pipeline/profile:") + pipeline->profileName();
+        if (arithmetic == live::Arithmetic::Fixed) name += "/fixed";
+        if (!selected(name)) continue;
+
+        std::vector<double> signal = syntheticEeg(static_cast<size_t>(analysis::SamplingRate) * 4);
+        std::vector<int> packets(signal.begin(), signal.end());
+        size_t offset = 0;
+        measure(name, 13, [&]() {
+            pipeline->push(0, packets.data() + offset, 13);
+            offset += 13;
+            if (offset + 13 > packets.size()) offset = 0;
+        });
+    }
+}
+
+// Feeds the same packets to the double and fixed-point pipelines and checks
+// the largest difference in relative band power against
+// FixedRelativeErrorBound. The signals cover normal amplitude, clipping and a
+// quiet recording of a few uV, where quantization matters most. The timed
+// operation is the fixed pipeline over the 60 s quiet signal.
+static void benchFixedPointAccuracy()
+{
+    Arena arena;
+    auto reference = live::createPipeline(0, arena, live::Arithmetic::Float);
+    auto fixed = live::createPipeline(0, arena, live::Arithmetic::Fixed);
+    std::string name = std::string("accuracy/fixed_point/profile:") + fixed->profileName();
+    if (!selected(name)) return;
+
+    std::vector<double> base = syntheticEeg(static_cast<size_t>(analysis::SamplingRate) * 60);
+    double maxRelativeError = 0.0;
+    double maxTotalError = 0.0;
+    uint64_t windows = 0;
+    std::vector<int> quiet;
+    for (double gain : { 1.0, 4.0, 0.1 }) {
+        std::vector<int> packets(base.size());
+        for (size_t i = 0; i < base.size(); ++i) packets[i] = static_cast<int>(std::lround(base[i] * gain));
+        reference->requestReset();
+        fixed->requestReset();
+
+        for (size_t offset = 0; offset + 13 <= packets.size(); offset += 13) {
+            bool a = reference->push(0, packets.data() + offset, 13);
+            bool b = fixed->push(0, packets.data() + offset, 13);
+            if (!a || !b) continue;
+
+            live::BandPower expected, actual;
+            reference->latest(0, expected);
+            fixed->latest(0, actual);
+            for (int band = 0; band < live::BandCount; ++band) {
+                maxRelativeError = std::max(maxRelativeError,
+                    static_cast<double>(std::fabs(expected.relative[band] - actual.relative[band])));
+            }
+            if (expected.totalPower > 0.0f) {
+                maxTotalError = std::max(maxTotalError,
+                    std::fabs(static_cast<double>(actual.totalPower) / expected.totalPower - 1.0));
+            }
+            windows++;
+        }
+        if (gain < 1.0) quiet = packets;
+    }
+
+    measure(name, static_cast<double>(quiet.size()), [&]() {
+        fixed->requestReset();
+        for (size_t offset = 0; offset + 13 <= quiet.size(); offset += 13) {
+            fixed->push(0, quiet.data() + offset, 13);
+        }
+    });
+
+    BenchResult& result = g_results.back();
+    result.counters["windows_compared"] = static_cast<double>(windows);
+    result.counters["max_relative_band_error"] = maxRelativeError;
+    result.counters["max_total_power_error"] = maxTotalError;
+    result.counters["error_bound"] = live::FixedRelativeErrorBound;
+    printf("    %-44s %.6f (bound %.3f)\n", "max_relative_band_error", maxRelativeError, live::FixedRelativeErrorBound);
+    if (windows == 0 || maxRelativeError > live::FixedRelativeErrorBound) {
+        fprintf(stderr, "%s: fixed-point band power differs by %.6f\n", name.c_str(), maxRelativeError);
+        g_accuracyFailures++;
+    }
+}
+
+// Full connectivity matrices (coherence, PLV, correlation) for a 60 s phase;
+// items are channel pairs.
+static void benchConnectivity()
+{
+    ConnectivityEngine engine;
+    ConnectivityResult result;
+    std::string error;
+    std::vector<double> base = syntheticEeg(static_cast<size_t>(analysis::SamplingRate) * 61);
+    const size_t length = static_cast<size_t>(analysis::SamplingRate) * 60;
+
+    for (int channels : { 8, 16, 32 }) {
+        std::string name = "dsp/connectivity/channels:" + std::to_string(channels) + "/seconds:60";
+        if (!selected(name)) continue;
+
+        // Shifted copies so every pair has a distinct phase relation
+        std::vector<const double*> pointers(channels);
+        for (int c = 0; c < channels; ++c) pointers[c] = base.data() + c * 7;
+        measure(name, channels * (channels - 1) / 2.0, [&]() {
+            engine.compute(pointers.data(), channels, length, analysis::SamplingRate, ConnectivityOptions(), result, error);
+        });
+    }
+}
+
+static void benchEdfWrite()
+{
+    std::string path = (std::filesystem::temp_directory_path() / "brainbench.edf").string();
+    for (int seconds : { 60, 180 }) {
+        std::string name = "edf/write/seconds:" + std::to_string(seconds);
+        if (!selected(name)) continue;
+        std::vector<double> data = syntheticEeg(static_cast<size_t>(analysis::SamplingRate * seconds));
+        measure(name, static_cast<double>(data.size()), [&]() {
+            EdfWriter writer;
+            writer.open(path);
+            for (size_t offset = 0; offset < data.size(); offset += 13) {
+                writer.addSamples(data.data() + offset, std::min<size_t>(13, data.size() - offset));
+            }
+            writer.finish();
+        });
+    }
+    std::remove(path.c_str());
+}
+
+// Full-rate acquisition: every connected device streams at 520 Hz through the
+// real SDK callback chain. Latency is sim packet creation -> user callback.
+static std::vector<double> g_latencies;
+static std::atomic<size_t> g_latencyCount{ 0 };
+
+static void latencyRawCallback(int, int, int*, int len)
+{
+    g_callbackSamples.fetch_add(static_cast<uint64_t>(len), std::memory_order_relaxed);
+    uint64_t created = sim::currentPacketTimestampNs();
+    if (created == 0) return;
+    uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count());
+    size_t index = g_latencyCount.fetch_add(1, std::memory_order_relaxed);
+    if (index < g_latencies.size()) g_latencies[index] = static_cast<double>(now - created);
+}
+
+static void benchFullRate()
+{
+    for (int devices : { 1, 16 }) {
+        std::string name = "acquisition/full_rate/devices:" + std::to_string(devices);
+        if (!selected(name)) continue;
+        setupSdk(devices, true, true);
+
+        double seconds = std::max(2.0, g_options.minTime);
+        g_latencies.assign(static_cast<size_t>(devices * 60 * seconds) + 1024, 0.0);
+        g_latencyCount = 0;
+        g_callbackSamples = 0;
+        SDK_SetRawDataCallback(latencyRawCallback);
+
+        SDK_ResetAllocationAudit(0);
+        auto start = Clock::now();
+        SDK_StartDataCollection();
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        SDK_StopDataCollection();
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        size_t count = std::min(g_latencyCount.load(), g_latencies.size());
+        std::vector<double> samples(g_latencies.begin(), g_latencies.begin() + count);
+
+        BenchResult result;
+        result.name = name;
+        result.iterations = count;
+        result.itemsPerSecond = g_callbackSamples.load() / elapsed;
+        result.counters["expected_samples_per_second"] = 520.0 * devices;
+        record(result, samples);
+        recordAllocations();
+        SDK_SetRawDataCallback(countingRawCallback);
+    }
+}
+
+// Real-time mode: latency from packet arrival in the SDK callback to finished
+// band-power processing, from the SDK's own histogram (microsecond buckets)
+static void benchRealtime()
+{
+    struct Mode {
+        const char* name;
+        bool offload;
+        bool busyPoll;
+    };
+    static const Mode kModes[] = {
+        { "inline", false, false },
+        { "offload", true, false },
+        { "offload_busy_poll", true, true },
+    };
+
+    for (const Mode& mode : kModes) {
+        std::string name = std::string("acquisition/realtime/") + mode.name + "/devices:16";
+        if (!selected(name)) continue;
+        setupSdk(16, true, true);
+
+        // Pin the processing thread to the last CPU when there is more than one
+        unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+        RealtimeOptions options{};
+        options.offload = mode.offload ? 1 : 0;
+        options.busyPoll = mode.busyPoll ? 1 : 0;
+        options.processingCpuMask = cpus > 1 && cpus <= 64 ? 1ull << (cpus - 1) : 0;
+        options.latencyBudgetUs = 2000;
+        SDK_SetRealtimeMode(&options);
+
+        double seconds = std::max(2.0, g_options.minTime);
+        SDK_ResetAllocationAudit(0);
+        SDK_StartDataCollection();
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        SDK_ResetLatencyStats();
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        RealtimeStatus status{};
+        SDK_GetRealtimeStatus(&status);
+        SDK_StopDataCollection();
+        SDK_SetRealtimeMode(nullptr);
+
+        BenchResult result;
+        result.name = name;
+        result.iterations = status.packets;
+        result.itemsPerSecond = status.packets / seconds;
+        result.meanNs = status.meanUs * 1000.0;
+        result.p50Ns = status.p50Us * 1000.0;
+        result.p90Ns = status.p90Us * 1000.0;
+        result.p99Ns = status.p99Us * 1000.0;
+        result.maxNs = status.maxUs * 1000.0;
+        result.counters["p999_us"] = status.p999Us;
+        result.counters["over_budget"] = static_cast<double>(status.exceeded);
+        result.counters["dropped"] = static_cast<double>(status.dropped);
+        report(result);
+        recordAllocations();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Output and comparison
+// ---------------------------------------------------------------------------
+
+// Callback-side cost of journaling (recorder append + journal append per
+// 13-sample packet) over one 6-minute, 8-stream session, then the time to
+// rebuild that session from the journal.
+static void benchSessionJournal()
+{
+    std::string appendName = "session/journal_append/streams:8";
+    std::string recoverName = "session/journal_recover/minutes:6";
+    if (!selected(appendName) && !selected(recoverName)) return;
+
+    constexpr int streams = 8;
+    constexpr size_t packetsPerStream = 6 * 60 * 40;     // 520 Hz in 13-sample packets
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "brainbench.bmjournal";
+    SessionRecorder recorder;
+    SessionJournal journal;
+    std::string error;
+    if (!journal.open(path, 200, error) || !journal.beginSession(streams, packetsPerStream * 13, error)) {
+        fprintf(stderr, "session journal: %s\n", error.c_str());
+        return;
+    }
+    recorder.begin(streams, packetsPerStream * 13);
+
+    int packet[13];
+    for (int i = 0; i < 13; ++i) packet[i] = i * 3 - 20;
+    std::vector<double> samples;
+    samples.reserve(packetsPerStream);
+    auto begin = Clock::now();
+    for (size_t p = 0; p < packetsPerStream; ++p) {
+        auto start = Clock::now();
+        for (int s = 0; s < streams; ++s) {
+            size_t stored = recorder.append(s / 2, s % 2, packet, 13);
+            journal.appendSamples(s / 2, s % 2, packet, stored);
+        }
+        samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / streams);
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    if (selected(appendName)) {
+        SessionJournal::Stats stats = journal.stats();
+        BenchResult result;
+        result.name = appendName;
+        result.iterations = packetsPerStream * streams;
+        result.itemsPerSecond = static_cast<double>(packetsPerStream * streams * 13) / elapsed;
+        result.counters["journal_bytes"] = static_cast<double>(stats.writtenBytes);
+        result.counters["dropped_records"] = static_cast<double>(stats.droppedRecords);
+        record(result, samples);
+    }
+    measure(recoverName, static_cast<double>(packetsPerStream * streams * 13), [&]() {
+        SessionJournal::Recovery info;
+        journal.recover(recorder, info, error);
+    });
+
+    journal.close();
+    std::filesystem::remove(path);
+}
+
+// Local subscriber that reads and discards the stream until the server
+// closes the connection.
+static void drainStream(int port)
+{
+    auto s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+        std::vector<char> buffer(1 << 16);
+        while (recv(s, buffer.data(), static_cast<int>(buffer.size()), 0) > 0) {
+        }
+    }
+#if defined(_WIN32)
+    closesocket(s);
+#else
+    close(s);
+#endif
+}
+
+// Cost of StreamServer::publish on the acquisition thread with 0, 1 and 4
+// local subscribers draining the stream. It should not grow with the count:
+// all socket work happens on the server's sender thread.
+static void benchStreamPublish()
+{
+    for (int subscribers : { 0, 1, 4 }) {
+        std::string name = "stream/publish/subscribers:" + std::to_string(subscribers);
+        if (!selected(name)) continue;
+
+        StreamServer server;
+        std::string error;
+        if (!server.start(StreamServer::Options(), error)) {
+            fprintf(stderr, "%s: %s\n", name.c_str(), error.c_str());
+            continue;
+        }
+        std::vector<std::thread> readers;
+        for (int i = 0; i < subscribers; ++i) {
+            readers.emplace_back(drainStream, server.stats().tcpPort);
+        }
+        auto deadline = Clock::now() + std::chrono::seconds(2);
+        while (server.stats().subscribers < subscribers && Clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        int packet[13];
+        for (int i = 0; i < 13; ++i) packet[i] = i * 3 - 20;
+        measure(name, 13, [&]() {
+            server.publish(0, 0, packet, 13);
+        });
+
+        StreamServer::Stats stats = server.stats();
+        server.stop();
+        for (auto& reader : readers) reader.join();
+        g_results.back().counters["dropped_frames"] = static_cast<double>(stats.dropped);
+        g_results.back().counters["skipped_frames"] = static_cast<double>(stats.skipped);
+    }
+}
+
+static std::string jsonEscape(const std::string& text)
+{
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static bool writeJson(const std::string& path)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    out.precision(15);
+
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << "{\n  \"context\": {\"date\": \"" << date << "\", \"sdk_version\": \"" << jsonEscape(SDK_GetVersion())
+        << "\", \"num_cpus\": " << std::thread::hardware_concurrency()
+        << ", \"min_time\": " << g_options.minTime << "},\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < g_results.size(); ++i) {
+        const BenchResult& r = g_results[i];
+        out << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"iterations\": " << r.iterations
+            << ", \"mean_ns\": " << r.meanNs << ", \"p50_ns\": " << r.p50Ns << ", \"p90_ns\": " << r.p90Ns
+            << ", \"p99_ns\": " << r.p99Ns << ", \"max_ns\": " << r.maxNs
+            << ", \"items_per_second\": " << r.itemsPerSecond;
+        for (const auto& counter : r.counters) {
+            out << ", \"" << jsonEscape(counter.first) << "\": " << counter.second;
+        }
+        out << "}" << (i + 1 < g_results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return true;
+}
+
+// Reads name -> p50 from a file written by writeJson.
+static std::map<std::string, double> readBaseline(const std::string& path)
+{
+    std::map<std::string, double> baseline;
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+
+    size_t pos = 0;
+    while ((pos = text.find("\"name\": \"", pos)) != std::string::npos) {
+        pos += 9;
+        size_t end = text.find('"', pos);
+        if (end == std::string::npos) break;
+        std::string name = text.substr(pos, end - pos);
+        size_t p50 = text.find("\"p50_ns\": ", end);
+        size_t next = text.find("\"name\": \"", end);
+        if (p50 != std::string::npos && (next == std::string::npos || p50 < next)) {
+            baseline[name] = std::atof(text.c_str() + p50 + 10);
+        }
+        pos = end;
+    }
+    return baseline;
+}
+
+static int compare(const std::string& path, double thresholdPercent)
+{
+    std::map<std::string, double> baseline = readBaseline(path);
+    if (baseline.empty()) {
+        fprintf(stderr, "No baseline results in %s\n", path.c_str());
+        return 1;
+    }
+
+    int regressions = 0;
+    printf("\n%-48s %12s %12s %9s\n", "Comparison (p50)", "baseline", "current", "change");
+    for (const auto& r : g_results) {
+        auto it = baseline.find(r.name);
+        if (it == baseline.end() || it->second <= 0) continue;
+        double change = (r.p50Ns - it->second) / it->second * 100.0;
+        bool regressed = change > thresholdPercent;
+        printf("%-48s %12.0f %12.0f %+8.1f%%%s\n", r.name.c_str(), it->second, r.p50Ns, change,
+            regressed ? "  REGRESSION" : "");
+        if (regressed) regressions++;
+    }
+    return regressions > 0 ? 3 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    std::string jsonPath;
+    std::string comparePath;
+    double threshold = 10.0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue) g_options.filter = argv[++i];
+        else if (arg == "--min-time" && hasValue) g_options.minTime = std::atof(argv[++i]);
+        else if (arg == "--json" && hasValue) jsonPath = argv[++i];
+        else if (arg == "--compare" && hasValue) comparePath = argv[++i];
+        else if (arg == "--threshold" && hasValue) threshold = std::atof(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: brainbench [--filter text] [--min-time seconds] [--json file]\n"
+                            "                  [--compare baseline.json] [--threshold percent]\n");
+            return 1;
+        }
+    }
+
+    printf("%-48s %12s %12s %12s %12s %14s\n", "Benchmark", "p50 ns", "p90 ns", "p99 ns", "Iterations", "Items/s");
+    printf("%s\n", std::string(116, '-').c_str());
+
+    benchCallbackDispatch();
+    benchDeviceQueries();
+    benchBandIndex();
+    benchLivePipeline();
+    benchFixedPointAccuracy();
+    benchConnectivity();
+    benchEdfWrite();
+    benchFullRate();
+    benchRealtime();
+    benchStreamPublish();
+    benchSessionJournal();
+    resetSdk();
+
+    if (!jsonPath.empty() && !writeJson(jsonPath)) {
+        fprintf(stderr, "Cannot write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    int status = comparePath.empty() ? 0 : compare(comparePath, threshold);
+    if (status == 0 && g_allocationFailures > 0) status = 4;
+    if (status == 0 && g_accuracyFailures > 0) status = 5;
+    return status;
+}
@@ -0,0 +1,490 @@
+// braincheck : deterministic behaviour checks for the analysis code, run by
+// ctest. Each check prints one line and the run exits with 1 when any of
+// them failed.
+//
+// Usage: braincheck [--filter text]
+
+#include "Arena.h"
+#include "CommandQueue.h"
+#include "Connectivity.h"
+#include "FixedPipeline.h"
+#include "LivePipeline.h"
+#include "ResultCache.h"
+#include "SessionJournal.h"
+#include "SessionRecorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace brainmirror;
+
+static std::string g_filter;
+static int g_checks = 0;
+static int g_failures = 0;
+
+static bool selected(const std::string& name)
+{
+    return g_filter.empty() || name.find(g_filter) != std::string::npos;
+}
+
+static void expect(const std::string& name, bool ok, const char* detail)
+{
+    g_checks++;
+    if (!ok) g_failures++;
+    printf("%-6s %-52s %s\n", ok ? "ok" : "FAIL", name.c_str(), detail);
+}
+
+// Seeded white noise, so every run sees the same input.
+static std::vector<double> noise(size_t count, uint32_t seed)
+{
+    std::mt19937 generator(seed);
+    std::normal_distribution<double> distribution(0.0, 20.0);
+    std::vector<double> samples(count);
+    for (double& sample : samples) sample = distribution(generator);
+    return samples;
+}
+
+// A delayed copy keeps a fixed phase lag in every bin, so PLV and coherence
+// are ~1 (less the part of each segment the delay pushes out). The lag turns
+// by ~0.4 rad from one bin to the next, so averaging phases across the bins
+// of a band instead of per bin would show up here. Independent noise has no
+// stable phase relation and stays near the 1/sqrt(segments) floor. A negated
+// copy is perfectly anti-correlated.
+static void checkConnectivity()
+{
+    if (!selected("connectivity")) return;
+
+    const double sampleRate = 520.0;
+    const size_t length = static_cast<size_t>(sampleRate) * 60;
+    const size_t delay = 32;
+    std::vector<double> source = noise(length + delay, 1);
+    std::vector<double> jitter = noise(length, 2);
+    std::vector<double> independent = noise(length, 3);
+
+    std::vector<double> delayed(length), negated(length);
+    for (size_t i = 0; i < length; ++i) {
+        delayed[i] = source[i] + 0.1 * jitter[i];
+        negated[i] = -source[i + delay];
+    }
+    // 0: source, 1: delayed copy, 2: independent noise, 3: negated source
+    const double* channels[] = { source.data() + delay, delayed.data(), independent.data(), negated.data() };
+
+    ConnectivityEngine engine;
+    ConnectivityResult result;
+    std::string error;
+    if (!engine.compute(channels, 4, length, sampleRate, ConnectivityOptions(), result, error)) {
+        expect("connectivity/compute", false, error.c_str());
+        return;
+    }
+
+    char detail[128];
+    for (size_t band = 0; band < result.bands; ++band) {
+        const std::string prefix = "connectivity/band:" + std::to_string(band);
+        float plv = result.plv[result.index(band, 0, 1)];
+        float coherence = result.coherence[result.index(band, 0, 1)];
+        snprintf(detail, sizeof(detail), "plv %.3f coherence %.3f", plv, coherence);
+        expect(prefix + "/delayed_copy", plv > 0.9f && coherence > 0.9f, detail);
+
+        plv = result.plv[result.index(band, 0, 2)];
+        coherence = result.coherence[result.index(band, 0, 2)];
+        snprintf(detail, sizeof(detail), "plv %.3f coherence %.3f", plv, coherence);
+        expect(prefix + "/independent_noise", plv < 0.25f && coherence < 0.1f, detail);
+
+        float correlation = result.correlation[result.index(band, 0, 3)];
+        plv = result.plv[result.index(band, 0, 3)];
+        snprintf(detail, sizeof(detail), "correlation %.3f plv %.3f", correlation, plv);
+        expect(prefix + "/negated_copy", correlation < -0.99f && plv > 0.99f, detail);
+
+        bool symmetric = true;
+        for (size_t i = 0; i < result.channels; ++i) {
+            symmetric = symmetric && result.plv[result.index(band, i, i)] == 1.0f;
+            for (size_t j = 0; j < result.channels; ++j) {
+                symmetric = symmetric && result.plv[result.index(band, i, j)] == result.plv[result.index(band, j, i)];
+            }
+        }
+        expect(prefix + "/symmetric", symmetric, "");
+    }
+}
+
+// The fixed-point pipeline must stay within FixedRelativeErrorBound of the
+// double pipeline in every window, at normal amplitude, with clipping and on
+// a quiet recording of a few uV where quantization matters most.
+static void checkFixedPoint()
+{
+    if (!selected("fixed_point")) return;
+
+    Arena arena;
+    auto reference = live::createPipeline(0, arena, live::Arithmetic::Float);
+    auto fixed = live::createPipeline(0, arena, live::Arithmetic::Fixed);
+    const double sampleRate = reference->sampleRate();
+    std::vector<double> base = noise(static_cast<size_t>(sampleRate) * 30, 4);
+    for (size_t i = 0; i < base.size(); ++i) {
+        double t = static_cast<double>(i) / sampleRate;
+        base[i] = 0.5 * base[i] + 30.0 * std::sin(2.0 * 3.14159265358979 * 10.0 * t) +
+            20.0 * std::sin(2.0 * 3.14159265358979 * 6.0 * t);
+    }
+
+    char detail[128];
+    for (double gain : { 1.0, 4.0, 0.1 }) {
+        std::vector<int> packets(base.size());
+        for (size_t i = 0; i < base.size(); ++i) packets[i] = static_cast<int>(std::lround(base[i] * gain));
+        reference->requestReset();
+        fixed->requestReset();
+
+        double maxError = 0.0;
+        int windows = 0;
+        for (size_t offset = 0; offset + 13 <= packets.size(); offset += 13) {
+            bool a = reference->push(0, packets.data() + offset, 13);
+            bool b = fixed->push(0, packets.data() + offset, 13);
+            if (!a || !b) continue;
+
+            live::BandPower expected, actual;
+            reference->latest(0, expected);
+            fixed->latest(0, actual);
+            for (int band = 0; band < live::BandCount; ++band) {
+                maxError = std::max(maxError, static_cast<double>(std::fabs(expected.relative[band] - actual.relative[band])));
+            }
+            windows++;
+        }
+        snprintf(detail, sizeof(detail), "%d windows, max error %.6f (bound %.3f)", windows, maxError,
+            live::FixedRelativeErrorBound);
+        char name[64];
+        snprintf(name, sizeof(name), "fixed_point/gain:%g", gain);
+        expect(name, windows > 0 && maxError <= live::FixedRelativeErrorBound, detail);
+    }
+}
+
+static CachedAnalysis cachedValue(int n)
+{
+    CachedAnalysis value;
+    value.format = RecordingFormat::Csv;
+    value.parsed = true;
+    value.result.success = true;
+    value.result.thetaValue = 10.0 + n;
+    value.result.alphaValue = 20.0 + n;
+    value.result.betaValue = 30.0 + n;
+    value.result.brainwaveFinalIndex = 0.5 * n;
+    value.result.sampleCount = 31200 + n;
+    value.skippedLines = n % 3;
+    for (int bin = 0; bin < CachedPsdBins; ++bin) value.psd[bin] = static_cast<float>(n + bin);
+    return value;
+}
+
+static bool sameValue(const CachedAnalysis& a, const CachedAnalysis& b)
+{
+    return a.format == b.format && a.parsed == b.parsed && a.result.success == b.result.success &&
+        a.result.thetaValue == b.result.thetaValue && a.result.alphaValue == b.result.alphaValue &&
+        a.result.betaValue == b.result.betaValue && a.result.brainwaveFinalIndex == b.result.brainwaveFinalIndex &&
+        a.result.sampleCount == b.result.sampleCount && a.skippedLines == b.skippedLines &&
+        std::memcmp(a.psd, b.psd, sizeof(a.psd)) == 0;
+}
+
+static std::string recordingText(int n)
+{
+    return "12.50\n-3.25\n" + std::to_string(n) + ".00\n";
+}
+
+// Overwrites `size` bytes at `offset` of a closed file.
+static bool patchFile(const std::filesystem::path& path, std::streamoff offset, const void* bytes, size_t size)
+{
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(offset);
+    file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+    return static_cast<bool>(file);
+}
+
+// Results survive a reopen and a table grow; changed content, another
+// pipeline version, a torn entry and a header written with other analysis
+// parameters never return a stale result.
+static void checkResultCache()
+{
+    if (!selected("result_cache")) return;
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "braincheck.cache";
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+
+    ResultCache cache;
+    std::string error;
+    if (!cache.open(path, error)) {
+        expect("result_cache/open", false, error.c_str());
+        return;
+    }
+
+    // More entries than the initial table holds, so store() grows it
+    const int entries = 2000;
+    for (int n = 0; n < entries; ++n) {
+        std::string text = recordingText(n);
+        cache.store(makeCacheKey(text.data(), text.size(), RecordingFormat::Csv), cachedValue(n));
+    }
+    cache.close();
+
+    char detail[128];
+    if (!cache.open(path, error)) {
+        expect("result_cache/reopen", false, error.c_str());
+        return;
+    }
+    int hits = 0;
+    for (int n = 0; n < entries; ++n) {
+        std::string text = recordingText(n);
+        CachedAnalysis out;
+        if (cache.lookup(makeCacheKey(text.data(), text.size(), RecordingFormat::Csv), out) && sameValue(out, cachedValue(n))) {
+            hits++;
+        }
+    }
+    snprintf(detail, sizeof(detail), "%d of %d entries after reopen", hits, entries);
+    expect("result_cache/round_trip", hits == entries, detail);
+
+    std::string text = recordingText(7);
+    text[1] = '3';
+    CachedAnalysis out;
+    expect("result_cache/modified_content", !cache.lookup(makeCacheKey(text.data(), text.size(), RecordingFormat::Csv), out), "");
+
+    text = recordingText(7);
+    CacheKey key = makeCacheKey(text.data(), text.size(), RecordingFormat::Csv);
+    CacheKey otherVersion = key;
+    otherVersion.pipelineVersion++;
+    expect("result_cache/pipeline_version", !cache.lookup(otherVersion, out), "");
+    expect("result_cache/format_hint",
+        !cache.lookup(makeCacheKey(text.data(), text.size(), RecordingFormat::Edf), out), "");
+    cache.close();
+
+    // Flip a result byte of one entry; its checksum must reject it
+    std::vector<char> bytes;
+    {
+        std::ifstream file(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    auto found = std::search(bytes.begin(), bytes.end(), reinterpret_cast<const char*>(&key.contentHash),
+        reinterpret_cast<const char*>(&key.contentHash) + sizeof(key.contentHash));
+    const std::streamoff thetaOffset = 40;     // Entry::theta in ResultCache.cpp
+    bool patched = found != bytes.end();
+    if (patched) {
+        char flipped = static_cast<char>(found[thetaOffset] ^ 0x40);
+        patched = patchFile(path, (found - bytes.begin()) + thetaOffset, &flipped, 1);
+    }
+    cache.open(path, error);
+    expect("result_cache/torn_entry", patched && !cache.lookup(key, out), "");
+    cache.close();
+
+    // A header from another parameter set clears the whole table
+    const uint32_t otherParams = analysisParamsHash() ^ 1u;
+    const std::streamoff paramsOffset = 20;    // FileHeader::paramsHash
+    patched = patchFile(path, paramsOffset, &otherParams, sizeof(otherParams));
+    cache.open(path, error);
+    text = recordingText(8);
+    ResultCache::Stats stats = cache.stats();
+    snprintf(detail, sizeof(detail), "%llu entries", static_cast<unsigned long long>(stats.entries));
+    expect("result_cache/params_mismatch",
+        patched && stats.entries == 0 && !cache.lookup(makeCacheKey(text.data(), text.size(), RecordingFormat::Csv), out), detail);
+    cache.close();
+    std::filesystem::remove(path, ec);
+}
+
+static std::atomic<int> g_commandsSent{ 0 };
+
+// A headset that never answers
+static bool silentSend(int, uint8_t, uint8_t*, uint8_t)
+{
+    g_commandsSent++;
+    return true;
+}
+
+// A cancelled request, queued or in flight, finishes as Cancelled and is
+// never resent.
+static void checkCommandCancel()
+{
+    if (!selected("command_queue")) return;
+
+    CommandQueue queue(silentSend);
+    CommandQueue::Options options;
+    options.timeoutMs = 20;
+    options.retries = 100;
+    options.windowPerDevice = 1;
+    queue.start(options);
+
+    uint32_t inFlight = queue.submit(0, 0x10, nullptr, 0);
+    uint32_t queued = queue.submit(0, 0x11, nullptr, 0);
+    CommandResult result;
+    bool timedOut = !queue.wait(inFlight, 50, result);
+    bool cancelled = queue.cancel(queued) && queue.cancel(inFlight) && !queue.cancel(inFlight);
+
+    CommandResult first, second;
+    bool finished = queue.wait(inFlight, 0, first) && queue.wait(queued, 0, second) &&
+        first.status == CommandStatus::Cancelled && second.status == CommandStatus::Cancelled;
+    int sent = g_commandsSent.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    int resent = g_commandsSent.load() - sent;
+    queue.stop();
+
+    char detail[128];
+    snprintf(detail, sizeof(detail), "%d sent, %d after cancel", sent, resent);
+    expect("command_queue/cancel", timedOut && cancelled && finished && sent >= 2 && resent == 0, detail);
+}
+
+// A session that reuses the larger buffers of an earlier one still stops at
+// its own stream and sample limits, which the journal was sized for.
+static void checkSessionRecorder()
+{
+    if (!selected("session_recorder")) return;
+
+    SessionRecorder recorder;
+    int packet[100] = {};
+    recorder.begin(4, 1000);
+    for (int chan = 0; chan < 4; ++chan) recorder.append(0, chan, packet, 100);
+
+    recorder.begin(1, 150);
+    size_t stored = recorder.append(0, 0, packet, 100);
+    stored += recorder.append(0, 0, packet, 100);
+    size_t otherStream = recorder.append(0, 1, packet, 100);
+    SessionRecorder::Stats stats = recorder.stats();
+
+    char detail[128];
+    snprintf(detail, sizeof(detail), "%zu stored, %zu on a second stream, capacity %d x %zu", stored, otherStream,
+        stats.streamCapacity, stats.samplesPerStream);
+    expect("session_recorder/reused_buffers", stored == 150 && otherStream == 0 && stats.streamCapacity == 1 &&
+        stats.samplesPerStream == 150 && stats.droppedSamples == 150, detail);
+}
+
+// Journal session of one stream; packet p holds the samples p * 13 .. p * 13 + 12.
+static void journalPacket(SessionJournal& journal, SessionRecorder& recorder, int p)
+{
+    int packet[13];
+    for (int i = 0; i < 13; ++i) packet[i] = p * 13 + i;
+    size_t stored = recorder.append(0, 0, packet, 13);
+    journal.appendSamples(0, 0, packet, stored);
+}
+
+// Offset in the file of the record the next append writes.
+static std::streamoff nextRecordOffset(const SessionJournal& journal)
+{
+    const std::streamoff dataOffset = 4096;     // kDataOffset in SessionJournal.cpp
+    return dataOffset + static_cast<std::streamoff>(journal.stats().writtenBytes);
+}
+
+// Flips a payload byte of the record at `offset` while the journal is closed.
+static bool tearRecord(const std::filesystem::path& path, std::streamoff offset)
+{
+    std::vector<char> bytes;
+    {
+        std::ifstream file(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    const std::streamoff payloadByte = offset + 24;
+    if (payloadByte >= static_cast<std::streamoff>(bytes.size())) return false;
+    char flipped = static_cast<char>(bytes[static_cast<size_t>(payloadByte)] ^ 0x5A);
+    return patchFile(path, payloadByte, &flipped, 1);
+}
+
+// True when the stream holds exactly packets 0 .. packets-1.
+static bool holdsPackets(const SessionRecorder& recorder, int packets)
+{
+    const int* data = nullptr;
+    size_t count = 0;
+    if (!recorder.streamSlice(0, 0, &data, &count) || count != static_cast<size_t>(packets) * 13) return false;
+    for (size_t i = 0; i < count; ++i) {
+        if (data[i] != static_cast<int>(i)) return false;
+    }
+    return true;
+}
+
+// A record torn in the middle of the journal ends recovery right before it,
+// with every earlier sample and marker intact. Journaling then continues in
+// the torn slot; records left behind it by the crashed run must not be
+// replayed, even after hundreds of recoveries of the same session.
+static void checkSessionJournal()
+{
+    if (!selected("session_journal")) return;
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "braincheck.journal";
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+
+    SessionJournal journal;
+    SessionRecorder recorder;
+    std::string error;
+    if (!journal.open(path, 200, error) || !journal.beginSession(1, 520 * 60, error) || !recorder.begin(1, 520 * 60)) {
+        expect("session_journal/begin", false, error.c_str());
+        return;
+    }
+    std::streamoff torn = 0;
+    for (int p = 0; p < 100; ++p) {
+        if (p == 50) {
+            recorder.mark("eyes-closed");
+            journal.appendMarker(recorder, recorder.phaseCount() - 1);
+        }
+        if (p == 70) torn = nextRecordOffset(journal);
+        journalPacket(journal, recorder, p);
+    }
+    journal.close();
+    bool patched = tearRecord(path, torn);
+
+    char detail[128];
+    SessionJournal::Recovery info;
+    journal.open(path, 200, error);
+    bool recovered = journal.recover(recorder, info, error);
+    const int* phase = nullptr;
+    size_t phaseCount = 0;
+    bool marker = recorder.phaseCount() == 1 && recorder.phaseSlice(0, 0, 0, &phase, &phaseCount) &&
+        phaseCount == 20 * 13 && phase[0] == 50 * 13;
+    snprintf(detail, sizeof(detail), "%llu samples, %d markers", static_cast<unsigned long long>(info.samples), info.markers);
+    expect("session_journal/torn_record", patched && recovered && holdsPackets(recorder, 70) && marker, detail);
+
+    // Exhaust a one-byte epoch, then crash with a torn record in the middle
+    // of what the last run wrote and reuse its slot
+    for (int i = 0; i < 300 && recovered; ++i) {
+        journal.close();
+        journal.open(path, 200, error);
+        recovered = journal.recover(recorder, info, error);
+    }
+    for (int p = 70; p < 80; ++p) {
+        if (p == 72) torn = nextRecordOffset(journal);
+        journalPacket(journal, recorder, p);
+    }
+    journal.close();
+    patched = tearRecord(path, torn);
+    journal.open(path, 200, error);
+    recovered = recovered && journal.recover(recorder, info, error);
+    journalPacket(journal, recorder, 72);
+    journal.close();
+
+    journal.open(path, 200, error);
+    recovered = recovered && journal.recover(recorder, info, error);
+    snprintf(detail, sizeof(detail), "%llu samples", static_cast<unsigned long long>(info.samples));
+    expect("session_journal/stale_tail", patched && recovered && holdsPackets(recorder, 73), detail);
+    journal.close();
+    std::filesystem::remove(path, ec);
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) g_filter = argv[++i];
+        else {
+            fprintf(stderr, "Usage: braincheck [--filter text]\n");
+            return 1;
+        }
+    }
+
+    checkConnectivity();
+    checkFixedPoint();
+    checkResultCache();
+    checkCommandCancel();
+    checkSessionRecorder();
+    checkSessionJournal();
+
+    printf("%d checks, %d failed\n", g_checks, g_failures);
+    return g_failures > 0 ? 1 : 0;
+}
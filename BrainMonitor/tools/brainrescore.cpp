@@ -0,0 +1,292 @@
+// brainrescore : batch re-analysis of stored EEG recordings with the native
+// BrainwaveDataProcessor pipeline.
+//
+// Usage: brainrescore [options] <directory|file> ...
+//   --manifest <file>   Read recording paths from a file (one per line, relative to the manifest)
+//   --match <text>      Only process files whose name contains text (e.g. 闭眼)
+//   --threads <n>       Worker threads (default: all cores)
+//   --no-numa           Do not pin workers to NUMA nodes
+//   --format csv|json   Output format (default: csv)
+//   --output <file>     Write results to file instead of stdout
+//   --cache <file>      Reuse results for unchanged recordings (content-hash result cache)
+
+#include "BrainwaveAnalysis.h"
+#include "RecordingReader.h"
+#include "ResultCache.h"
+#include "WorkStealingPool.h"
+
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace brainmirror;
+namespace fs = std::filesystem;
+
+struct FileResult {
+    RecordingFormat format = RecordingFormat::Unknown;
+    BrainwaveResult result;
+    size_t warnings = 0;
+    bool cached = false;
+};
+
+struct WorkerContext {
+    std::vector<char> fileBuffer;
+    Recording recording;
+    BrainwaveAnalyzer analyzer;
+};
+
+static std::string toUtf8(const fs::path& path)
+{
+    auto text = path.u8string();
+    return std::string(reinterpret_cast<const char*>(text.data()), text.size());
+}
+
+static fs::path fromUtf8(const std::string& text)
+{
+    return fs::path(std::u8string(reinterpret_cast<const char8_t*>(text.data()), text.size()));
+}
+
+static bool wanted(const fs::path& path, const std::string& match)
+{
+    if (formatFromPath(toUtf8(path.filename())) == RecordingFormat::Unknown) return false;
+    return match.empty() || toUtf8(path.filename()).find(match) != std::string::npos;
+}
+
+static void collect(const fs::path& input, const std::string& match, std::vector<fs::path>& files)
+{
+    std::error_code ec;
+    if (fs::is_directory(input, ec)) {
+        for (auto it = fs::recursive_directory_iterator(input, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            if (it->is_regular_file(ec) && wanted(it->path(), match)) {
+                files.push_back(it->path());
+            }
+        }
+    }
+    else if (wanted(input, match)) {
+        files.push_back(input);
+    }
+}
+
+static bool readManifest(const fs::path& manifest, const std::string& match, std::vector<fs::path>& files)
+{
+    std::ifstream in(manifest);
+    if (!in) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        fs::path entry = fromUtf8(line);
+        if (entry.is_relative()) entry = manifest.parent_path() / entry;
+        collect(entry, match, files);
+    }
+    return true;
+}
+
+static std::string jsonEscape(const std::string& text)
+{
+    std::string out;
+    out.reserve(text.size() + 2);
+    for (unsigned char c : text) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            }
+            else {
+                out += static_cast<char>(c);
+            }
+        }
+    }
+    return out;
+}
+
+static std::string csvEscape(const std::string& text)
+{
+    if (text.find_first_of(",\"\n") == std::string::npos) return text;
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static void writeCsv(std::ostream& out, const std::vector<fs::path>& files, const std::vector<FileResult>& results)
+{
+    out << "path,format,samples,success,theta,alpha,beta,final_index,clipped,mean,std,warnings,error\n";
+    char line[512];
+    for (size_t i = 0; i < files.size(); ++i) {
+        const FileResult& r = results[i];
+        snprintf(line, sizeof(line), ",%s,%zu,%d,%.4f,%.4f,%.4f,%.4f,%zu,%.4f,%.4f,%zu,",
+            formatName(r.format), r.result.sampleCount, r.result.success ? 1 : 0,
+            r.result.thetaValue, r.result.alphaValue, r.result.betaValue, r.result.brainwaveFinalIndex,
+            r.result.clippedCount, r.result.meanValue, r.result.stdDeviation, r.warnings);
+        out << csvEscape(toUtf8(files[i])) << line << csvEscape(r.result.errorMessage) << "\n";
+    }
+}
+
+static void writeJson(std::ostream& out, const std::vector<fs::path>& files, const std::vector<FileResult>& results)
+{
+    out << "[\n";
+    char line[512];
+    for (size_t i = 0; i < files.size(); ++i) {
+        const FileResult& r = results[i];
+        snprintf(line, sizeof(line),
+            "\"format\":\"%s\",\"samples\":%zu,\"success\":%s,\"theta\":%.4f,\"alpha\":%.4f,\"beta\":%.4f,"
+            "\"finalIndex\":%.4f,\"clipped\":%zu,\"mean\":%.4f,\"std\":%.4f,\"warnings\":%zu,",
+            formatName(r.format), r.result.sampleCount, r.result.success ? "true" : "false",
+            r.result.thetaValue, r.result.alphaValue, r.result.betaValue, r.result.brainwaveFinalIndex,
+            r.result.clippedCount, r.result.meanValue, r.result.stdDeviation, r.warnings);
+        out << "  {\"path\":\"" << jsonEscape(toUtf8(files[i])) << "\"," << line
+            << "\"error\":\"" << jsonEscape(r.result.errorMessage) << "\"}"
+            << (i + 1 < files.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+}
+
+static void usage()
+{
+    fprintf(stderr,
+        "Usage: brainrescore [--manifest file] [--match text] [--threads n] [--no-numa]\n"
+        "                    [--format csv|json] [--output file] [--cache file] <directory|file> ...\n");
+}
+
+constexpr unsigned kMaxThreads = 1024;
+
+static bool parseThreadCount(const char* text, unsigned& threads)
+{
+    if (!text || !std::isdigit(static_cast<unsigned char>(text[0]))) return false;
+    char* end = nullptr;
+    errno = 0;
+    unsigned long value = std::strtoul(text, &end, 10);
+    if (errno != 0 || *end != '\0' || value == 0 || value > kMaxThreads) return false;
+    threads = static_cast<unsigned>(value);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> inputs;
+    std::vector<std::string> manifests;
+    std::string match;
+    std::string format = "csv";
+    std::string outputPath;
+    std::string cachePath;
+    ParallelOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--manifest" && hasValue) manifests.push_back(argv[++i]);
+        else if (arg == "--match" && hasValue) match = argv[++i];
+        else if (arg == "--threads" && hasValue) {
+            if (!parseThreadCount(argv[++i], options.threads)) {
+                fprintf(stderr, "--threads must be between 1 and %u\n", kMaxThreads);
+                return 1;
+            }
+        }
+        else if (arg == "--no-numa") options.numaAware = false;
+        else if (arg == "--format" && hasValue) format = argv[++i];
+        else if (arg == "--output" && hasValue) outputPath = argv[++i];
+        else if (arg == "--cache" && hasValue) cachePath = argv[++i];
+        else if (!arg.empty() && arg[0] == '-') {
+            usage();
+            return 1;
+        }
+        else inputs.push_back(arg);
+    }
+
+    if ((inputs.empty() && manifests.empty()) || (format != "csv" && format != "json")) {
+        usage();
+        return 1;
+    }
+
+    std::vector<fs::path> files;
+    for (const auto& manifest : manifests) {
+        if (!readManifest(fromUtf8(manifest), match, files)) {
+            fprintf(stderr, "Cannot read manifest %s\n", manifest.c_str());
+            return 1;
+        }
+    }
+    for (const auto& input : inputs) {
+        collect(fromUtf8(input), match, files);
+    }
+
+    ResultCache cache;
+    if (!cachePath.empty()) {
+        std::string error;
+        if (!cache.open(fromUtf8(cachePath), error)) {
+            fprintf(stderr, "Cannot open cache %s: %s\n", cachePath.c_str(), error.c_str());
+            return 1;
+        }
+    }
+
+    auto started = std::chrono::steady_clock::now();
+
+    std::vector<FileResult> results(files.size());
+    unsigned workers = options.threads ? options.threads : std::thread::hardware_concurrency();
+    std::vector<WorkerContext> contexts(workers ? workers : 1);
+
+    parallelFor(files.size(), options, [&](size_t index, unsigned worker) {
+        WorkerContext& ctx = contexts[worker];
+        FileResult& out = results[index];
+        out.format = formatFromPath(toUtf8(files[index].filename()));
+
+        if (!readWholeFile(files[index], ctx.fileBuffer)) {
+            out.result.errorMessage = "cannot read file";
+            return;
+        }
+
+        CachedAnalysis analysis;
+        out.cached = analyzeRecordingCached(cache.isOpen() ? &cache : nullptr, ctx.fileBuffer.data(), ctx.fileBuffer.size(),
+                                            out.format, ctx.recording, ctx.analyzer, analysis);
+        out.format = analysis.format;
+        out.result = std::move(analysis.result);
+        out.warnings = analysis.warnings;
+    });
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(fromUtf8(outputPath), std::ios::binary);
+        if (!file) {
+            fprintf(stderr, "Cannot write %s\n", outputPath.c_str());
+            return 1;
+        }
+    }
+    std::ostream& out = outputPath.empty() ? std::cout : file;
+    if (format == "json") writeJson(out, files, results);
+    else writeCsv(out, files, results);
+
+    size_t failed = 0;
+    size_t cached = 0;
+    for (const auto& r : results) {
+        if (!r.result.success) failed++;
+        if (r.cached) cached++;
+    }
+    fprintf(stderr, "Processed %zu recordings (%zu failed) in %.2f s\n", files.size(), failed, seconds);
+    if (cache.isOpen()) {
+        auto stats = cache.stats();
+        fprintf(stderr, "Cache: %zu hits, %zu recomputed, %llu entries\n", cached, files.size() - cached,
+                static_cast<unsigned long long>(stats.entries));
+    }
+    return failed == files.size() && !files.empty() ? 2 : 0;
+}
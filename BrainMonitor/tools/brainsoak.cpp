@@ -0,0 +1,518 @@
+// brainsoak : long-running soak test for BrainMirrorSDK against the simulated
+// device backend (BRAINMIRROR_SIM_BACKEND).
+//
+// Usage: brainsoak [--duration seconds] [--cycle seconds] [--devices n] [--channels n]
+//                  [--faults per-minute] [--reinit-every n] [--sample seconds]
+//                  [--offload] [--flood] [--seed n] [--csv file]
+//                  [--max-rss-growth MB] [--max-handle-growth n] [--max-thread-growth n]
+//                  [--max-throughput-drop percent]
+//
+// Repeats the station lifecycle for --duration: init, open port, scan,
+// connect, configure, start, record a session, stop, disconnect, and every
+// --reinit-every cycles a full SDK_DisconnectPort/SDK_Cleanup/SDK_Init.
+// Random device disconnects and dongle reboots are injected while acquiring
+// and recovered from the way TestPage does (reconnect the device, or reset
+// the SDK after a reboot).
+//
+// Every --sample seconds it records RSS and its high-water mark, open
+// handles, threads, callback throughput and per-packet latency (simulated
+// packet creation -> application raw callback). At the end the idle
+// checkpoints taken after each full cleanup are compared between the first
+// and last quarter of the run:
+//   exit 2  the SDK could not be brought up
+//   exit 3  RSS, handles or threads grew past the limits (leak)
+//   exit 4  throughput per device dropped past --max-throughput-drop
+
+#include "BrainMonitorWrapper.h"
+#include "Realtime.h"
+#include "SimBackend.h"
+#include "brnpro_if.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#elif defined(__linux__)
+#include <filesystem>
+#endif
+
+using namespace brainmirror;
+using Clock = std::chrono::steady_clock;
+
+struct SoakOptions {
+    double duration = 3600.0;
+    double cycleSeconds = 30.0;
+    int devices = 4;
+    int channels = 1;
+    double faultsPerMinute = 2.0;
+    int reinitEvery = 2;
+    double sampleSeconds = 5.0;
+    bool offload = false;
+    bool flood = false;
+    unsigned seed = 1;
+    std::string csvPath;
+    double maxRssGrowthMb = 16.0;
+    int maxHandleGrowth = 4;
+    int maxThreadGrowth = 0;
+    double maxThroughputDrop = 10.0;
+};
+
+struct ProcessMetrics {
+    double rssMb = 0.0;
+    double peakRssMb = 0.0;
+    int handles = -1;
+    int threads = -1;
+};
+
+struct Checkpoint {
+    double elapsed = 0.0;
+    ProcessMetrics metrics;
+};
+
+static SoakOptions g_options;
+
+// Filled by the SDK callbacks
+static std::atomic<uint64_t> g_callbackSamples{ 0 };
+static std::atomic<uint32_t> g_disconnectedMask{ 0 };
+static std::atomic<bool> g_dongleRebooted{ false };
+static LatencyHistogram g_intervalLatency;
+static LatencyHistogram g_totalLatency;
+
+// ---------------------------------------------------------------------------
+// Process metrics
+// ---------------------------------------------------------------------------
+
+#if defined(_WIN32)
+
+static ProcessMetrics readProcessMetrics()
+{
+    ProcessMetrics metrics;
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        metrics.rssMb = counters.WorkingSetSize / (1024.0 * 1024.0);
+        metrics.peakRssMb = counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+    }
+    DWORD handles = 0;
+    if (GetProcessHandleCount(GetCurrentProcess(), &handles)) metrics.handles = static_cast<int>(handles);
+
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot != INVALID_HANDLE_VALUE) {
+        THREADENTRY32 entry{};
+        entry.dwSize = sizeof(entry);
+        DWORD pid = GetCurrentProcessId();
+        int threads = 0;
+        for (BOOL ok = Thread32First(snapshot, &entry); ok; ok = Thread32Next(snapshot, &entry)) {
+            if (entry.th32OwnerProcessID == pid) threads++;
+        }
+        CloseHandle(snapshot);
+        metrics.threads = threads;
+    }
+    return metrics;
+}
+
+#elif defined(__linux__)
+
+static ProcessMetrics readProcessMetrics()
+{
+    ProcessMetrics metrics;
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) metrics.rssMb = std::atof(line.c_str() + 6) / 1024.0;
+        else if (line.compare(0, 6, "VmHWM:") == 0) metrics.peakRssMb = std::atof(line.c_str() + 6) / 1024.0;
+        else if (line.compare(0, 8, "Threads:") == 0) metrics.threads = std::atoi(line.c_str() + 8);
+    }
+
+    // The iterator's own descriptor is counted on every call, so growth is unaffected
+    std::error_code ec;
+    int handles = 0;
+    for (auto it = std::filesystem::directory_iterator("/proc/self/fd", ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        handles++;
+    }
+    if (!ec) metrics.handles = handles;
+    return metrics;
+}
+
+#else
+
+static ProcessMetrics readProcessMetrics()
+{
+    return ProcessMetrics();
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// SDK lifecycle
+// ---------------------------------------------------------------------------
+
+static void soakRawCallback(int, int, int*, int len)
+{
+    g_callbackSamples.fetch_add(static_cast<uint64_t>(len), std::memory_order_relaxed);
+    uint64_t created = sim::currentPacketTimestampNs();
+    if (created) {
+        uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch()).count());
+        uint32_t us = static_cast<uint32_t>(std::min<uint64_t>((now - created) / 1000, UINT32_MAX));
+        g_intervalLatency.record(us, false);
+        g_totalLatency.record(us, false);
+    }
+}
+
+static void soakEventCallback(unsigned int event, unsigned int param)
+{
+    if (event == jfbrnpro_if::Event_devDisconnect && param < 32) {
+        g_disconnectedMask.fetch_or(1u << param, std::memory_order_relaxed);
+    }
+    else if (event == jfbrnpro_if::Event_dongleReboot) {
+        g_dongleRebooted.store(true, std::memory_order_relaxed);
+    }
+}
+
+static void disconnectAll()
+{
+    DeviceInfo info{};
+    while (SDK_GetConnectedDevicesCount() > 0 && SDK_GetConnectedDevice(0, &info)) {
+        if (!SDK_DisconnectDevice(info.mac)) break;
+    }
+}
+
+static void shutdownSdk()
+{
+    SDK_StopDataCollection();
+    SDK_EndSession();
+    disconnectAll();
+    SDK_DisconnectPort();
+    SDK_Cleanup();
+}
+
+// Init (if needed), port, scan, connect every device, configure, start and
+// begin a session. Returns the number of connected devices, 0 on failure.
+static int bringUp(bool init)
+{
+    if (init) {
+        sim::SimConfig config;
+        config.deviceCount = g_options.devices;
+        config.channels = g_options.channels;
+        config.realtime = !g_options.flood;
+        config.seed = g_options.seed;
+        sim::configure(config);
+
+        if (!SDK_Init()) return 0;
+        SDK_SetRawDataCallback(soakRawCallback);
+        SDK_SetEventCallback(soakEventCallback);
+        if (g_options.offload) {
+            RealtimeOptions realtime{};
+            realtime.offload = 1;
+            SDK_SetRealtimeMode(&realtime);
+        }
+        if (!SDK_ConnectPort(SDK_CheckPort())) return 0;
+    }
+
+    if (!SDK_ScanDevices()) return 0;
+    for (int i = 0; i < SDK_GetScanDevicesCount(); ++i) {
+        DeviceInfo info{};
+        if (SDK_GetScanDevice(i, &info)) SDK_ConnectDevice(info.mac, info.type);
+    }
+    int connected = SDK_GetConnectedDevicesCount();
+    if (connected == 0) return 0;
+
+    DeviceConfigResult results[16];
+    SDK_ConfigureAllDevices(2000, results, 16);
+    g_disconnectedMask.store(0);
+    g_dongleRebooted.store(false);
+
+    auto samples = static_cast<unsigned>((g_options.cycleSeconds + 5.0) * 520.0);
+    SDK_BeginSession(samples);
+    SDK_MarkPhase("soak");
+    return SDK_StartDataCollection() ? connected : 0;
+}
+
+// Reconnects devices reported by Event_devDisconnect. Returns how many.
+static int reconnectDropped()
+{
+    uint32_t mask = g_disconnectedMask.exchange(0);
+    if (!mask) return 0;
+
+    std::vector<DeviceInfo> dropped;
+    for (int i = 0; i < SDK_GetConnectedDevicesCount(); ++i) {
+        DeviceInfo info{};
+        if (SDK_GetConnectedDevice(i, &info) && info.index >= 0 && info.index < 32 && (mask & (1u << info.index))) {
+            dropped.push_back(info);
+        }
+    }
+    int reconnected = 0;
+    for (const auto& info : dropped) {
+        SDK_DisconnectDevice(info.mac);
+        if (SDK_ConnectDevice(info.mac, info.type)) reconnected++;
+    }
+    return reconnected;
+}
+
+// ---------------------------------------------------------------------------
+// Reporting and checks
+// ---------------------------------------------------------------------------
+
+static double median(std::vector<double> values)
+{
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+static const char* g_csvHeader =
+    "elapsed_s,cycle,rss_mb,peak_rss_mb,handles,threads,samples_per_s,throughput_pct,"
+    "p50_us,p99_us,max_us,faults,reconnects,reinits\n";
+
+static void usage()
+{
+    fprintf(stderr,
+        "Usage: brainsoak [--duration seconds] [--cycle seconds] [--devices n] [--channels n]\n"
+        "                 [--faults per-minute] [--reinit-every n] [--sample seconds]\n"
+        "                 [--offload] [--flood] [--seed n] [--csv file]\n"
+        "                 [--max-rss-growth MB] [--max-handle-growth n] [--max-thread-growth n]\n"
+        "                 [--max-throughput-drop percent]\n");
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--duration" && hasValue) g_options.duration = std::atof(argv[++i]);
+        else if (arg == "--cycle" && hasValue) g_options.cycleSeconds = std::atof(argv[++i]);
+        else if (arg == "--devices" && hasValue) g_options.devices = std::atoi(argv[++i]);
+        else if (arg == "--channels" && hasValue) g_options.channels = std::atoi(argv[++i]);
+        else if (arg == "--faults" && hasValue) g_options.faultsPerMinute = std::atof(argv[++i]);
+        else if (arg == "--reinit-every" && hasValue) g_options.reinitEvery = std::atoi(argv[++i]);
+        else if (arg == "--sample" && hasValue) g_options.sampleSeconds = std::atof(argv[++i]);
+        else if (arg == "--offload") g_options.offload = true;
+        else if (arg == "--flood") g_options.flood = true;
+        else if (arg == "--seed" && hasValue) g_options.seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--csv" && hasValue) g_options.csvPath = argv[++i];
+        else if (arg == "--max-rss-growth" && hasValue) g_options.maxRssGrowthMb = std::atof(argv[++i]);
+        else if (arg == "--max-handle-growth" && hasValue) g_options.maxHandleGrowth = std::atoi(argv[++i]);
+        else if (arg == "--max-thread-growth" && hasValue) g_options.maxThreadGrowth = std::atoi(argv[++i]);
+        else if (arg == "--max-throughput-drop" && hasValue) g_options.maxThroughputDrop = std::atof(argv[++i]);
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (g_options.duration <= 0 || g_options.cycleSeconds <= 0 || g_options.sampleSeconds <= 0 ||
+        g_options.devices < 1 || g_options.devices > 16 || g_options.channels < 1 || g_options.reinitEvery < 1) {
+        usage();
+        return 1;
+    }
+
+    std::ofstream csv;
+    if (!g_options.csvPath.empty()) {
+        csv.open(g_options.csvPath, std::ios::binary);
+        if (!csv) {
+            fprintf(stderr, "Cannot write %s\n", g_options.csvPath.c_str());
+            return 1;
+        }
+        csv << g_csvHeader;
+    }
+
+    std::mt19937 rng(g_options.seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const double tick = 0.05;
+    const double faultChance = g_options.faultsPerMinute / 60.0 * tick;
+    const double expectedPerDevice = 520.0 * g_options.channels;
+
+    std::vector<Checkpoint> idle;          // After each full cleanup
+    std::vector<double> cleanThroughput;   // Samples/s per connected device, fault-free intervals only
+    uint64_t faults = 0, reconnects = 0, reinits = 0, cycles = 0;
+    int bringUpFailures = 0;
+
+    printf("%8s %6s %8s %8s %7s %7s %10s %7s %8s %8s %8s %6s\n", "time s", "cycle", "rss MB", "peak MB",
+        "handles", "threads", "samples/s", "rate %", "p50 us", "p99 us", "max us", "faults");
+
+    auto begin = Clock::now();
+    auto elapsedSeconds = [&]() { return std::chrono::duration<double>(Clock::now() - begin).count(); };
+
+    idle.push_back({ 0.0, readProcessMetrics() });
+    bool initialized = false;
+
+    while (elapsedSeconds() < g_options.duration) {
+        int connected = bringUp(!initialized);
+        if (!connected) {
+            fprintf(stderr, "cycle %llu: SDK bring-up failed, resetting\n", static_cast<unsigned long long>(cycles));
+            shutdownSdk();
+            initialized = false;
+            if (++bringUpFailures >= 5) {
+                fprintf(stderr, "SDK bring-up failed %d times in a row\n", bringUpFailures);
+                return 2;
+            }
+            continue;
+        }
+        bringUpFailures = 0;
+        initialized = true;
+        cycles++;
+
+        auto cycleEnd = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(g_options.cycleSeconds));
+        auto nextSample = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(g_options.sampleSeconds));
+        auto intervalStart = Clock::now();
+        uint64_t intervalSamples = g_callbackSamples.load();
+        bool intervalClean = true;
+        g_intervalLatency.reset();
+
+        while (Clock::now() < cycleEnd && elapsedSeconds() < g_options.duration) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(tick));
+
+            if (uniform(rng) < faultChance) {
+                faults++;
+                intervalClean = false;
+                if (uniform(rng) < 0.2) {
+                    sim::injectDongleReboot();
+                }
+                else {
+                    DeviceInfo info{};
+                    int count = SDK_GetConnectedDevicesCount();
+                    if (count > 0 && SDK_GetConnectedDevice(static_cast<int>(rng() % count), &info)) {
+                        sim::injectDisconnect(info.index);
+                    }
+                }
+            }
+
+            if (g_dongleRebooted.exchange(false)) {
+                // TestPage resets the SDK completely after the dongle drops out
+                shutdownSdk();
+                reinits++;
+                connected = bringUp(true);
+                if (!connected) {
+                    shutdownSdk();
+                    initialized = false;
+                    break;
+                }
+                intervalClean = false;
+            }
+            else if (int count = reconnectDropped()) {
+                reconnects += count;
+                intervalClean = false;
+            }
+
+            if (Clock::now() >= nextSample) {
+                auto now = Clock::now();
+                double seconds = std::chrono::duration<double>(now - intervalStart).count();
+                uint64_t samples = g_callbackSamples.load();
+                double rate = seconds > 0 ? (samples - intervalSamples) / seconds : 0.0;
+                int devicesNow = SDK_GetConnectedDevicesCount();
+                double perDevice = devicesNow > 0 ? rate / devicesNow : 0.0;
+                if (intervalClean && devicesNow == connected) cleanThroughput.push_back(perDevice);
+
+                ProcessMetrics metrics = readProcessMetrics();
+                LatencyHistogram::Snapshot latency = g_intervalLatency.snapshot();
+                double elapsed = elapsedSeconds();
+                double ratePercent = perDevice / expectedPerDevice * 100.0;
+                printf("%8.0f %6llu %8.1f %8.1f %7d %7d %10.0f %7.1f %8u %8u %8u %6llu\n", elapsed,
+                    static_cast<unsigned long long>(cycles), metrics.rssMb, metrics.peakRssMb, metrics.handles,
+                    metrics.threads, rate, ratePercent, latency.p50Us, latency.p99Us, latency.maxUs,
+                    static_cast<unsigned long long>(faults));
+                fflush(stdout);
+                if (csv) {
+                    char line[256];
+                    snprintf(line, sizeof(line), "%.1f,%llu,%.2f,%.2f,%d,%d,%.0f,%.1f,%u,%u,%u,%llu,%llu,%llu\n",
+                        elapsed, static_cast<unsigned long long>(cycles), metrics.rssMb, metrics.peakRssMb,
+                        metrics.handles, metrics.threads, rate, ratePercent, latency.p50Us, latency.p99Us,
+                        latency.maxUs, static_cast<unsigned long long>(faults),
+                        static_cast<unsigned long long>(reconnects), static_cast<unsigned long long>(reinits));
+                    csv << line;
+                    csv.flush();
+                }
+
+                intervalStart = now;
+                intervalSamples = samples;
+                intervalClean = true;
+                g_intervalLatency.reset();
+                nextSample = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(g_options.sampleSeconds));
+            }
+        }
+
+        // End of cycle: stop and disconnect; every reinitEvery cycles also
+        // close the port and clean the SDK up, then take an idle checkpoint
+        SDK_StopDataCollection();
+        SDK_EndSession();
+        disconnectAll();
+        if (cycles % static_cast<uint64_t>(g_options.reinitEvery) == 0) {
+            SDK_DisconnectPort();
+            SDK_Cleanup();
+            initialized = false;
+            reinits++;
+            idle.push_back({ elapsedSeconds(), readProcessMetrics() });
+        }
+    }
+    shutdownSdk();
+    idle.push_back({ elapsedSeconds(), readProcessMetrics() });
+
+    // Warm-up: first quarter of the idle checkpoints (at least two, so the
+    // first-use allocations of the SDK are in the baseline); tail: last quarter
+    int status = 0;
+    ProcessMetrics metrics = readProcessMetrics();
+    LatencyHistogram::Snapshot latency = g_totalLatency.snapshot();
+    printf("\nCycles %llu, faults %llu, reconnects %llu, reinits %llu\n", static_cast<unsigned long long>(cycles),
+        static_cast<unsigned long long>(faults), static_cast<unsigned long long>(reconnects),
+        static_cast<unsigned long long>(reinits));
+    printf("Peak RSS %.1f MB, packet latency p50 %u us, p99 %u us, p99.9 %u us, max %u us\n",
+        metrics.peakRssMb, latency.p50Us, latency.p99Us, latency.p999Us, latency.maxUs);
+
+    size_t quarter = idle.size() / 4;
+    if (idle.size() >= 6 && quarter >= 1) {
+        size_t warmup = std::max<size_t>(quarter, 2);
+        double baseRss = 0.0, tailRss = 1e300;
+        int baseHandles = 0, tailHandles = INT32_MAX, baseThreads = 0, tailThreads = INT32_MAX;
+        for (size_t i = 0; i < warmup; ++i) {
+            baseRss = std::max(baseRss, idle[i].metrics.rssMb);
+            baseHandles = std::max(baseHandles, idle[i].metrics.handles);
+            baseThreads = std::max(baseThreads, idle[i].metrics.threads);
+        }
+        for (size_t i = idle.size() - quarter; i < idle.size(); ++i) {
+            tailRss = std::min(tailRss, idle[i].metrics.rssMb);
+            tailHandles = std::min(tailHandles, idle[i].metrics.handles);
+            tailThreads = std::min(tailThreads, idle[i].metrics.threads);
+        }
+        printf("Idle RSS %.1f -> %.1f MB, handles %d -> %d, threads %d -> %d\n",
+            baseRss, tailRss, baseHandles, tailHandles, baseThreads, tailThreads);
+        if (tailRss - baseRss > g_options.maxRssGrowthMb) {
+            fprintf(stderr, "LEAK: idle RSS grew by %.1f MB\n", tailRss - baseRss);
+            status = 3;
+        }
+        if (baseHandles >= 0 && tailHandles - baseHandles > g_options.maxHandleGrowth) {
+            fprintf(stderr, "LEAK: open handles grew by %d\n", tailHandles - baseHandles);
+            status = 3;
+        }
+        if (baseThreads >= 0 && tailThreads - baseThreads > g_options.maxThreadGrowth) {
+            fprintf(stderr, "LEAK: threads grew by %d\n", tailThreads - baseThreads);
+            status = 3;
+        }
+    }
+    else {
+        printf("Too few cleanup cycles (%zu) for leak checks; run longer or lower --reinit-every\n", idle.size());
+    }
+
+    quarter = cleanThroughput.size() / 4;
+    if (status == 0 && quarter >= 2) {
+        double head = median(std::vector<double>(cleanThroughput.begin(), cleanThroughput.begin() + quarter));
+        double tail = median(std::vector<double>(cleanThroughput.end() - quarter, cleanThroughput.end()));
+        double drop = head > 0 ? (head - tail) / head * 100.0 : 0.0;
+        printf("Throughput per device %.0f -> %.0f samples/s (%+.1f%%)\n", head, tail, -drop);
+        if (drop > g_options.maxThroughputDrop) {
+            fprintf(stderr, "DECAY: throughput dropped by %.1f%%\n", drop);
+            status = 4;
+        }
+    }
+    return status;
+}
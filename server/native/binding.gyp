@@ -0,0 +1,29 @@
+{
+  "targets": [
+    {
+      "target_name": "brainmirror_analysis",
+      "sources": [
+        "src/analysis_addon.cpp",
+        "../../BrainMonitor/native/BrainwaveAnalysis.cpp",
+        "../../BrainMonitor/native/RecordingReader.cpp",
+        "../../BrainMonitor/native/MappedFile.cpp",
+        "../../BrainMonitor/native/ResultCache.cpp"
+      ],
+      "include_dirs": [
+        "../../BrainMonitor/native"
+      ],
+      "cflags_cc": [ "-std=c++20", "-fexceptions" ],
+      "cflags_cc!": [ "-fno-exceptions", "-std=gnu++17", "-std=gnu++1y" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "ExceptionHandling": 1,
+          "AdditionalOptions": [ "/std:c++20", "/utf-8" ]
+        }
+      },
+      "xcode_settings": {
+        "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+        "CLANG_CXX_LANGUAGE_STANDARD": "c++20"
+      }
+    }
+  ]
+}
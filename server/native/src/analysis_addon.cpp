@@ -0,0 +1,238 @@
+// Node-API binding for the BrainMirrorSDK analysis engine.
+//
+//   analyze(buffer[, format]) -> Promise<result>
+//   openCache(path) -> boolean
+//
+// Parsing and scoring run on the libuv worker pool; the event loop only
+// creates the result object. format is 'csv' or 'edf' (sniffed when omitted).
+// With a result cache open, content seen before is answered from the cache
+// (result.cached is true, warnings is empty and EDF header fields are omitted).
+
+#include <node_api.h>
+
+#include "BrainwaveAnalysis.h"
+#include "RecordingReader.h"
+#include "ResultCache.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace brainmirror;
+
+namespace {
+
+struct AnalyzeJob {
+    napi_async_work work = nullptr;
+    napi_deferred deferred = nullptr;
+    napi_ref bufferRef = nullptr;
+
+    const char* data = nullptr;
+    size_t size = 0;
+    RecordingFormat hint = RecordingFormat::Unknown;
+
+    // Output, filled on the worker thread
+    bool cached = false;
+    bool parsed = false;
+    std::string parseError;
+    RecordingFormat format = RecordingFormat::Unknown;
+    size_t skippedLines = 0;
+    int dataRecords = 0;
+    double recordDuration = 0.0;
+    std::vector<std::string> warnings;
+    BrainwaveResult result;
+};
+
+// libuv pool threads are long-lived, so keep one analyzer per thread
+thread_local Recording t_recording;
+thread_local BrainwaveAnalyzer t_analyzer;
+
+ResultCache g_cache;
+
+#define NAPI_CALL(env, call)                                            \
+    do {                                                                \
+        if ((call) != napi_ok) {                                        \
+            napi_throw_error((env), nullptr, "N-API call failed: " #call); \
+            return nullptr;                                             \
+        }                                                               \
+    } while (0)
+
+void setNumber(napi_env env, napi_value object, const char* name, double value) {
+    napi_value v;
+    napi_create_double(env, value, &v);
+    napi_set_named_property(env, object, name, v);
+}
+
+void setString(napi_env env, napi_value object, const char* name, const std::string& value) {
+    napi_value v;
+    napi_create_string_utf8(env, value.c_str(), value.size(), &v);
+    napi_set_named_property(env, object, name, v);
+}
+
+void setBool(napi_env env, napi_value object, const char* name, bool value) {
+    napi_value v;
+    napi_get_boolean(env, value, &v);
+    napi_set_named_property(env, object, name, v);
+}
+
+void executeAnalyze(napi_env, void* data) {
+    auto* job = static_cast<AnalyzeJob*>(data);
+
+    CachedAnalysis analysis;
+    job->cached = analyzeRecordingCached(g_cache.isOpen() ? &g_cache : nullptr, job->data, job->size, job->hint,
+                                         t_recording, t_analyzer, analysis);
+    job->parsed = analysis.parsed;
+    job->format = analysis.format;
+    if (!job->parsed) {
+        job->parseError = analysis.result.errorMessage;
+        return;
+    }
+
+    job->skippedLines = analysis.skippedLines;
+    job->result = std::move(analysis.result);
+    if (!job->cached) {
+        job->dataRecords = t_recording.dataRecords;
+        job->recordDuration = t_recording.recordDuration;
+        job->warnings = t_recording.warnings;
+    }
+}
+
+void completeAnalyze(napi_env env, napi_status status, void* data) {
+    auto* job = static_cast<AnalyzeJob*>(data);
+
+    napi_value result;
+    napi_create_object(env, &result);
+    setBool(env, result, "valid", job->parsed);
+    setString(env, result, "format", formatName(job->format));
+    setNumber(env, result, "pipelineVersion", analysis::PipelineVersion);
+    setBool(env, result, "cached", job->cached);
+
+    if (!job->parsed) {
+        setBool(env, result, "success", false);
+        setString(env, result, "error", job->parseError);
+    }
+    else {
+        const BrainwaveResult& r = job->result;
+        setBool(env, result, "success", r.success);
+        setString(env, result, "error", r.errorMessage);
+        setNumber(env, result, "thetaValue", r.thetaValue);
+        setNumber(env, result, "alphaValue", r.alphaValue);
+        setNumber(env, result, "betaValue", r.betaValue);
+        setNumber(env, result, "brainwaveFinalIndex", r.brainwaveFinalIndex);
+
+        napi_value quality;
+        napi_create_object(env, &quality);
+        setNumber(env, quality, "sampleCount", static_cast<double>(r.sampleCount));
+        setNumber(env, quality, "durationSeconds", static_cast<double>(r.sampleCount) / analysis::SamplingRate);
+        setNumber(env, quality, "clippedCount", static_cast<double>(r.clippedCount));
+        setNumber(env, quality, "clippedRatio", r.sampleCount ? static_cast<double>(r.clippedCount) / r.sampleCount : 0.0);
+        setNumber(env, quality, "mean", r.meanValue);
+        setNumber(env, quality, "stdDeviation", r.stdDeviation);
+        setNumber(env, quality, "skippedLines", static_cast<double>(job->skippedLines));
+        if (job->format == RecordingFormat::Edf && !job->cached) {
+            setNumber(env, quality, "dataRecords", job->dataRecords);
+            setNumber(env, quality, "recordDuration", job->recordDuration);
+        }
+        napi_set_named_property(env, result, "quality", quality);
+    }
+
+    napi_value warnings;
+    napi_create_array_with_length(env, job->warnings.size(), &warnings);
+    for (size_t i = 0; i < job->warnings.size(); ++i) {
+        napi_value text;
+        napi_create_string_utf8(env, job->warnings[i].c_str(), job->warnings[i].size(), &text);
+        napi_set_element(env, warnings, static_cast<uint32_t>(i), text);
+    }
+    napi_set_named_property(env, result, "warnings", warnings);
+
+    if (status == napi_ok) {
+        napi_resolve_deferred(env, job->deferred, result);
+    }
+    else {
+        napi_value message, error;
+        napi_create_string_utf8(env, "analysis was cancelled", NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, nullptr, message, &error);
+        napi_reject_deferred(env, job->deferred, error);
+    }
+
+    napi_delete_reference(env, job->bufferRef);
+    napi_delete_async_work(env, job->work);
+    delete job;
+}
+
+napi_value Analyze(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    bool isBuffer = false;
+    if (argc < 1 || napi_is_buffer(env, args[0], &isBuffer) != napi_ok || !isBuffer) {
+        napi_throw_type_error(env, nullptr, "analyze(buffer[, format]) expects a Buffer");
+        return nullptr;
+    }
+
+    auto* job = new AnalyzeJob();
+    void* data = nullptr;
+    napi_get_buffer_info(env, args[0], &data, &job->size);
+    job->data = static_cast<const char*>(data);
+
+    if (argc >= 2) {
+        char format[8] = { 0 };
+        size_t length = 0;
+        if (napi_get_value_string_utf8(env, args[1], format, sizeof(format), &length) == napi_ok) {
+            std::string name(format, length);
+            if (name == "csv") job->hint = RecordingFormat::Csv;
+            else if (name == "edf") job->hint = RecordingFormat::Edf;
+        }
+    }
+
+    // Keep the Buffer alive while the worker reads it
+    napi_create_reference(env, args[0], 1, &job->bufferRef);
+
+    napi_value promise, resourceName;
+    napi_create_promise(env, &job->deferred, &promise);
+    napi_create_string_utf8(env, "brainmirror.analyze", NAPI_AUTO_LENGTH, &resourceName);
+    napi_create_async_work(env, nullptr, resourceName, executeAnalyze, completeAnalyze, job, &job->work);
+    napi_queue_async_work(env, job->work);
+    return promise;
+}
+
+napi_value OpenCache(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    size_t length = 0;
+    if (argc < 1 || napi_get_value_string_utf8(env, args[0], nullptr, 0, &length) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "openCache(path) expects a string");
+        return nullptr;
+    }
+    std::string path(length, '\0');
+    napi_get_value_string_utf8(env, args[0], path.data(), length + 1, &length);
+
+    std::string error;
+    if (!g_cache.open(std::filesystem::path(std::u8string(path.begin(), path.end())), error)) {
+        napi_throw_error(env, nullptr, ("cannot open result cache: " + error).c_str());
+        return nullptr;
+    }
+    napi_value ok;
+    napi_get_boolean(env, true, &ok);
+    return ok;
+}
+
+napi_value Init(napi_env env, napi_value exports) {
+    napi_value fn;
+    NAPI_CALL(env, napi_create_function(env, "analyze", NAPI_AUTO_LENGTH, Analyze, nullptr, &fn));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "analyze", fn));
+    NAPI_CALL(env, napi_create_function(env, "openCache", NAPI_AUTO_LENGTH, OpenCache, nullptr, &fn));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "openCache", fn));
+
+    napi_value version;
+    napi_create_int32(env, analysis::PipelineVersion, &version);
+    napi_set_named_property(env, exports, "pipelineVersion", version);
+    return exports;
+}
+
+} // namespace
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -1,6 +1,9 @@
 const express = require('express');
 const { query, transaction } = require('../config/database');
 const { authenticateToken } = require('../middleware/auth');
+const brainwaveAnalysis = require('../services/brainwaveAnalysisService');
+const spectrogram = require('../services/spectrogramService');
+const chunkUpload = require('../services/chunkUploadService');
 const multer = require('multer');
 const path = require('path');
 const fs = require('fs');
@@ -28,44 +31,91 @@ const storage = multer.diskStorage({
 const upload = multer({ 
     storage: storage,
     fileFilter: function (req, file, cb) {
-        // 允许CSV和EDF文件
+        // 允许CSV、EDF和频谱图（.bmspec）文件
         const ext = path.extname(file.originalname).toLowerCase();
         if (file.mimetype === 'text/csv' || ext === '.csv' || 
-            file.mimetype === 'application/octet-stream' || ext === '.edf') {
+            file.mimetype === 'application/octet-stream' || ext === '.edf' || ext === '.bmspec') {
             cb(null, true);
         } else {
-            cb(new Error('只允许上传CSV或EDF文件'));
+            cb(new Error('只允许上传CSV、EDF或频谱图文件'));
         }
     }
 });
 
-// 上传脑电波数据文件（CSV或EDF）
+// 校验上传信息，返回错误信息（无错误时返回null）
+function validateUploadInfo({ dataType, institutionId, staffName, testerName }) {
+    if (!dataType || !institutionId || !staffName || !testerName) {
+        return '请提供数据类型、文件和相关信息';
+    }
+    if (typeof institutionId !== 'string' || typeof staffName !== 'string' || typeof testerName !== 'string') {
+        return '机构ID、工作人员姓名和测试者姓名必须是字符串';
+    }
+    if (!['睁眼', '闭眼'].includes(dataType)) {
+        return '数据类型必须是"睁眼"或"闭眼"';
+    }
+    return null;
+}
+
+// 构建数据文件的最终路径 - 使用北京时间
+function buildDataPath(institutionId, staffName, testerName, dataType, fileExt) {
+    const beijingTime = new Date(new Date().getTime() + (8 * 60 * 60 * 1000)); // UTC+8
+    const timestamp = beijingTime.toISOString().replace(/[:.]/g, '-').slice(0, 19);
+    const fileName = `${timestamp}_${dataType}${fileExt}`;
+    const finalDir = path.join(__dirname, '..', 'data', institutionId, staffName, testerName);
+
+    // 确保最终目录存在
+    if (!fs.existsSync(finalDir)) {
+        fs.mkdirSync(finalDir, { recursive: true });
+    }
+    return {
+        finalPath: path.join(finalDir, fileName),
+        relativePath: path.join(institutionId, staffName, testerName, fileName)
+    };
+}
+
+// 服务端解析校验并计算脑电指标（插件不可用时返回null）
+async function analyzeDataFile(finalPath, fileType) {
+    try {
+        return await brainwaveAnalysis.analyzeFile(finalPath, fileType);
+    } catch (analysisError) {
+        console.error('服务端脑电分析失败:', analysisError);
+        return null;
+    }
+}
+
+// 为CSV文件创建测试结果记录，返回记录ID
+async function createTestResult(relativePath, dbDataType, analysis) {
+    // 闭眼数据在服务端算出指标时直接填入，客户端随后上报的结果会覆盖
+    const fillValues = analysis && analysis.success && dbDataType === 'Closed Eyes';
+
+    // CSV文件存储到csv_file_path字段并创建测试结果记录
+    const testResultSql = `
+        INSERT INTO test_results 
+        (csv_file_path, theta_value, alpha_value, beta_value, result, created_at) 
+        VALUES (?, ?, ?, ?, ?, NOW())
+    `;
+    const testResultResult = await query(testResultSql, [
+        relativePath,
+        fillValues ? analysis.thetaValue.toFixed(2) : null,
+        fillValues ? analysis.alphaValue.toFixed(2) : null,
+        fillValues ? analysis.betaValue.toFixed(2) : null,
+        dbDataType
+    ]);
+    return testResultResult.insertId;
+}
+
+// 上传脑电波数据文件（CSV、EDF或频谱图）
 router.post('/upload', authenticateToken, upload.any(), async (req, res) => {
     try {
         const { dataType, institutionId, staffName, testerName } = req.body;
         const uploadedFile = req.files && req.files[0]; // 获取第一个上传的文件
         
         // 验证必填字段
-        if (!dataType || !uploadedFile || !institutionId || !staffName || !testerName) {
-            return res.status(400).json({
-                success: false,
-                message: '请提供数据类型、文件和相关信息'
-            });
-        }
-        
-        // 确保字符串字段不为空
-        if (typeof institutionId !== 'string' || typeof staffName !== 'string' || typeof testerName !== 'string') {
-            return res.status(400).json({
-                success: false,
-                message: '机构ID、工作人员姓名和测试者姓名必须是字符串'
-            });
-        }
-
-        // 验证数据类型
-        if (!['睁眼', '闭眼'].includes(dataType)) {
+        const invalid = !uploadedFile ? '请提供数据类型、文件和相关信息' : validateUploadInfo(req.body);
+        if (invalid) {
             return res.status(400).json({
                 success: false,
-                message: '数据类型必须是"睁眼"或"闭眼"'
+                message: invalid
             });
         }
         
@@ -77,21 +127,10 @@ router.post('/upload', authenticateToken, upload.any(), async (req, res) => {
         // 确定文件类型和扩展名
         const fileExt = path.extname(uploadedFile.originalname).toLowerCase();
         const isEDF = fileExt === '.edf';
+        const isSpectrogram = fileExt === '.bmspec';
         
-        // 构建最终文件路径 - 使用北京时间
-        const beijingTime = new Date(new Date().getTime() + (8 * 60 * 60 * 1000)); // UTC+8
-        const timestamp = beijingTime.toISOString().replace(/[:.]/g, '-').slice(0, 19);
-        const fileName = `${timestamp}_${dataType}${fileExt}`;
-        const finalDir = path.join(__dirname, '..', 'data', institutionId, staffName, testerName);
-        const finalPath = path.join(finalDir, fileName);
-        const relativePath = path.join(institutionId, staffName, testerName, fileName);
-
-
-
-        // 确保最终目录存在
-        if (!fs.existsSync(finalDir)) {
-            fs.mkdirSync(finalDir, { recursive: true });
-        }
+        // 构建最终文件路径
+        const { finalPath, relativePath } = buildDataPath(institutionId, staffName, testerName, dataType, fileExt);
 
         // 将文件从临时位置移动到最终位置
         fs.copyFileSync(uploadedFile.path, finalPath);
@@ -99,20 +138,43 @@ router.post('/upload', authenticateToken, upload.any(), async (req, res) => {
         // 删除临时文件
         fs.unlinkSync(uploadedFile.path);
 
-        let testResultId = null;
-        
-        // 只有CSV文件才创建数据库记录
-        if (!isEDF) {
-            // CSV文件存储到csv_file_path字段并创建测试结果记录
-            const testResultSql = `
-                INSERT INTO test_results 
-                (csv_file_path, result, created_at) 
-                VALUES (?, ?, NOW())
-            `;
-            const testResultResult = await query(testResultSql, [relativePath, dbDataType]);
-            testResultId = testResultResult.insertId;
+        // 频谱图文件只校验格式，与EDF文件一样不创建数据库记录
+        if (isSpectrogram) {
+            const check = await spectrogram.validateFile(finalPath);
+            if (!check.valid) {
+                fs.unlinkSync(finalPath);
+                return res.status(400).json({
+                    success: false,
+                    message: `文件内容无效: ${check.error}`
+                });
+            }
+            return res.json({
+                success: true,
+                message: '成功上传脑电波频谱图文件',
+                data: {
+                    testResultId: null,
+                    dataType,
+                    filePath: relativePath,
+                    fileName: uploadedFile.filename,
+                    fileType: 'bmspec'
+                }
+            });
         }
 
+        // 服务端解析校验并计算脑电指标（插件不可用时跳过）
+        const analysis = await analyzeDataFile(finalPath, isEDF ? 'edf' : 'csv');
+
+        if (analysis && !analysis.valid) {
+            fs.unlinkSync(finalPath);
+            return res.status(400).json({
+                success: false,
+                message: `文件内容无效: ${analysis.error}`
+            });
+        }
+
+        // 只有CSV文件才创建数据库记录
+        const testResultId = isEDF ? null : await createTestResult(relativePath, dbDataType, analysis);
+
         res.json({
             success: true,
             message: `成功上传脑电波数据${isEDF ? 'EDF' : 'CSV'}文件`,
@@ -121,7 +183,8 @@ router.post('/upload', authenticateToken, upload.any(), async (req, res) => {
                 dataType,
                 filePath: relativePath,
                 fileName: uploadedFile.filename,
-                fileType: isEDF ? 'edf' : 'csv'
+                fileType: isEDF ? 'edf' : 'csv',
+                analysis
             }
         });
 
@@ -129,10 +192,10 @@ router.post('/upload', authenticateToken, upload.any(), async (req, res) => {
         console.error('上传脑电波数据错误:', error);
         
         // 如果是文件上传错误，返回相应的错误信息
-        if (error.message === '只允许上传CSV或EDF文件') {
+        if (error.message === '只允许上传CSV、EDF或频谱图文件') {
             return res.status(400).json({
                 success: false,
-                message: '只允许上传CSV或EDF文件'
+                message: '只允许上传CSV、EDF或频谱图文件'
             });
         }
         
@@ -156,6 +219,26 @@ router.put('/update-result', authenticateToken, async (req, res) => {
             });
         }
         
+        // 用服务端分析结果校验客户端上报的指标（仅记录偏差，以客户端结果为准）
+        let verification = null;
+        if (brainwaveAnalysis.isAvailable()) {
+            try {
+                const rows = await query('SELECT csv_file_path, result FROM test_results WHERE id = ?', [testResultId]);
+                if (rows.length > 0 && rows[0].result === 'Closed Eyes') {
+                    const csvPath = path.join(__dirname, '..', 'data', rows[0].csv_file_path);
+                    const analysis = await brainwaveAnalysis.analyzeFile(csvPath, 'csv');
+                    if (analysis && analysis.success) {
+                        verification = brainwaveAnalysis.compareWithClient(analysis, { thetaValue, alphaValue, betaValue });
+                        if (!verification.verified) {
+                            console.warn(`测试结果${testResultId}客户端指标与服务端计算不一致:`, verification.deviations);
+                        }
+                    }
+                }
+            } catch (verifyError) {
+                console.error('校验测试结果失败:', verifyError);
+            }
+        }
+
         // 更新test_results表
         const updateSql = `
             UPDATE test_results 
@@ -173,7 +256,8 @@ router.put('/update-result', authenticateToken, async (req, res) => {
                     testResultId,
                     thetaValue,
                     alphaValue,
-                    betaValue
+                    betaValue,
+                    verification
                 }
             });
         } else {
@@ -192,4 +276,177 @@ router.put('/update-result', authenticateToken, async (req, res) => {
     }
 });
 
+// 分块上传错误统一返回，409时附带服务器已确认的进度供客户端续传
+function sendChunkError(res, error, action) {
+    if (error instanceof chunkUpload.ChunkUploadError) {
+        return res.status(error.status).json({
+            success: false,
+            message: error.message,
+            received: error.received
+        });
+    }
+    console.error(`${action}错误:`, error);
+    res.status(500).json({
+        success: false,
+        message: '服务器内部错误'
+    });
+}
+
+// 开始或恢复分块上传，返回每个流已确认的采样点数（received）
+router.post('/chunked/:uploadId/start', authenticateToken, async (req, res) => {
+    try {
+        const invalid = validateUploadInfo(req.body);
+        if (invalid) {
+            return res.status(400).json({
+                success: false,
+                message: invalid
+            });
+        }
+
+        const { dataType, institutionId, staffName, testerName, sampleRate, streams } = req.body;
+        const state = chunkUpload.startUpload(req.params.uploadId,
+            { dataType, institutionId, staffName, testerName, sampleRate, streams });
+        res.json({ success: true, received: state.received });
+    } catch (error) {
+        sendChunkError(res, error, '开始分块上传');
+    }
+});
+
+// 上传一个数据块（二进制，X-Chunk-Hash头为FNV-1a哈希）
+router.put('/chunked/:uploadId/chunks', authenticateToken,
+    express.raw({ type: 'application/octet-stream', limit: '8mb' }), async (req, res) => {
+    try {
+        const state = chunkUpload.appendChunk(req.params.uploadId, req.body, req.get('X-Chunk-Hash'));
+        res.json({ success: true, received: state.received });
+    } catch (error) {
+        sendChunkError(res, error, '上传数据块');
+    }
+});
+
+// 查询分块上传进度
+router.get('/chunked/:uploadId', authenticateToken, async (req, res) => {
+    try {
+        const state = chunkUpload.readState(req.params.uploadId);
+        res.json({
+            success: true,
+            received: state.received,
+            completed: !!state.result,
+            data: state.result || null
+        });
+    } catch (error) {
+        sendChunkError(res, error, '查询分块上传');
+    }
+});
+
+// 完成分块上传：合成CSV，之后与普通CSV上传一样做服务端分析并创建测试结果记录
+router.post('/chunked/:uploadId/complete', authenticateToken, async (req, res) => {
+    try {
+        const state = chunkUpload.readState(req.params.uploadId);
+        if (state.result) {
+            return res.json({
+                success: true,
+                message: '分块上传已完成',
+                testResultId: state.result.testResultId,
+                data: state.result
+            });
+        }
+
+        const { finalPath, relativePath } = buildDataPath(
+            state.institutionId, state.staffName, state.testerName, state.dataType, '.csv');
+        chunkUpload.assembleCsv(req.params.uploadId, req.body.samples, finalPath);
+
+        const analysis = await analyzeDataFile(finalPath, 'csv');
+        if (analysis && !analysis.valid) {
+            fs.unlinkSync(finalPath);
+            return res.status(400).json({
+                success: false,
+                message: `文件内容无效: ${analysis.error}`
+            });
+        }
+
+        const dbDataType = state.dataType === '睁眼' ? 'Open Eyes' : 'Closed Eyes';
+        const testResultId = await createTestResult(relativePath, dbDataType, analysis);
+        const result = {
+            testResultId,
+            dataType: state.dataType,
+            filePath: relativePath,
+            fileType: 'csv',
+            analysis
+        };
+        chunkUpload.markCompleted(req.params.uploadId, result);
+
+        res.json({
+            success: true,
+            message: '成功上传脑电波数据CSV文件',
+            testResultId,
+            data: result
+        });
+    } catch (error) {
+        sendChunkError(res, error, '完成分块上传');
+    }
+});
+
+// 将上传接口返回的相对路径解析为data目录下的频谱图文件，拒绝目录穿越
+function resolveSpectrogramPath(relativePath) {
+    if (typeof relativePath !== 'string' || path.extname(relativePath).toLowerCase() !== '.bmspec') {
+        return null;
+    }
+    const dataDir = path.resolve(__dirname, '..', 'data');
+    const fullPath = path.resolve(dataDir, relativePath);
+    if (!fullPath.startsWith(dataDir + path.sep) || !fs.existsSync(fullPath)) {
+        return null;
+    }
+    return fullPath;
+}
+
+// 获取频谱图文件信息（分辨率级别和瓦片数量）
+router.get('/spectrogram/info', authenticateToken, async (req, res) => {
+    try {
+        const filePath = resolveSpectrogramPath(req.query.filePath);
+        if (!filePath) {
+            return res.status(404).json({
+                success: false,
+                message: '未找到频谱图文件'
+            });
+        }
+
+        const info = await spectrogram.readInfo(filePath);
+        res.json({
+            success: true,
+            data: info
+        });
+    } catch (error) {
+        console.error('读取频谱图信息错误:', error);
+        res.status(400).json({
+            success: false,
+            message: error.message
+        });
+    }
+});
+
+// 获取单个频谱图瓦片（二进制uint8，tileHeight行 x tileWidth列）
+router.get('/spectrogram/tile', authenticateToken, async (req, res) => {
+    try {
+        const filePath = resolveSpectrogramPath(req.query.filePath);
+        if (!filePath) {
+            return res.status(404).json({
+                success: false,
+                message: '未找到频谱图文件'
+            });
+        }
+
+        const tile = await spectrogram.readTile(filePath,
+            Number(req.query.level), Number(req.query.tx), Number(req.query.ty));
+        res.set('Content-Type', 'application/octet-stream');
+        res.set('Cache-Control', 'private, max-age=86400');
+        res.send(tile);
+    } catch (error) {
+        console.error('读取频谱图瓦片错误:', error);
+        res.status(400).json({
+            success: false,
+            message: error.message
+        });
+    }
+});
+
 module.exports = router;
@@ -31,6 +31,8 @@ app.use(cors({
 const limiter = rateLimit({
     windowMs: 15 * 60 * 1000, // 15分钟
     max: 100, // 限制每个IP 15分钟内最多100个请求
+    // 分块上传每台设备每几秒一个请求，工作站同时记录多台设备时会超出限制；这些接口都需要登录
+    skip: (req) => req.originalUrl.startsWith('/api/brainwave-data/chunked/'),
     message: {
         success: false,
         message: '请求过于频繁，请稍后再试'
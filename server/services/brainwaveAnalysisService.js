@@ -0,0 +1,70 @@
+/**
+ * 脑电数据分析服务
+ * 封装 native/ 下的C++分析插件（与客户端BrainwaveDataProcessor算法一致），
+ * 插件未编译时所有方法返回null，上传流程保持原有行为。
+ * 分析结果按文件内容哈希缓存在 temp/analysis-cache.bmcache，相同内容不重复计算，
+ * 算法版本或参数变化时缓存自动失效
+ */
+
+const fs = require('fs');
+const path = require('path');
+
+let addon = null;
+try {
+    addon = require(path.join(__dirname, '..', 'native', 'build', 'Release', 'brainmirror_analysis.node'));
+} catch (error) {
+    console.warn('⚠️ 脑电分析插件未加载，服务端分析已禁用 (npm run build:native):', error.message);
+}
+
+if (addon && typeof addon.openCache === 'function') {
+    try {
+        const cacheDir = path.join(__dirname, '..', 'temp');
+        fs.mkdirSync(cacheDir, { recursive: true });
+        addon.openCache(path.join(cacheDir, 'analysis-cache.bmcache'));
+    } catch (error) {
+        // 缓存文件被其他进程占用时直接计算
+        console.warn('⚠️ 分析结果缓存未启用:', error.message);
+    }
+}
+
+// 客户端与服务端指标允许的最大偏差（百分点）
+const VERIFY_TOLERANCE = 0.5;
+
+function isAvailable() {
+    return addon !== null;
+}
+
+/**
+ * 解析并分析EDF/CSV文件（在libuv线程池中执行，不阻塞事件循环）
+ * @param {string} filePath - 文件路径
+ * @param {string} format - 'csv' 或 'edf'
+ * @returns {Promise<object|null>} 分析结果，插件不可用时为null
+ */
+async function analyzeFile(filePath, format) {
+    if (!addon) {
+        return null;
+    }
+    const buffer = await fs.promises.readFile(filePath);
+    return addon.analyze(buffer, format);
+}
+
+/**
+ * 比较客户端上报的指标与服务端计算结果
+ * @returns {object} { verified, deviations }
+ */
+function compareWithClient(serverValues, clientValues) {
+    const deviations = {
+        thetaValue: Math.abs(Number(clientValues.thetaValue) - Number(serverValues.thetaValue)),
+        alphaValue: Math.abs(Number(clientValues.alphaValue) - Number(serverValues.alphaValue)),
+        betaValue: Math.abs(Number(clientValues.betaValue) - Number(serverValues.betaValue))
+    };
+    const verified = Object.values(deviations).every(d => d <= VERIFY_TOLERANCE);
+    return { verified, deviations };
+}
+
+module.exports = {
+    isAvailable,
+    analyzeFile,
+    compareWithClient,
+    pipelineVersion: addon ? addon.pipelineVersion : null
+};
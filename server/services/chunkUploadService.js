@@ -0,0 +1,262 @@
+/**
+ * 分块上传服务
+ * 接收客户端边记录边上传的压缩数据块（格式见 BrainMonitor/native/ChunkCodec.h），
+ * 按流追加到 temp/chunked/<uploadId>/ 下，记录每个流已确认的采样点数以支持断点续传，
+ * 上传完成后合成与客户端保存格式一致的CSV文件
+ */
+
+const fs = require('fs');
+const path = require('path');
+
+const CHUNK_ROOT = path.join(__dirname, '..', 'temp', 'chunked');
+const MAGIC = 'BMCK';
+const HEADER_SIZE = 24;
+const MAX_STREAMS = 8;
+const FNV_OFFSET = 0xcbf29ce484222325n;
+const FNV_PRIME = 0x100000001b3n;
+const MASK_64 = 0xffffffffffffffffn;
+
+/**
+ * 带HTTP状态码的错误，received为服务器当前已确认的采样点数（续传用）
+ */
+class ChunkUploadError extends Error {
+    constructor(status, message, received) {
+        super(message);
+        this.status = status;
+        this.received = received;
+    }
+}
+
+function isValidUploadId(uploadId) {
+    return typeof uploadId === 'string' && /^[0-9a-f]{16,64}$/.test(uploadId);
+}
+
+function uploadDir(uploadId) {
+    if (!isValidUploadId(uploadId)) {
+        throw new ChunkUploadError(400, '无效的上传ID');
+    }
+    return path.join(CHUNK_ROOT, uploadId);
+}
+
+function streamFile(dir, stream) {
+    return path.join(dir, `stream${stream}.bin`);
+}
+
+function readState(uploadId) {
+    const statePath = path.join(uploadDir(uploadId), 'state.json');
+    if (!fs.existsSync(statePath)) {
+        throw new ChunkUploadError(404, '上传任务不存在');
+    }
+    return JSON.parse(fs.readFileSync(statePath, 'utf8'));
+}
+
+// 先写临时文件再重命名，进程中断时不会留下半个状态文件
+function writeState(uploadId, state) {
+    const dir = uploadDir(uploadId);
+    const tempPath = path.join(dir, 'state.json.tmp');
+    fs.writeFileSync(tempPath, JSON.stringify(state));
+    fs.renameSync(tempPath, path.join(dir, 'state.json'));
+}
+
+/**
+ * 64位FNV-1a哈希（与客户端 fnv1a64 一致），返回16位十六进制字符串
+ * @param {Buffer} buffer
+ * @returns {string}
+ */
+function fnv1a64(buffer) {
+    let hash = FNV_OFFSET;
+    for (let i = 0; i < buffer.length; i++) {
+        hash ^= BigInt(buffer[i]);
+        hash = (hash * FNV_PRIME) & MASK_64;
+    }
+    return hash.toString(16).padStart(16, '0');
+}
+
+/**
+ * 解码数据块：24字节头 + zigzag变长编码的相邻差值
+ * @param {Buffer} buffer
+ * @returns {object} { stream, firstSample, samples: Int32Array }
+ */
+function decodeChunk(buffer) {
+    if (buffer.length < HEADER_SIZE || buffer.toString('ascii', 0, 4) !== MAGIC) {
+        throw new ChunkUploadError(400, '不是有效的数据块');
+    }
+    const version = buffer.readUInt16LE(4);
+    const stream = buffer.readUInt16LE(6);
+    const firstSample = Number(buffer.readBigUInt64LE(8));
+    const sampleCount = buffer.readUInt32LE(16);
+    const payloadBytes = buffer.readUInt32LE(20);
+    if (version !== 1 || payloadBytes !== buffer.length - HEADER_SIZE) {
+        throw new ChunkUploadError(400, '不支持的数据块版本或长度不符');
+    }
+
+    const samples = new Int32Array(sampleCount);
+    let count = 0;
+    let previous = 0;
+    let pos = HEADER_SIZE;
+    while (pos < buffer.length) {
+        let zigzag = 0;
+        let scale = 1;
+        for (;;) {
+            if (pos >= buffer.length || scale > 2 ** 35) {
+                throw new ChunkUploadError(400, '数据块内容损坏');
+            }
+            const byte = buffer[pos++];
+            zigzag += (byte & 0x7f) * scale;
+            if (!(byte & 0x80)) break;
+            scale *= 128;
+        }
+        const delta = zigzag % 2 === 0 ? zigzag / 2 : -(zigzag + 1) / 2;
+        previous += delta;
+        if (count >= sampleCount) {
+            throw new ChunkUploadError(400, '数据块采样点数不符');
+        }
+        samples[count++] = previous;
+    }
+    if (count !== sampleCount) {
+        throw new ChunkUploadError(400, '数据块采样点数不符');
+    }
+    return { stream, firstSample, samples };
+}
+
+/**
+ * 创建或恢复上传任务。同一uploadId重复调用时返回已确认的进度
+ * @param {string} uploadId
+ * @param {object} meta - { dataType, institutionId, staffName, testerName, sampleRate, streams }
+ * @returns {object} 上传状态
+ */
+function startUpload(uploadId, meta) {
+    const dir = uploadDir(uploadId);
+    if (fs.existsSync(path.join(dir, 'state.json'))) {
+        const state = readState(uploadId);
+        if (state.streams !== meta.streams || state.sampleRate !== meta.sampleRate) {
+            throw new ChunkUploadError(409, '上传ID已被参数不同的任务使用', state.received);
+        }
+        return state;
+    }
+
+    if (!Number.isInteger(meta.streams) || meta.streams < 1 || meta.streams > MAX_STREAMS ||
+        !Number.isInteger(meta.sampleRate) || meta.sampleRate <= 0) {
+        throw new ChunkUploadError(400, '通道数或采样率无效');
+    }
+    fs.mkdirSync(dir, { recursive: true });
+    const state = {
+        ...meta,
+        received: new Array(meta.streams).fill(0),
+        createdAt: new Date().toISOString()
+    };
+    writeState(uploadId, state);
+    return state;
+}
+
+/**
+ * 追加一个数据块。重复的块直接确认；与已确认进度不连续的块返回409和当前进度
+ * @param {string} uploadId
+ * @param {Buffer} buffer - 数据块原始内容
+ * @param {string} hash - 客户端计算的FNV-1a哈希
+ * @returns {object} 上传状态
+ */
+function appendChunk(uploadId, buffer, hash) {
+    const state = readState(uploadId);
+    if (state.result) {
+        throw new ChunkUploadError(409, '上传已完成', state.received);
+    }
+    if (!Buffer.isBuffer(buffer) || typeof hash !== 'string' || fnv1a64(buffer) !== hash.toLowerCase()) {
+        throw new ChunkUploadError(400, '数据块哈希校验失败');
+    }
+    const chunk = decodeChunk(buffer);
+    if (chunk.stream >= state.streams) {
+        throw new ChunkUploadError(400, '数据块的流编号超出范围');
+    }
+
+    const received = state.received[chunk.stream];
+    if (chunk.firstSample + chunk.samples.length <= received) {
+        return state;
+    }
+    if (chunk.firstSample !== received) {
+        throw new ChunkUploadError(409, '数据块与已上传进度不连续', state.received);
+    }
+
+    // 截掉上次追加后未来得及记录进度的部分，再追加本块
+    const file = streamFile(uploadDir(uploadId), chunk.stream);
+    if (fs.existsSync(file)) {
+        fs.truncateSync(file, received * 4);
+    }
+    const bytes = Buffer.from(chunk.samples.buffer, chunk.samples.byteOffset, chunk.samples.byteLength);
+    fs.appendFileSync(file, bytes);
+
+    state.received[chunk.stream] = received + chunk.samples.length;
+    writeState(uploadId, state);
+    return state;
+}
+
+/**
+ * 合成CSV：每行一个采样点，多通道时各列以逗号分隔，数值保留两位小数（与客户端保存格式一致）
+ * @param {string} uploadId
+ * @param {number[]} samples - 客户端认为已上传的每个流的采样点数，与服务器不一致时返回409
+ * @param {string} csvPath - 输出文件路径
+ * @returns {object} 上传状态
+ */
+function assembleCsv(uploadId, samples, csvPath) {
+    const state = readState(uploadId);
+    if (!Array.isArray(samples) || samples.length !== state.streams ||
+        samples.some((count, s) => count !== state.received[s])) {
+        throw new ChunkUploadError(409, '上传尚未完成', state.received);
+    }
+
+    const dir = uploadDir(uploadId);
+    const length = Math.min(...state.received);
+    if (length === 0) {
+        throw new ChunkUploadError(400, '没有上传任何数据');
+    }
+    const streams = [];
+    for (let s = 0; s < state.streams; s++) {
+        // 复制到独立的ArrayBuffer，保证Int32Array按4字节对齐
+        const data = new Uint8Array(fs.readFileSync(streamFile(dir, s)));
+        streams.push(new Int32Array(data.buffer, 0, data.byteLength >> 2));
+    }
+
+    const fd = fs.openSync(csvPath, 'w');
+    try {
+        const batch = 4096;
+        for (let start = 0; start < length; start += batch) {
+            const lines = [];
+            const end = Math.min(length, start + batch);
+            for (let i = start; i < end; i++) {
+                lines.push(streams.map(stream => stream[i].toFixed(2)).join(','));
+            }
+            fs.writeSync(fd, lines.join('\n') + '\n');
+        }
+    } finally {
+        fs.closeSync(fd);
+    }
+    return state;
+}
+
+/**
+ * 记录完成结果并删除各流的数据文件，只保留状态文件，
+ * 客户端没收到完成应答而重试时可直接返回同一结果
+ * @param {string} uploadId
+ * @param {object} result - { testResultId, filePath }
+ */
+function markCompleted(uploadId, result) {
+    const state = readState(uploadId);
+    state.result = result;
+    writeState(uploadId, state);
+    const dir = uploadDir(uploadId);
+    for (let s = 0; s < state.streams; s++) {
+        fs.rmSync(streamFile(dir, s), { force: true });
+    }
+}
+
+module.exports = {
+    ChunkUploadError,
+    isValidUploadId,
+    fnv1a64,
+    decodeChunk,
+    startUpload,
+    appendChunk,
+    readState,
+    assembleCsv,
+    markCompleted
+};
@@ -0,0 +1,131 @@
+/**
+ * 频谱图瓦片服务
+ * 读取客户端会话结束时生成的 .bmspec 文件（格式见 BrainMonitor/native/Spectrogram.h），
+ * 只读取文件头、索引和请求的瓦片，不加载整个文件
+ */
+
+const fs = require('fs');
+
+const MAGIC = 'BMSPEC1';
+const HEADER_SIZE = 64;
+const LEVEL_SIZE = 16;
+const TILE_ENTRY_SIZE = 16;
+
+function parseHeader(buffer) {
+    if (buffer.length < HEADER_SIZE || buffer.toString('ascii', 0, 7) !== MAGIC || buffer[7] !== 0) {
+        throw new Error('不是有效的频谱图文件');
+    }
+    const header = {
+        version: buffer.readUInt32LE(8),
+        headerSize: buffer.readUInt32LE(12),
+        sampleRate: buffer.readFloatLE(16),
+        fftSize: buffer.readUInt32LE(20),
+        hopSize: buffer.readUInt32LE(24),
+        frameCount: buffer.readUInt32LE(28),
+        freqBins: buffer.readUInt32LE(32),
+        binHz: buffer.readFloatLE(36),
+        minDb: buffer.readFloatLE(40),
+        maxDb: buffer.readFloatLE(44),
+        levelCount: buffer.readUInt32LE(48),
+        tileWidth: buffer.readUInt16LE(52),
+        tileHeight: buffer.readUInt16LE(54)
+    };
+    if (header.version !== 1 || header.headerSize !== HEADER_SIZE || header.levelCount === 0 ||
+        header.levelCount > 32 || header.tileWidth === 0 || header.tileHeight === 0) {
+        throw new Error('不支持的频谱图文件版本或参数');
+    }
+    return header;
+}
+
+async function readExactly(handle, length, position) {
+    const buffer = Buffer.alloc(length);
+    const { bytesRead } = await handle.read(buffer, 0, length, position);
+    if (bytesRead !== length) {
+        throw new Error('频谱图文件不完整');
+    }
+    return buffer;
+}
+
+/**
+ * 读取文件头和各级分辨率信息
+ * @param {string} filePath - .bmspec 文件路径
+ * @returns {Promise<object>} { header, levels }
+ */
+async function readInfo(filePath) {
+    const handle = await fs.promises.open(filePath, 'r');
+    try {
+        const header = parseHeader(await readExactly(handle, HEADER_SIZE, 0));
+        const table = await readExactly(handle, header.levelCount * LEVEL_SIZE, HEADER_SIZE);
+        const levels = [];
+        for (let i = 0; i < header.levelCount; i++) {
+            levels.push({
+                frames: table.readUInt32LE(i * LEVEL_SIZE),
+                tilesX: table.readUInt32LE(i * LEVEL_SIZE + 4),
+                tilesY: table.readUInt32LE(i * LEVEL_SIZE + 8),
+                firstTile: table.readUInt32LE(i * LEVEL_SIZE + 12),
+                secondsPerColumn: (header.hopSize * Math.pow(2, i)) / header.sampleRate
+            });
+        }
+        return { header, levels };
+    } finally {
+        await handle.close();
+    }
+}
+
+/**
+ * 读取单个瓦片（tileHeight行 x tileWidth列的uint8，低频在前，0表示无数据）
+ * @returns {Promise<Buffer>}
+ */
+async function readTile(filePath, level, tx, ty) {
+    const handle = await fs.promises.open(filePath, 'r');
+    try {
+        const header = parseHeader(await readExactly(handle, HEADER_SIZE, 0));
+        if (!Number.isInteger(level) || level < 0 || level >= header.levelCount) {
+            throw new Error('分辨率级别超出范围');
+        }
+        const entry = await readExactly(handle, LEVEL_SIZE, HEADER_SIZE + level * LEVEL_SIZE);
+        const tilesX = entry.readUInt32LE(4);
+        const tilesY = entry.readUInt32LE(8);
+        const firstTile = entry.readUInt32LE(12);
+        if (!Number.isInteger(tx) || !Number.isInteger(ty) || tx < 0 || ty < 0 || tx >= tilesX || ty >= tilesY) {
+            throw new Error('瓦片坐标超出范围');
+        }
+
+        const tileIndex = firstTile + ty * tilesX + tx;
+        const indexOffset = HEADER_SIZE + header.levelCount * LEVEL_SIZE + tileIndex * TILE_ENTRY_SIZE;
+        const tileEntry = await readExactly(handle, TILE_ENTRY_SIZE, indexOffset);
+        const offset = Number(tileEntry.readBigUInt64LE(0));
+        const size = tileEntry.readUInt32LE(8);
+        if (size !== header.tileWidth * header.tileHeight) {
+            throw new Error('瓦片大小无效');
+        }
+        return await readExactly(handle, size, offset);
+    } finally {
+        await handle.close();
+    }
+}
+
+/**
+ * 上传时校验文件头
+ * @returns {Promise<object>} { valid, error, header }
+ */
+async function validateFile(filePath) {
+    try {
+        const { header, levels } = await readInfo(filePath);
+        const stat = await fs.promises.stat(filePath);
+        const tiles = levels.reduce((sum, level) => sum + level.tilesX * level.tilesY, 0);
+        const expected = HEADER_SIZE + levels.length * LEVEL_SIZE + tiles * (TILE_ENTRY_SIZE + header.tileWidth * header.tileHeight);
+        if (stat.size !== expected) {
+            return { valid: false, error: '频谱图文件大小与索引不符' };
+        }
+        return { valid: true, header };
+    } catch (error) {
+        return { valid: false, error: error.message };
+    }
+}
+
+module.exports = {
+    readInfo,
+    readTile,
+    validateFile
+};